@@ -14,7 +14,10 @@ long double d_nm(size_t n , size_t m , InputData input_data) ;
 Mat2d matrix_d_nm(InputData input_data);
 
 
-Mat2d matrix_E_n(InputData input_data, Vec mesh);
+Mat2d matrix_E_n(InputData input_data, Mesh mesh);
+
+// same as matrix_E_n, from trap energies that are already known(see getGridNumE/poissonSolverGridE)
+Mat2d matrix_E_n_from_E(Vec E);
 
 
 long double r_nm(InputData input_data , Mat2d mat_E , Mat2d mat_d , size_t n , size_t m);
@@ -22,8 +25,21 @@ long double r_nm(InputData input_data , Mat2d mat_E , Mat2d mat_d , size_t n , s
 
 Mat2d matrix_r_nm(InputData input_data , Mat2d mat_E , Mat2d mat_d);
 
+// smallest number of r_nm entries matrix_r_nm hands to one thread
+#define R_NM_PARALLEL_ENTRIES 8192
+
+// r_nm falls off as exp(-d_nm/gamma_0), pairs further apart than this many gamma_0 are dropped by default(e^-40 ~ 4e-18)
+#define R_NM_CUTOFF_DECAYS 40
+
+// sparse matrix_r_nm: only pairs with d_nm <= cutoff are stored(cutoff <= 0 uses R_NM_CUTOFF_DECAYS * gamma_0)
+// E holds the trap energies(see getGridNumE), the diagonal is 0. O(N log N + N*neighbours)
+MatCSR matrix_r_nm_csr(InputData input_data, Vec E, long double cutoff);
+
 
 long double transmission_param(long double T_b , InputData input_data , long double V_electrode);
 
 
-Mat2d R_en(InputData input_data, Vec mesh);
+Mat2d R_en(InputData input_data, Mesh mesh);
+
+// same as R_en, from trap energies that are already known(see getGridNumE/poissonSolverGridE)
+Mat2d R_en_from_E(InputData input_data, Vec E);
@@ -9,6 +9,7 @@
 #include <include/pyvisual.h>
 #include <include/stack.h>
 #include <include/steadystate.h>
+#include <include/threadpool.h>
 #include <include/utils.h>
 
 #define ITER_MAX 2500
@@ -6,25 +6,63 @@
 
 // Error Handling
 
+// Diagnostics
+// errors and warnings are not printed where they happen, they go to a per-thread ring buffer and are printed by linalgDiagFlush
+// (at checkpoints, i.e once per steady-state iteration, and at exit). each call site keeps its first LINALG_DIAG_SITE_MESSAGES
+// messages between flushes, further reports from it are only counted, so a NaN inside a hot loop costs an atomic increment.
+// LINALG_DIAG_IMMEDIATE flushes on every report(the old behaviour, useful under a debugger)
+#define LINALG_DIAG_ERROR 0
+#define LINALG_DIAG_WARN 1
+
+#define LINALG_DIAG_BUFFERED 0
+#define LINALG_DIAG_IMMEDIATE 1
+
+// messages kept per call site between flushes
+#define LINALG_DIAG_SITE_MESSAGES 4
+
+// a call site of LINALG_REPORT_ERROR/LINALG_REPORT_WARN, one static instance per macro expansion
+typedef struct LinalgDiagSite
+{
+    const char* file;
+    const char* function;
+    size_t line;
+    int severity;
+    _Atomic size_t hits;        // reports since the start
+    _Atomic size_t pending;     // reports since the last flush
+    _Atomic int registered;     // in the site list walked by linalgDiagFlush
+    struct LinalgDiagSite* next;
+} LinalgDiagSite;
+
+// record a report from site, called by the LINALG_REPORT_* macros
+void linalgDiagReport(LinalgDiagSite* site, const char* format, ...) __attribute__((format(printf, 2, 3)));
+// print the buffered messages of all threads in order, then how often each call site repeated since the last flush
+void linalgDiagFlush();
+// get the number of reports of a severity(LINALG_DIAG_ERROR or LINALG_DIAG_WARN) since the start
+size_t linalgDiagCount(int severity);
+// set the diagnostics mode(LINALG_DIAG_BUFFERED or LINALG_DIAG_IMMEDIATE), returns the mode actually selected
+int linalgDiagSetMode(int mode);
+// set the stream diagnostics are printed to(NULL = stdout), flushes what is pending to the old stream first
+void linalgDiagSetStream(FILE* stream);
+
 // call this macro to handle errors
 // all linalg errors are routed through this macro,
 // so by placing a breakpoint in error_handler function code(defined in src/linalg/common.c), 
 // we can check the error directly
 #define LINALG_REPORT_ERROR(...) \
-        printf("Error: "); \
-        error_handler(__FILE__, __func__, __LINE__); \
-        printf(__VA_ARGS__); \
-        printf("\n");
+        { \
+            static LinalgDiagSite la_diag_site = {.file = __FILE__, .function = __func__, .line = __LINE__, .severity = LINALG_DIAG_ERROR}; \
+            linalgDiagReport(&la_diag_site, __VA_ARGS__); \
+        }
 
 // call this macro to handle warnings
 // all linalg errors are routed through this macro,
 // so by placing a breakpoint in error_handler function code(defined in src/linalg/common.c), 
 // we can check the error directly
 #define LINALG_REPORT_WARN(...) \
-        printf("Warning: "); \
-        error_handler(__FILE__, __func__, __LINE__); \
-        printf(__VA_ARGS__); \
-        printf("\n");
+        { \
+            static LinalgDiagSite la_diag_site = {.file = __FILE__, .function = __func__, .line = __LINE__, .severity = LINALG_DIAG_WARN}; \
+            linalgDiagReport(&la_diag_site, __VA_ARGS__); \
+        }
 
 // if condition is true, then report an error and return ret.
 // leave ret blank for void functions
@@ -51,13 +89,50 @@
             LINALG_REPORT_WARN(__VA_ARGS__) \
         }
 
+// Validation levels
+// LINALG_VALIDATE_OFF:      no checks in the kernels at all
+// LINALG_VALIDATE_BOUNDARY: argument checks(null pointers, dimensions) at kernel entry
+// LINALG_VALIDATE_FULL:     boundary checks + INF/NAN scans of inputs/outputs and bounds checked accessors
+#define LINALG_VALIDATE_OFF 0
+#define LINALG_VALIDATE_BOUNDARY 1
+#define LINALG_VALIDATE_FULL 2
+
+// compile time validation level, the makefile sets it(full for debug/test, boundary for release)
+// below LINALG_VALIDATE_FULL vecGet/vecRef/mat2DGet/mat2DRef become unchecked inline functions
+#ifndef LINALG_VALIDATION
+#define LINALG_VALIDATION LINALG_VALIDATE_FULL
+#endif
+
+// runtime validation level, starts at LINALG_VALIDATION. use linalgValidationSetLevel to change it
+extern int la_validation_level;
+
+// same as LINALG_ASSERT_ERROR, but skipped below LINALG_VALIDATE_BOUNDARY
+#define LINALG_CHECK_ERROR(condition, ret, ...) \
+        LINALG_ASSERT_ERROR(la_validation_level >= LINALG_VALIDATE_BOUNDARY && (condition), ret, __VA_ARGS__)
+
+// same as LINALG_WARN_IF, but skipped(condition is not evaluated) below LINALG_VALIDATE_FULL
+// use this for the O(n) INF/NAN scans
+#define LINALG_SCAN_WARN(condition, ...) \
+        LINALG_WARN_IF(la_validation_level >= LINALG_VALIDATE_FULL && (condition), __VA_ARGS__)
+
+// get the runtime validation level
+int linalgValidationLevel();
+// set the runtime validation level(clamped to off..full), returns the level actually selected
+// NOTE: accessor bounds checks are only compiled in when LINALG_VALIDATION is LINALG_VALIDATE_FULL
+int linalgValidationSetLevel(int level);
+
 // gets value at index from vector by reference(dereferenced)
 // allows for syntax like: VEC_INDEX(a, 2) = 5;
 #define VEC_INDEX(vector, index) *vecRef(vector, index)
 
-// This function is called in the LINALG_REPORT_ERROR and LINALG_ASSERT_ERROR macros
+// This function is called for every report in the LINALG_REPORT_* and LINALG_ASSERT_* macros, even the ones that are only counted
 void error_handler(const char* file, const char* function, size_t line_no);
 
+// alignment(bytes) of every heap allocated Vec/Mat2d buffer, one cache line
+#define LINALG_ALIGN 64
+// Mat2d rows allocated on the heap or in an arena are padded to a multiple of this many values
+#define LINALG_MAT_PAD (LINALG_ALIGN / sizeof(long double))
+
 // Vector implementation
 
 // a column vector
@@ -73,12 +148,18 @@ Vec vecInitA(long double value, size_t len);
 Vec vecInitZerosA(size_t len);
 // initialize the vector on the heap to ones
 Vec vecInitOnesA(size_t len);
+// allocate the vector on the heap WITHOUT initializing it, for outputs that are fully overwritten
+Vec vecInitUninitA(size_t len);
 
 // make a copy of a vector on heap
 Vec vecCopyA(Vec vector);
 
 // construct a vector from a pointer(does not allocate)
 Vec vecConstruct(long double* ptr, size_t len);
+// values [start, start + len) of a vector as a vector(by ref, keeps the offset)
+// Warning: this is a copy by reference
+// DO NOT USE after the vector is freed
+Vec vecSlice(Vec vector, size_t start, size_t len);
 
 // Concept allow allocation on stack, using alloca(increase stack size?)
 // advantages: 
@@ -91,6 +172,7 @@ void vecPrint(Vec a);
 // blatantly copied vecPrint which can print units (Only a single char)
 void printVecUnits(Vec f_n, char a);
 
+#if LINALG_VALIDATION >= LINALG_VALIDATE_FULL
 // gets the nth value in a vector(by value)
 // handles buffer offsets
 // checks for out-of-bounds
@@ -99,6 +181,12 @@ long double vecGet(Vec a, size_t n);
 // handles buffer offsets
 // checks for out-of-bounds( returns nullptr for out-of-bound access)
 long double* vecRef(Vec a, size_t n);
+#else
+// gets the nth value in a vector(by value), unchecked
+static inline long double vecGet(Vec a, size_t n) { return a.x[a.offset * n]; }
+// gets the nth value in a vector(by ref), unchecked
+static inline long double* vecRef(Vec a, size_t n) { return a.x + a.offset * n; }
+#endif
 
 // add 2 vectors and get result into another vector, prints error if input is invalid
 int vecAdd(Vec a, Vec b, Vec* result);
@@ -106,6 +194,13 @@ int vecAdd(Vec a, Vec b, Vec* result);
 int vecSub(Vec a, Vec b, Vec* result);
 // multiply scalar value to vectors and get result into another vector, prints error if input is invalid
 int vecScale(long double a, Vec b, Vec* result);
+// compute result = y + a[0]*v[0] + ... + a[k-1]*v[k-1] in one pass without temporaries, prints error if input is invalid
+// result may be the same vector as y or any of the v[i]
+int vecLinComb(Vec y, size_t k, const long double* a, const Vec* v, Vec* result);
+// compute y = a*x + y in place, prints error if input is invalid
+int vecAxpy(long double a, Vec x, Vec* y);
+// compute y = a*x + b*y in place, prints error if input is invalid
+int vecAxpby(long double a, Vec x, long double b, Vec* y);
 // unit vector of the norm, prints error if input is invalid
 int vecNormalize(Vec a, Vec* result);
 // get the dot product between 2 variables, prints error if input is invalid
@@ -137,6 +232,19 @@ long double vecStandardDeviation(Vec a);
 // returns 1 if vec contains a nan
 int vecContainsNan(Vec a);
 
+// convergence measures of a against a reference b, from one pass without forming a - b
+typedef struct LinalgDiffNorms
+{
+    long double max_diff;   // max |a - b|
+    long double rel_max;    // max |a - b| / max |b|
+    long double rms_diff;   // sqrt(mean (a - b)^2)
+    long double rel_rms;    // ||a - b||_2 / ||b||_2
+    int nonfinite;          // 1 if a or b contains INF or NAN(the relative norms are NAN then)
+} LinalgDiffNorms;
+
+// one pass difference norms of a against b(NAN/INF detection included, no scans). prints error if the input is invalid
+LinalgDiffNorms vecDiffNorms(Vec a, Vec b);
+
 // free the vector on the heap
 void freeVec(Vec* vec);
 
@@ -145,17 +253,19 @@ void freeVec(Vec* vec);
 /*=========================*/
 
 
-// Matrix is stored in 1d array
-// 0*col ... 1*cols-1: 1st row
-// 1*col ... 2*cols-1: 2nd row
-// 2*col ... 3*cols-1: 3nd row
+// Matrix is stored in 1d array, row after row with a row stride(leading dimension) ld >= cols
+// 0*ld ... 0*ld+cols-1: 1st row
+// 1*ld ... 1*ld+cols-1: 2nd row
+// 2*ld ... 2*ld+cols-1: 3nd row
 // so on
-// (row-1)*col ... row*cols-1: last row
+// (row-1)*ld ... (row-1)*ld+cols-1: last row
+// the allocators pad ld to a whole number of LINALG_ALIGN byte lines(every row starts aligned), the padding holds no values
 typedef struct Mat2d
 {
     long double* mat;
     size_t rows;
     size_t cols;
+    size_t ld;
 } Mat2d;
 
 // initialzie the matrix on the heap with some initial value
@@ -164,22 +274,37 @@ Mat2d mat2DInitA(long double value, size_t rows, size_t cols);
 Mat2d mat2DInitZerosA(size_t rows, size_t cols);
 // initialize the matrix on the heap to ones
 Mat2d mat2DInitOnesA(size_t rows, size_t cols);
+// allocate the matrix on the heap WITHOUT initializing it, for outputs that are fully overwritten
+Mat2d mat2DInitUninitA(size_t rows, size_t cols);
 
 // make a copy of a matrix on heap
 Mat2d mat2DCopyA(Mat2d matrix);
 
-// construct a matrix from a pointer(does not allocate)
+// construct a matrix from a pointer(does not allocate), rows are contiguous(ld = cols)
 Mat2d mat2DConstruct(long double* ptr, size_t rows, size_t cols);
+// construct a matrix from a pointer with rows ld values apart(does not allocate)
+Mat2d mat2DConstructStrided(long double* ptr, size_t rows, size_t cols, size_t ld);
+// rows [row, row + rows) and cols [col, col + cols) of a matrix as a matrix(by ref, keeps the ld)
+// every kernel accepts views. Warning: this is a copy by reference
+// DO NOT USE after matrix is freed
+Mat2d mat2DView(Mat2d matrix, size_t row, size_t col, size_t rows, size_t cols);
 
 // pretty print a matrix
 void mat2DPrint(Mat2d a);
 
+#if LINALG_VALIDATION >= LINALG_VALIDATE_FULL
 // gets the value at row and col in a matrix(by value)
 // checks for out-of-bounds
 long double mat2DGet(Mat2d a, size_t row, size_t col);
 // gets the value at row and col in a matrix(by ref)
 // checks for out-of-bounds( returns nullptr is performed )
 long double* mat2DRef(Mat2d a, size_t row, size_t col);
+#else
+// gets the value at row and col in a matrix(by value), unchecked
+static inline long double mat2DGet(Mat2d a, size_t row, size_t col) { return a.mat[row * a.ld + col]; }
+// gets the value at row and col in a matrix(by ref), unchecked
+static inline long double* mat2DRef(Mat2d a, size_t row, size_t col) { return a.mat + row * a.ld + col; }
+#endif
 
 // get a row as vector(by ref)
 // Warning: this is a copy by reference
@@ -201,16 +326,31 @@ int mat2DScale(long double a, Mat2d b, Mat2d* result);
 int mat2DTransform(Mat2d A, Vec x, Vec* result);
 // compute result = Ax(allocates result Vec). prints error if the input is invalid
 Vec mat2DTransformA(Mat2d A, Vec x);
-
-// compute result = A*B. prints error if the input is invalid
+// compute result = A^T x without forming A^T(row sweep, multithreaded for large matrices). prints error if the input is invalid
+// result can not be x
+int mat2DTransformT(Mat2d A, Vec x, Vec* result);
+// compute result = A^T x without forming A^T(allocates result Vec). prints error if the input is invalid
+Vec mat2DTransformTA(Mat2d A, Vec x);
+
+// compute result = A*B(cache blocked, multithreaded for large matrices). prints error if the input is invalid
+// result can not be A or B
 int mat2DMul(Mat2d A, Mat2d B, Mat2d* result);
 // compute result = A*B(allocates memory). prints error if the input is invalid
 Mat2d mat2DMulA(Mat2d A, Mat2d B);
 
-// calculate result = A^k for k > 0; 
-// UNIMPLEMENTED
+// calculate result = A^k by repeated squaring(O(log k) products, A^0 = I). prints error if the input is invalid
+// result can be A
 int mat2DSqPowU(Mat2d A, unsigned int k, Mat2d* result);
 
+// compute result = e^A(scaling and squaring with a Pade approximant, Higham 2005). prints error if the input is invalid
+// result can be A
+int mat2DExpm(Mat2d A, Mat2d* result);
+// compute e^A(allocates memory). prints error if the input is invalid
+Mat2d mat2DExpmA(Mat2d A);
+// compute result = e^(tA) v without forming e^(tA): Krylov subspaces of dimension m with adaptive time steps(Expokit expv)
+// tol bounds the local error of every step. prints error if the input is invalid or the steps fail, result can be v
+int mat2DExpmv(Mat2d A, long double t, Vec v, size_t m, long double tol, Vec* result);
+
 // compute result = A^T. prints error if the input is invalid
 int mat2DTranspose(Mat2d A, Mat2d* result);
 
@@ -223,6 +363,8 @@ long double mat2DMin(Mat2d a);
 
 // returns 1 if matrix contains nan
 int mat2DContainsNan(Mat2d a);
+// one pass difference norms of a against b, see vecDiffNorms. prints error if the input is invalid
+LinalgDiffNorms mat2DDiffNorms(Mat2d a, Mat2d b);
 
 // free the matrix on the heap
 void freeMat2D(Mat2d* mat);
@@ -236,4 +378,368 @@ typedef struct MatTD
     Vec sup;
 }MatTD;
 
-MatTD matTDinitA(size_t len);
\ No newline at end of file
+MatTD matTDinitA(size_t len);
+
+/*=========================*/
+// Banded matrices
+/*=========================*/
+
+// n x n matrix with kl diagonals below and ku above the main one, stored row by row:
+// entry(i, j), -kl <= j - i <= ku, is band[i*(kl + ku + 1) + kl + j - i]. the slots outside the matrix(top left, bottom right) are unused
+typedef struct MatBand
+{
+    long double* band;
+    size_t n;
+    size_t kl;
+    size_t ku;
+} MatBand;
+
+// initialize a banded matrix on the heap to zeros
+MatBand matBandInitA(size_t n, size_t kl, size_t ku);
+// gets the value at row and col(0 outside the band)
+long double matBandGet(MatBand A, size_t row, size_t col);
+// gets the value at row and col(by ref), returns nullptr outside the band or the matrix
+long double* matBandRef(MatBand A, size_t row, size_t col);
+// compute result = Ax. prints error if the input is invalid
+int matBandTransform(MatBand A, Vec x, Vec* result);
+// LU in place WITHOUT pivoting, so there is no fill outside the band(L in the kl lower diagonals, U in the rest)
+// meant for diagonally dominant or SPD matrices(stencils), prints error on a zero pivot
+int matBandLUFactor(MatBand* A);
+// solve Ax = b with the factors from matBandLUFactor, x may be b. prints error if the input is invalid
+int matBandLUSolve(MatBand LU, Vec b, Vec* x);
+// free the banded matrix on the heap
+void freeMatBand(MatBand* A);
+
+// block tridiagonal matrix of blocks x blocks square blocks of size bs(i.e a coupled system per mesh point)
+// the blocks are reached through matBlockTDSub/Main/Sup
+typedef struct MatBlockTD
+{
+    long double* data;
+    size_t blocks;
+    size_t bs;
+} MatBlockTD;
+
+// initialize a block tridiagonal matrix on the heap to zeros
+MatBlockTD matBlockTDInitA(size_t blocks, size_t bs);
+// block(k, k-1) as a matrix(by ref), k >= 1
+Mat2d matBlockTDSub(MatBlockTD A, size_t k);
+// block(k, k) as a matrix(by ref)
+Mat2d matBlockTDMain(MatBlockTD A, size_t k);
+// block(k, k+1) as a matrix(by ref), k < blocks - 1
+Mat2d matBlockTDSup(MatBlockTD A, size_t k);
+// compute result = Ax. prints error if the input is invalid, result can not be x
+int matBlockTDTransform(MatBlockTD A, Vec x, Vec* result);
+// solve Ax = b with block Thomas elimination(pivoted LU of every reduced diagonal block), A is not modified
+// x may be b. prints error if the input is invalid or a reduced block is singular
+int matBlockTDSolve(MatBlockTD A, Vec b, Vec* x);
+// free the block tridiagonal matrix on the heap
+void freeMatBlockTD(MatBlockTD* A);
+
+/*=========================*/
+// Sparse matrices(CSR)
+/*=========================*/
+
+// compressed sparse row matrix: the nonzeros of row i are val[rowptr[i]..rowptr[i+1]), in column order
+typedef struct MatCSR
+{
+    long double* val;
+    size_t* col;
+    size_t* rowptr;     // rows + 1 entries
+    size_t rows;
+    size_t cols;
+    size_t nnz;
+} MatCSR;
+
+// value of entry(i, j) for the assembly functions
+typedef long double (*MatCSREntryFn)(size_t i, size_t j, void* ctx);
+
+// allocate an empty rows x cols CSR matrix with room for nnz entries(allocates memory)
+MatCSR matCSRInitA(size_t rows, size_t cols, size_t nnz);
+// keep the entries of a dense matrix with |a_ij| > tol(magnitude cutoff, allocates memory)
+MatCSR matCSRFromMat2DA(Mat2d A, long double tol);
+// n x n matrix with an entry for every pair with |pos[i] - pos[j]| <= cutoff(diagonal included), valued by entry(i, j, ctx)
+// O(n log n + nnz), pos does not need to be sorted(allocates memory)
+MatCSR matCSRFromDistanceA(Vec pos, long double cutoff, MatCSREntryFn entry, void* ctx);
+// write the CSR matrix into a dense one of the same size(zeros elsewhere). prints error if the input is invalid
+int matCSRToMat2D(MatCSR A, Mat2d* result);
+// compute result = Ax. prints error if the input is invalid, result can not be x
+int matCSRTransform(MatCSR A, Vec x, Vec* result);
+// compute result = A^T x. prints error if the input is invalid, result can not be x
+int matCSRTransformT(MatCSR A, Vec x, Vec* result);
+// compute result = e^(tA) v, same as mat2DExpmv. prints error if the input is invalid or the steps fail, result can be v
+int matCSRExpmv(MatCSR A, long double t, Vec v, size_t m, long double tol, Vec* result);
+// inverse of the diagonal(Jacobi preconditioner, allocates memory). prints error on a missing or zero diagonal entry
+Vec matCSRJacobiA(MatCSR A);
+// incomplete LU with no fill(ILU(0)): L(unit diagonal, not stored) and U in the sparsity pattern of A(allocates memory)
+// needs every diagonal entry, prints error on a missing diagonal or a zero pivot
+MatCSR matCSRILU0A(MatCSR A);
+// solve LUz = r with the factors from matCSRILU0A, z may be r. prints error if the input is invalid
+int matCSRILU0Solve(MatCSR LU, Vec r, Vec* z);
+// free the CSR matrix on the heap
+void freeMatCSR(MatCSR* A);
+
+/*=========================*/
+// LU factorization
+/*=========================*/
+
+// PA = LU with partial pivoting. factor once, then solve as often as needed(i.e chord newton, implicit steppers).
+// L(unit diagonal, not stored) and U share one n x n matrix, the factorization can run in place on lu.lu:
+//  assemble A straight into lu.lu, then matLUFactor(lu.lu, &lu)
+typedef struct MatLU
+{
+    Mat2d lu;           // L below the diagonal, U on and above it
+    size_t* perm;       // row i of PA is row perm[i] of A
+    int sign;           // determinant of P(+1 or -1)
+    int singular;       // 1 if a zero pivot was found(solves fail)
+    long double anorm;  // 1-norm of A, used by matLUCond1Est
+} MatLU;
+
+// allocate an (unfactored) n x n LU object(allocates memory)
+MatLU matLUInitA(size_t n);
+// factor A into a new LU object(allocates memory). prints error if the input is invalid or singular
+MatLU matLUFactorA(Mat2d A);
+// factor A into an existing LU object of the same size, A may be lu->lu(in place). prints error if the input is invalid or singular
+int matLUFactor(Mat2d A, MatLU* lu);
+// solve Ax = b with a factored A, x may be b. prints error if the input is invalid
+int matLUSolve(MatLU lu, Vec b, Vec* x);
+// solve AX = B for every column of B, X may be B. prints error if the input is invalid
+int matLUSolveMulti(MatLU lu, Mat2d B, Mat2d* X);
+// estimate of the 1-norm condition number ||A||_1 ||A^-1||_1(Hager/Higham), O(n^2). INFINITY for singular A
+long double matLUCond1Est(MatLU lu);
+// free the LU object on the heap
+void freeMatLU(MatLU* lu);
+
+/*=========================*/
+// Krylov solvers
+/*=========================*/
+
+// the solvers only see the matrix through y = Ax, so it can be dense, sparse or matrix free(i.e a finite difference Jacobian)
+// the preconditioner is applied the same way, z = M^-1 r. both are (function, context) pairs:
+//  LinalgOperator A = linalgOperatorCSR(&J);
+//  MatCSR ilu = matCSRILU0A(J);
+//  linalgGMRES(A, linalgOperatorILU0(&ilu), F, &dx, (LinalgKrylovConfig){1e-10, 500, 30}, &info);
+
+// y = op(x), returns LINALG_OK or LINALG_ERROR. y is never x
+typedef int (*LinalgApplyFn)(Vec x, Vec* y, void* ctx);
+
+typedef struct LinalgOperator
+{
+    LinalgApplyFn apply;    // NULL as a preconditioner means none
+    void* ctx;
+} LinalgOperator;
+
+typedef struct LinalgKrylovConfig
+{
+    long double tol;    // stop at ||b - Ax|| <= tol ||b||
+    size_t max_iter;    // GMRES: matrix products, BiCGSTAB: iterations(2 products each)
+    size_t restart;     // GMRES restart length(ignored by BiCGSTAB)
+} LinalgKrylovConfig;
+
+typedef struct LinalgKrylovInfo
+{
+    size_t iterations;
+    long double residual;   // ||b - Ax|| / ||b|| at exit
+} LinalgKrylovInfo;
+
+// operator y = Ax of a dense matrix(by ref, A must outlive the operator)
+LinalgOperator linalgOperatorMat2D(Mat2d* A);
+// operator y = Ax of a CSR matrix(by ref)
+LinalgOperator linalgOperatorCSR(MatCSR* A);
+// Jacobi preconditioner z = inv_diag .* r(by ref), see matCSRJacobiA/mat2DJacobiA
+LinalgOperator linalgOperatorJacobi(Vec* inv_diag);
+// ILU(0) preconditioner z = (LU)^-1 r(by ref), see matCSRILU0A
+LinalgOperator linalgOperatorILU0(MatCSR* LU);
+// inverse of the diagonal of a dense matrix(Jacobi preconditioner, allocates memory). prints error on a zero diagonal entry
+Vec mat2DJacobiA(Mat2d A);
+
+// solve Ax = b with restarted, right preconditioned GMRES. x holds the initial guess(i.e zeros) on entry
+// returns LINALG_OK once converged, LINALG_ERROR(with a warning) otherwise. info may be NULL
+int linalgGMRES(LinalgOperator A, LinalgOperator M, Vec b, Vec* x, LinalgKrylovConfig config, LinalgKrylovInfo* info);
+// solve Ax = b with right preconditioned BiCGSTAB(short recurrences, no restart memory). same conventions as linalgGMRES
+int linalgBiCGSTAB(LinalgOperator A, LinalgOperator M, Vec b, Vec* x, LinalgKrylovConfig config, LinalgKrylovInfo* info);
+
+/*=========================*/
+// Arena allocator
+/*=========================*/
+
+// Bump allocator for temporaries: allocations are 64-byte aligned and are all released at once by linalgArenaPop.
+// The arena grows by chaining blocks when it runs out, blocks freed by a pop are kept for reuse.
+// Vec/Mat2d allocated from an arena are NOT freed with freeVec/freeMat2D, popping their scope releases them.
+//
+//  LinalgArenaMark mark = linalgArenaPush(&arena);
+//  Vec tmp = vecInitZerosArena(&arena, n);
+//  ...
+//  linalgArenaPop(&arena, mark);
+
+typedef struct LinalgArenaBlock LinalgArenaBlock;
+
+typedef struct LinalgArena
+{
+    LinalgArenaBlock* block;    // block allocations are taken from(newest)
+    LinalgArenaBlock* spare;    // block released by a pop, reused on the next overflow
+    size_t block_size;          // capacity of the next new block
+} LinalgArena;
+
+// a scope, returned by linalgArenaPush
+typedef struct LinalgArenaMark
+{
+    LinalgArenaBlock* block;
+    size_t top;
+} LinalgArenaMark;
+
+// create an arena with an initial capacity in bytes(allocates memory)
+LinalgArena linalgArenaInitA(size_t capacity);
+// open a scope, everything allocated after this is released by linalgArenaPop(mark)
+LinalgArenaMark linalgArenaPush(LinalgArena* arena);
+// release everything allocated since mark in O(1)(frees chained blocks, if any)
+void linalgArenaPop(LinalgArena* arena, LinalgArenaMark mark);
+// allocate 64-byte aligned memory from the arena, returns NULL on failure
+void* linalgArenaAlloc(LinalgArena* arena, size_t bytes);
+// free the arena and everything allocated from it
+void freeLinalgArena(LinalgArena* arena);
+
+// initialzie the vector in the arena with some initial value
+Vec vecInitArena(LinalgArena* arena, long double value, size_t len);
+// initialize the vector in the arena to zeros
+Vec vecInitZerosArena(LinalgArena* arena, size_t len);
+// make a copy of a vector in the arena(the copy is contiguous)
+Vec vecCopyArena(LinalgArena* arena, Vec vector);
+// initialzie the matrix in the arena with some initial value
+Mat2d mat2DInitArena(LinalgArena* arena, long double value, size_t rows, size_t cols);
+// initialize the matrix in the arena to zeros
+Mat2d mat2DInitZerosArena(LinalgArena* arena, size_t rows, size_t cols);
+
+/*=========================*/
+// Precision families
+/*=========================*/
+
+// Vec/Mat2d are long double, which on x86-64 means x87 arithmetic that never vectorizes.
+// VecD/Mat2dD(double) and VecF/Mat2dF(float) are the same types and kernels in lower precision,
+// the functions are named by adding D or F to the group prefix, i.e vecDAdd, mat2DFMul, freeVecD.
+// Both families are generated from include/linalg_family.inc(declarations) and src/linarg/family.inc(definitions)
+
+#define LA_FAMILY_T double
+#define LA_FAMILY_VEC VecD
+#define LA_FAMILY_MAT Mat2dD
+#define LA_FAMILY_VFN(name) vecD##name
+#define LA_FAMILY_MFN(name) mat2DD##name
+#define LA_FAMILY_VFREE freeVecD
+#define LA_FAMILY_MFREE freeMat2DD
+#include "include/linalg_family.inc"
+
+#define LA_FAMILY_T float
+#define LA_FAMILY_VEC VecF
+#define LA_FAMILY_MAT Mat2dF
+#define LA_FAMILY_VFN(name) vecF##name
+#define LA_FAMILY_MFN(name) mat2DF##name
+#define LA_FAMILY_VFREE freeVecF
+#define LA_FAMILY_MFREE freeMat2DF
+#include "include/linalg_family.inc"
+
+// mixed precision LU: PA = LU factored in double(simd row updates), solutions refined against the long double A.
+// every refinement step computes r = b - Ax in long double and corrects x with a double solve, so x reaches long double
+// accuracy as long as cond(A) is well below 1/DBL_EPSILON, at the O(n^3) cost of a double factorization.
+typedef struct MatLUD
+{
+    Mat2dD lu;          // L below the diagonal, U on and above it
+    size_t* perm;       // row i of PA is row perm[i] of A
+    int singular;       // 1 if a zero pivot was found(solves fail)
+} MatLUD;
+
+// allocate an (unfactored) n x n double LU object(allocates memory)
+MatLUD matLUDInitA(size_t n);
+// round A to double and factor it into lu. prints error if the input is invalid or singular
+int matLUDFactor(Mat2d A, MatLUD* lu);
+// solve Ax = b with lu = the double factors of A, refined to long double accuracy. x may be b
+// returns LINALG_ERROR(with a warning) if the refinement stalls(A too ill conditioned), x then holds the best iterate
+int matLUDSolveRefined(MatLUD lu, Mat2d A, Vec b, Vec* x);
+// free the LU object on the heap
+void freeMatLUD(MatLUD* lu);
+
+// simd level used by the contiguous(offset == 1) double/float vector kernels
+// picked at runtime from cpuid, strided vectors(i.e mat2DDCol) always use scalar code
+#define LINALG_SIMD_SCALAR 0
+#define LINALG_SIMD_AVX2 1
+#define LINALG_SIMD_AVX512 2
+
+// get the simd level in use
+int linalgSimdLevel();
+// force a simd level(for testing or benchmarking), clamped to what the cpu supports.
+// returns the level actually selected
+int linalgSimdSetLevel(int level);
+
+// threads used by the parallel kernels(i.e mat2DMul on large matrices)
+// defaults to the number of online cpus
+int linalgParallelThreads();
+// set the number of threads used by the parallel kernels(0 = number of cpus), returns the count actually selected
+int linalgParallelSetThreads(int threads);
+
+/*=========================*/
+// Batched small systems
+/*=========================*/
+
+// batch independent n x n double systems(i.e one per bias or temperature point of a sweep), interleaved so that
+// consecutive systems sit next to each other: entry(i, j) of system s is mat[(i*n + j)*stride + s] and
+// element i of a batched vector is x[i*stride + s]. every operation runs the simd kernels across the systems,
+// so a batch costs one allocation and one validation instead of one per system.
+// stride is batch rounded up to a LINALG_ALIGN line, the padding holds no values
+typedef struct MatBatchD
+{
+    double* mat;
+    size_t n;
+    size_t batch;
+    size_t stride;
+} MatBatchD;
+
+typedef struct VecBatchD
+{
+    double* x;
+    size_t n;
+    size_t batch;
+    size_t stride;
+} VecBatchD;
+
+// PA = LU of every system of a batch, same layout as MatLU
+typedef struct MatBatchLUD
+{
+    MatBatchD lu;       // L below the diagonal, U on and above it
+    size_t* perm;       // row i of PA(system s) is row perm[i*stride + s] of A
+    int* singular;      // per system, 1 if a zero pivot was found(its solutions are NAN)
+} MatBatchLUD;
+
+// initialize batch n x n matrices on the heap to zeros
+MatBatchD matBatchDInitA(size_t n, size_t batch);
+// initialize batch vectors of length n on the heap to zeros
+VecBatchD vecBatchDInitA(size_t n, size_t batch);
+// entry(i, j) of system s by ref, DOES NOT CHECK FOR OUT OF BOUNDS ACCESS
+static inline double* matBatchDRef(MatBatchD A, size_t s, size_t i, size_t j) { return A.mat + (i * A.n + j) * A.stride + s; }
+// element i of system s by ref, DOES NOT CHECK FOR OUT OF BOUNDS ACCESS
+static inline double* vecBatchDRef(VecBatchD x, size_t s, size_t i) { return x.x + i * x.stride + s; }
+// copy system s out of/into a batch(long double <-> double). prints error if the input is invalid
+int matBatchDGetSystem(MatBatchD A, size_t s, Mat2d* result);
+int matBatchDSetSystem(MatBatchD* A, size_t s, Mat2d M);
+// compute y = Ax for every system, y can't be x. prints error if the input is invalid
+int matBatchDTransform(MatBatchD A, VecBatchD x, VecBatchD* y);
+// allocate an (unfactored) LU object for batch n x n systems(allocates memory)
+MatBatchLUD matBatchLUDInitA(size_t n, size_t batch);
+// factor every system of A, A may be lu->lu(in place). returns LINALG_ERROR(with a warning) if any system is singular,
+// the others are still factored, see lu->singular
+int matBatchLUDFactor(MatBatchD A, MatBatchLUD* lu);
+// solve Ax = b for every system with a factored A, x may be b. prints error if the input is invalid
+int matBatchLUDSolve(MatBatchLUD lu, VecBatchD b, VecBatchD* x);
+// free the batch of matrices on the heap
+void freeMatBatchD(MatBatchD* A);
+// free the batch of vectors on the heap
+void freeVecBatchD(VecBatchD* x);
+// free the batched LU object on the heap
+void freeMatBatchLUD(MatBatchLUD* lu);
+
+// working precision of the hot loops in steadystate, coefficients and master_eqn
+// long double by default, `make PRECISION=double` defines LINALG_WORK_DOUBLE
+// (the coefficient assembly runs in double and jacobianImplementationA factors every jacobian with MatLUD)
+// the public interfaces of those modules stay in long double(Vec, Mat2d)
+#ifdef LINALG_WORK_DOUBLE
+typedef double linalg_work_t;
+#else
+typedef long double linalg_work_t;
+#endif
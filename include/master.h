@@ -5,8 +5,13 @@
 #include<math.h>
 #include<stdlib.h>
 #include<include/inputs.h>
+#include<include/poisson.h>
 
 #define N 1e6
+// vectors taken from the arena by one rkf45 step(stage, k_0..k_5, y_4, y_5, error and the master equation temporaries)
+#define RK45_STEP_TEMPS 24
+// stages of one rkf45 step, each takes its trap energies from the arena
+#define RK45_STAGES 6
 
 typedef struct rk45
 {
@@ -21,12 +26,15 @@ typedef struct RK45Config
     long double t_final;
     Vec y_initial;
     long double tol;
-    Vec mesh;
+    Mesh mesh;
     InputData data;
 } RK45Config;
 
-Vec f(long double t, Vec y, InputData data, Vec mesh);
+// rhs of the master equation, the result is allocated from the arena
+// poisson is the solver for the mesh in influence matrix mode(see poissonSolverInfluence), shared by all the stages
+Vec f(long double t, Vec y, InputData data, const PoissonSolver* poisson, LinalgArena* arena);
 
-rk45 rkf45_calculator(long double h, long double t_i, Vec y_i, InputData data, Vec mesh);
+// one rkf45 step, y_5 and err are allocated from the arena(valid until the caller pops it)
+rk45 rkf45_calculator(long double h, long double t_i, Vec y_i, InputData data, const PoissonSolver* poisson, LinalgArena* arena);
 
 void solver(RK45Config config, Vec t_res, Mat2d res);
\ No newline at end of file
@@ -33,6 +33,20 @@
 // } OxParams;
 
 
+/**
+ * @brief Mesh for the numerical solver, with the mesh index of every trap and interval boundary
+ *
+ * generateMesh records the indices while it builds the mesh, so the right hand side assembly and
+ * the potential at the traps are direct lookups instead of scans over the whole mesh.
+ */
+typedef struct Mesh
+{
+    Vec x;              // mesh points, from 0 to L
+    size_t* bound;      // mesh index of each interval boundary: 0, the traps, L(traps + 2 entries)
+    size_t* trap;       // mesh index of each trap, points into bound(bound + 1)
+    size_t traps;
+} Mesh;
+
 /**
  * @brief Validates input vectors and position for Poisson solver
  *
@@ -119,10 +133,13 @@ Vec getGridV(Vec f_n, Vec d);
 Vec getGridE(Vec f_n, Vec d, OxParams params);
 
 /**
- * @brief Converts a dynamic stack to a vector
+ * @brief Converts a dynamic stack of long doubles to a vector
  *
- * @param dstack Pointer to dynamic stack
+ * @param dstack Pointer to dynamic stack, left empty
  * @param vec Pointer to vector to store result
+ * 
+ * Notes:
+ * - The vector takes over the stack buffer(no copy), free it with freeVec
  */
 void stackToVec(DynStack* dstack, Vec* vec);
 
@@ -146,14 +163,22 @@ int validateVec(const Vec d, const OxParams params);
  *
  * @param d Vector of charge positions
  * @param oxparams Oxide parameters
- * @return Vector containing mesh points
+ * @return Mesh points and the index of every trap and boundary, NULL mesh if inputs invalid
  * 
  * Creates uniform mesh with fixed number of points between:
  * - Start (0) and first charge
  * - Each pair of consecutive charges
  * - Last charge and end of oxide (L)
+ * 
+ * Notes:
+ * - Free it with freeMesh
+ */
+Mesh generateMesh(Vec d, OxParams oxparams);
+
+/**
+ * @brief Frees the mesh points and the index map
  */
-Vec generateMesh(Vec d, OxParams oxparams);
+void freeMesh(Mesh* mesh);
 
 
 /**
@@ -165,16 +190,132 @@ Vec generateMesh(Vec d, OxParams oxparams);
  */
 Vec generateStepSize(Vec mesh_vec);
 
-Vec constructB(Vec f_n, Vec d, Vec mesh, size_t chunk, OxParams params);
+Vec constructB(Vec f_n, Mesh mesh, OxParams params);
 
 MatTD generateJacobian(Vec mesh);
 
 Vec numSolveV(MatTD mat, Vec b);
 
-Vec poissonWrapper(InputData data, Vec mesh);
+Vec poissonWrapper(InputData data, Mesh mesh);
+
+Vec getGridNumV(InputData data, Mesh mesh);
+
+Vec getGridNumE(InputData data, Mesh mesh);
+
+/**
+ * @brief Poisson solver for a fixed mesh and trap layout, with the tridiagonal system already eliminated
+ *
+ * Everything that depends only on the mesh, the trap positions and eps_r is computed once by
+ * poissonSolverInitA. A solve is then only the forward/back substitution, into a buffer the caller owns.
+ * The solver is read only after init, so one solver can be shared by threads(each with its own buffers).
+ * Results are bitwise identical to poissonWrapper/getGridNumE.
+ */
+typedef struct PoissonSolver
+{
+    Mesh mesh;          // referenced, must outlive the solver
+    Vec sub;            // sub diagonal of the jacobian
+    Vec den;            // pivots of the Thomas elimination
+    Vec sup;            // super diagonal divided by the pivots
+    Vec scale;          // b entry of trap n is f_n * Q / scale_n, scale_n = eps_r * eps_0 * h^3
+    Mat2d influence;    // G, trap potentials per unit trap charge, empty until poissonSolverInfluence
+    Vec bias_0;         // trap potentials per volt of V_0
+    Vec bias_L;         // trap potentials per volt of V_L
+} PoissonSolver;
+
+/**
+ * @brief Builds the solver for a mesh(see generateMesh) and the traps in data
+ *
+ * @param data Input data, uses locs(only the count) and eps_r
+ * @param mesh The mesh, kept by reference
+ * @return The solver, scale is NULL if the inputs are invalid
+ */
+PoissonSolver poissonSolverInitA(InputData data, Mesh mesh);
+
+/**
+ * @brief Solves for the potential on the mesh, no allocations
+ *
+ * @param solver Solver from poissonSolverInitA
+ * @param data Input data, uses probs, V_0 and V_L
+ * @param V Result, mesh.x.len long
+ * @return 1 on success, 0 if the inputs are invalid
+ */
+int poissonSolverSolve(const PoissonSolver* solver, InputData data, Vec* V);
+
+/**
+ * @brief Trap energies(same as getGridNumE), no allocations
+ *
+ * @param solver Solver from poissonSolverInitA
+ * @param data Input data, uses probs, energies, electron_affinity, V_0 and V_L
+ * @param V Work buffer, mesh.x.len long, holds the potential on the mesh afterwards
+ * @param E Result, one entry per trap
+ * @return 1 on success, 0 if the inputs are invalid
+ */
+int poissonSolverGridE(const PoissonSolver* solver, InputData data, Vec* V, Vec* E);
+
+/**
+ * @brief Solves K right hand sides in one pass, no allocations
+ *
+ * Right hand side r has the charges in column r of probs and the electrode potentials V_0.x[r], V_L.x[r].
+ * The Thomas sweeps are interleaved: each pivot of the factors is loaded once and applied to every right hand side,
+ * and blocks of right hand sides run in parallel on the thread pool. Row r of V is bitwise identical to poissonSolverSolve.
+ *
+ * @param solver Solver from poissonSolverInitA
+ * @param probs Charges, one row per trap and one column per right hand side(a view of the transient f_n(t) works)
+ * @param V_0 Potential at x = 0 of each right hand side
+ * @param V_L Potential at x = L of each right hand side
+ * @param V Result, K x mesh.x.len, one potential per row
+ * @return 1 on success, 0 if the inputs are invalid
+ */
+int poissonSolverSolveBatch(const PoissonSolver* solver, Mat2d probs, Vec V_0, Vec V_L, Mat2d* V);
+
+/**
+ * @brief Batched poissonWrapper, solves every column of probs on the mesh
+ *
+ * @param data Input data, uses locs(only the count) and eps_r
+ * @param mesh The mesh
+ * @param probs Charges, one column per right hand side
+ * @param V_0 Potential at x = 0 of each right hand side
+ * @param V_L Potential at x = L of each right hand side
+ * @return K x mesh.x.len matrix of potentials, NULL matrix if the inputs are invalid
+ */
+Mat2d poissonWrapperBatchA(InputData data, Mesh mesh, Mat2d probs, Vec V_0, Vec V_L);
+
+/**
+ * @brief Switches the solver to influence matrix mode, for the trap potentials only
+ *
+ * The problem is linear in the charges, so the potential at the traps is V_trap = bias_0 * V_0 + bias_L * V_L + G * f_n.
+ * G and the bias columns are one back substitution per trap(plus two for the electrodes) on the existing factors,
+ * run in parallel on the thread pool. After that poissonSolverTrapV/poissonSolverTrapE are an N x N mat-vec
+ * instead of a solve over the whole mesh. Results agree with the full solve to rounding, not bitwise.
+ *
+ * @param solver Solver from poissonSolverInitA
+ * @return 1 on success, 0 if the solver is invalid or the allocation failed
+ */
+int poissonSolverInfluence(PoissonSolver* solver);
 
-Vec getGridNumV(InputData data, Vec mesh);
+/**
+ * @brief Potentials at the traps(same as getGridNumV) from the influence matrix, no allocations
+ *
+ * @param solver Solver after poissonSolverInfluence
+ * @param data Input data, uses probs, V_0 and V_L
+ * @param V Result, one entry per trap, can not be data.probs
+ * @return 1 on success, 0 if the inputs are invalid or the influence matrix is not built
+ */
+int poissonSolverTrapV(const PoissonSolver* solver, InputData data, Vec* V);
 
-Vec getGridNumE(InputData data, Vec mesh);
+/**
+ * @brief Trap energies(same as getGridNumE) from the influence matrix, no allocations
+ *
+ * @param solver Solver after poissonSolverInfluence
+ * @param data Input data, uses probs, energies, electron_affinity, V_0 and V_L
+ * @param E Result, one entry per trap, can not be data.probs
+ * @return 1 on success, 0 if the inputs are invalid or the influence matrix is not built
+ */
+int poissonSolverTrapE(const PoissonSolver* solver, InputData data, Vec* E);
+
+/**
+ * @brief Frees the solver, the mesh is not freed
+ */
+void freePoissonSolver(PoissonSolver* solver);
 
 void printNL();
\ No newline at end of file
@@ -35,6 +35,9 @@ PyViBase pyviCreateParameter(PyVi* pyvi, const char* param_name, Vec p);
 // push a vector fx varying with parameter x, copies the vector
 void pyviSectionPush(PyViSec section, Vec fx);
 
+// reserve space for count pushes to a section, so its storage is allocated once
+void pyviSectionReserve(PyViSec section, size_t count);
+
 // writes all the data to file
 void pyviWrite(PyVi pyvi);
 
@@ -13,12 +13,23 @@ typedef struct DynStack
 
 // make a empty dyn stack
 DynStack dynStackInit(size_t elem_len);
-// Reserve N element space
-DynStack dynStackReserve(size_t new_len);
+// make sure there is space for new_len elements in total, so pushes up to that length do not reallocate.
+// never shrinks, prints an error and leaves the stack as is if the allocation fails
+void dynStackReserve(DynStack* dstack, size_t new_len);
+
+// release the reserve space past len
+void dynStackShrink(DynStack* dstack);
 
 // push element_size data to stack, WARNING: assumes data is element_size large!
 void dynStackPush(DynStack* dstack, void* data);
 
+// push count elements at once(one reallocation at most), WARNING: assumes data is count * element_size large!
+void dynStackPushN(DynStack* dstack, const void* data, size_t count);
+
+// take the buffer out of the stack(shrunk to fit), the caller owns it and frees it with free().
+// len is set to the number of elements, the stack is left empty
+void* dynStackDetach(DynStack* dstack, size_t* len);
+
 // access a element in dyn stack, safely
 void* dynStackGet(DynStack dstack, size_t index);
 
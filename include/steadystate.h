@@ -20,6 +20,10 @@ void gaussianElimination(Mat2d A/*jacobian matrix*/, Vec b/*coefficient vector*/
 
 void backSubsA(Mat2d A, Vec b, Vec* x);
 
+void masterEquationCoeff(Vec f, Vec R1, Vec R2, Mat2d coeffmatrix, LinalgArena* arena, Vec* F);
+
+void masterEquationCoeffCSR(Vec f, Vec R1, Vec R2, MatCSR coeffmatrix, LinalgArena* arena, Vec* F);
+
 Vec masterEquationCoeffA(Vec f, Vec R1, Vec R2, Mat2d coeffmatrix);
 
 Vec jacobianImplementationA(Mat2d coeffmatrix, Vec R1, Vec R2);
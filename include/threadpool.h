@@ -0,0 +1,48 @@
+#pragma once
+
+// Shared worker pool for every parallel loop in the project(linalg kernels, coefficient assembly, poisson batches, sweeps).
+// The pool is started on the first parallel loop and kept alive, so a loop costs a wake up instead of a pthread_create per range.
+// The iteration space is cut into blocks that are dealt out to the threads in contiguous runs,
+// a thread that runs out of blocks steals the back half of another thread's run.
+//
+// Loops started from inside a pool thread, or while another thread already runs a loop, are run inline on the calling thread.
+//
+// Usage:
+//  static void body(size_t begin, size_t end, void* ctx) { for(size_t i = begin; i < end; i++) ... }
+//  parallelFor(n, 64, body, &ctx);
+
+#include <stddef.h>
+
+// body of a parallel loop, called with a half open range [begin, end) of the iteration space
+typedef void (*ParallelRangeFn)(size_t begin, size_t end, void* ctx);
+
+// body of a parallel reduction: accumulate the iterations [begin, end) into partial,
+// partial starts as a copy of the identity
+typedef void (*ParallelReduceFn)(size_t begin, size_t end, void* partial, void* ctx);
+// fold a partial result into acc(acc = acc op partial)
+typedef void (*ParallelCombineFn)(void* acc, const void* partial, void* ctx);
+
+// reduction orders for parallelReduce
+// fast: one partial per thread, the blocks each thread ends up with depend on scheduling
+#define PARALLEL_REDUCE_FAST 0
+// deterministic: the blocks depend only on n and grain, partials are combined in block order.
+// the result is bitwise identical for any thread count
+#define PARALLEL_REDUCE_DETERMINISTIC 1
+
+// get the number of threads(the caller included) used by parallel loops, defaults to the number of online cpus
+int threadPoolThreads();
+// set the number of threads used by parallel loops(0 = number of cpus), returns the count actually selected.
+// do not call while a parallel loop is running
+int threadPoolSetThreads(int threads);
+// stop and join the pool threads, the next parallel loop starts them again(called at exit)
+void threadPoolShutdown();
+
+// split [0, n) into blocks of at least grain iterations and run fn over them on the pool,
+// the calling thread takes part. returns after all blocks are done. runs fn(0, n, ctx) inline when there is only one block
+void parallelFor(size_t n, size_t grain, ParallelRangeFn fn, void* ctx);
+
+// reduce [0, n) with fn over blocks of at least grain iterations, then combine the partials into result.
+// partials are size bytes and start as a copy of identity, result is overwritten(identity when n is 0).
+// mode is PARALLEL_REDUCE_FAST or PARALLEL_REDUCE_DETERMINISTIC
+void parallelReduce(size_t n, size_t grain, ParallelReduceFn fn, ParallelCombineFn combine,
+                    const void* identity, size_t size, void* result, int mode, void* ctx);
@@ -6,6 +6,8 @@
 #include<string.h>
 #include<include/linalg.h>
 #include<stdint.h>
+#include<include/coefficients.h>
+#include<include/threadpool.h>
 
 
 long double d_nm(size_t n , size_t m , InputData input_data) 
@@ -16,7 +18,7 @@ long double d_nm(size_t n , size_t m , InputData input_data)
 Mat2d matrix_d_nm(InputData input_data)
 {
     size_t len = input_data.params.num_traps;
-    Mat2d Mat_d_nm = mat2DInitZerosA(len,len); 
+    Mat2d Mat_d_nm = mat2DInitUninitA(len,len); 
 
     for(size_t i=0;i<len;i++)
     {
@@ -30,13 +32,19 @@ Mat2d matrix_d_nm(InputData input_data)
 }
 
 
-Mat2d matrix_E_n(InputData input_data, Vec mesh)
+Mat2d matrix_E_n(InputData input_data, Mesh mesh)
 {
-    size_t len = input_data.params.num_traps;
-
-    Mat2d Mat_E_n = mat2DInitZerosA(len,len);
-    
     Vec E = getGridNumE(input_data, mesh);
+    Mat2d Mat_E_n = matrix_E_n_from_E(E);
+    freeVec(&E);
+    return Mat_E_n ;
+}
+
+Mat2d matrix_E_n_from_E(Vec E)
+{
+    size_t len = E.len;
+
+    Mat2d Mat_E_n = mat2DInitUninitA(len,len);
     
     for(size_t i = 0; i < len    ; i++){
         // if (isnan(E.x[i])) printf("Found Bad E. i = %zu\n", i);
@@ -64,6 +72,36 @@ long double r_nm(InputData input_data , Mat2d mat_E , Mat2d mat_d , size_t n , s
     return nu * exp((-d_nm/gamma) + (E_nm/kb_T));
 }
 
+typedef struct RnmRowsCtx
+{
+    Mat2d mat_E;
+    Mat2d mat_d;
+    Mat2d mat_r;
+    linalg_work_t nu;
+    linalg_work_t inv_gamma;
+    linalg_work_t inv_kb_T;
+} RnmRowsCtx;
+
+// rows [begin, end) of matrix_r_nm
+static void r_nm_rows(size_t begin, size_t end, void* ctx)
+{
+    const RnmRowsCtx* c = ctx;
+    size_t len = c->mat_r.cols;
+
+    for(size_t i = begin; i < end; i++){
+        const long double* E_row = mat2DRow(c->mat_E, i).x;
+        const long double* d_row = mat2DRow(c->mat_d, i).x;
+        long double* r_row = mat2DRow(c->mat_r, i).x;
+
+        for(size_t j = 0; j < len; j++){
+            linalg_work_t E_nm = E_row[j];
+            linalg_work_t expo = -(linalg_work_t)d_row[j] * c->inv_gamma;
+            if(!(E_nm > 0.0)) expo += E_nm * c->inv_kb_T;
+            r_row[j] = c->nu * exp(expo);
+        }
+    }
+}
+
 Mat2d matrix_r_nm(InputData input_data , Mat2d mat_E , Mat2d mat_d)
 {
     /*Generate the d_nm matrix and Enm matrix after accepting the inputs and
@@ -71,23 +109,62 @@ Mat2d matrix_r_nm(InputData input_data , Mat2d mat_E , Mat2d mat_d)
 
     size_t len = input_data.params.num_traps ;
 
-    Mat2d mat_r = mat2DInitZerosA(len, len);
-
-    for(size_t i = 0; i < len; i++){
-        for(size_t j = 0; j < len; j++){
-            *mat2DRef(mat_r, i, j) = r_nm(input_data, mat_E , mat_d , i,j);
-        }
-    }
+    Mat2d mat_r = mat2DInitUninitA(len, len);
+
+    // same as r_nm, but walks whole rows in working precision(see PRECISION in the makefile)
+    // so the exp loop can be vectorized when built in double. rows are spread over the thread pool
+    RnmRowsCtx ctx = {
+        mat_E, mat_d, mat_r,
+        input_data.params.nu_0,
+        1 / (linalg_work_t)input_data.params.gamma_0,
+        1 / (linalg_work_t)(1.38 * 1e-23 * input_data.params.temp),
+    };
+    size_t grain = len > 0 && len < R_NM_PARALLEL_ENTRIES ? R_NM_PARALLEL_ENTRIES / len : 1;
+    parallelFor(len, grain, r_nm_rows, &ctx);
     return mat_r ;
 }
 
+typedef struct RnmEntryCtx
+{
+    Vec locs;
+    Vec E;
+    linalg_work_t nu;
+    linalg_work_t inv_gamma;
+    linalg_work_t inv_kb_T;
+} RnmEntryCtx;
+
+// r_nm from the trap locations and energies, 0 on the diagonal
+static long double r_nm_entry(size_t n, size_t m, void* ctx)
+{
+    const RnmEntryCtx* c = ctx;
+    if(n == m) return 0.0L;
+
+    linalg_work_t E_nm = c->E.x[n] - c->E.x[m];
+    linalg_work_t expo = -(linalg_work_t)fabsl(c->locs.x[n] - c->locs.x[m]) * c->inv_gamma;
+    if(!(E_nm > 0.0)) expo += E_nm * c->inv_kb_T;
+    return c->nu * exp(expo);
+}
+
+MatCSR matrix_r_nm_csr(InputData input_data, Vec E, long double cutoff)
+{
+    if(!(cutoff > 0)) cutoff = R_NM_CUTOFF_DECAYS * input_data.params.gamma_0;
+
+    RnmEntryCtx ctx = {
+        input_data.locs, E,
+        input_data.params.nu_0,
+        1 / (linalg_work_t)input_data.params.gamma_0,
+        1 / (linalg_work_t)(1.38 * 1e-23 * input_data.params.temp),
+    };
+    return matCSRFromDistanceA(input_data.locs, cutoff, r_nm_entry, &ctx);
+}
+
 long double transmission_param(long double T_b , InputData input_data , long double V_electrode)
 {
     long double h_bar = 1.054571817 * 1e-34 ;
 
     long double E_A = input_data.params.electron_affinity ;
 
-    Vec mesh = generateMesh( input_data.locs ,input_data.params);
+    Mesh mesh = generateMesh( input_data.locs ,input_data.params);
     Vec V_x = poissonWrapper(input_data, mesh) ;
     
     size_t i = 0;
@@ -97,9 +174,9 @@ long double transmission_param(long double T_b , InputData input_data , long dou
     size_t band = input_data.params.chunk_size ;
     long double delta = (d_now.x[1] - d_now.x[0])/band ;
 
-    while(mesh.x[i] <= T_b){
+    while(mesh.x.x[i] <= T_b){
         long double E = -Q*V_x.x[i] + E_A ;
-        if(mesh.x[i] > d_now.x[ j + 1 ] && j< (input_data.params.num_traps - 1)){
+        if(mesh.x.x[i] > d_now.x[ j + 1 ] && j< (input_data.params.num_traps - 1)){
             j++ ;
             delta = (d_now.x[ j + 1 ] - d_now.x[j])/band ;
         }     
@@ -107,22 +184,26 @@ long double transmission_param(long double T_b , InputData input_data , long dou
         T_exp += sqrt(Me*(E + Q * V_electrode)) * delta ;
         i++ ;
     }
+    freeVec(&V_x);
+    freeMesh(&mesh);
     return exp((-2 * T_exp) / h_bar) ;
 }
 
-Mat2d R_en(InputData input_data, Vec mesh)
+Mat2d R_en(InputData input_data, Mesh mesh)
+{
+    Vec E = getGridNumE(input_data, mesh);
+    Mat2d mat_R = R_en_from_E(input_data, E);
+    freeVec(&E);
+    return mat_R ;
+}
+
+Mat2d R_en_from_E(InputData input_data, Vec E)
 {
     long double kb_T = 1.38*1e-23*input_data.params.temp ;
     size_t len = input_data.params.num_traps ;
     Mat2d mat_R = mat2DInitZerosA(len, 2) ;
-    Vec d = input_data.locs ;
     long double k = 1e13;
     long double phi_M = Q * 3L;
-    
-    Vec fn = input_data.probs ;
-    Vec d1 = input_data.locs ;
-    OxParams params_1 = input_data.params ;
-    Vec E = getGridNumE(input_data, mesh);
 
     //Top electrode
     long double V_0 = input_data.params.V_0;
@@ -0,0 +1,26 @@
+#pragma once
+
+// internal to src/linarg, heap storage of Vec/Mat2d(see LINALG_ALIGN/LINALG_MAT_PAD in include/linalg.h) and unchecked element access
+
+#include "include/linalg.h"
+
+#include <stdlib.h>
+
+// gets value at index from vector by reference(dereferenced)
+// allows for syntax like: LA_VIDX(a, 2) = 5;
+// DOES NOT CHECK FOR OUT OF BOUNDS ACCESS, kernels validate dimensions once at entry
+#define LA_VIDX(vector, index) *(vector.x + vector.offset * index)
+
+// LINALG_ALIGN aligned buffer of n long doubles, freed with free(). returns NULL on failure
+static inline long double* la_aligned_alloc(size_t n)
+{
+    // aligned_alloc wants a multiple of the alignment
+    size_t bytes = (n * sizeof(long double) + LINALG_ALIGN - 1) / LINALG_ALIGN * LINALG_ALIGN;
+    return aligned_alloc(LINALG_ALIGN, bytes);
+}
+
+// row stride of an allocated matrix with cols columns, whole LINALG_ALIGN lines per row
+static inline size_t la_padded_ld(size_t cols)
+{
+    return (cols + LINALG_MAT_PAD - 1) / LINALG_MAT_PAD * LINALG_MAT_PAD;
+}
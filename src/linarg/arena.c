@@ -0,0 +1,184 @@
+#include "include/linalg.h"
+#include "src/linarg/alloc.h"
+
+#include <stdlib.h>
+
+// alignment of every arena allocation(one cache line, also enough for AVX-512 loads)
+#define LA_ARENA_ALIGN 64
+// smallest block the arena allocates
+#define LA_ARENA_MIN_BLOCK 4096
+
+#define LA_ALIGN_UP(x, a) (((x) + (a) - 1) / (a) * (a))
+
+struct LinalgArenaBlock
+{
+    LinalgArenaBlock* prev;
+    size_t size;    // usable bytes in data
+    size_t top;     // first free byte in data
+    unsigned char* data;
+};
+
+static LinalgArenaBlock* la_arena_block_create(size_t size, LinalgArenaBlock* prev)
+{
+    size = LA_ALIGN_UP(size, LA_ARENA_ALIGN);
+    LinalgArenaBlock* block = malloc(sizeof(LinalgArenaBlock));
+    if(!block) return NULL;
+    block->data = aligned_alloc(LA_ARENA_ALIGN, size);
+    if(!block->data)
+    {
+        free(block);
+        return NULL;
+    }
+    block->prev = prev;
+    block->size = size;
+    block->top = 0;
+    return block;
+}
+
+static void la_arena_block_free(LinalgArenaBlock* block)
+{
+    if(!block) return;
+    free(block->data);
+    free(block);
+}
+
+// create an arena with an initial capacity in bytes(allocates memory)
+LinalgArena linalgArenaInitA(size_t capacity)
+{
+    LinalgArena arena = {NULL, NULL, 0};
+    if(capacity < LA_ARENA_MIN_BLOCK) capacity = LA_ARENA_MIN_BLOCK;
+    arena.block = la_arena_block_create(capacity, NULL);
+    LINALG_ASSERT_ERROR(!arena.block, arena, "unknown error occured when allocation memory!");
+    arena.block_size = arena.block->size;
+    return arena;
+}
+
+// open a scope, everything allocated after this is released by linalgArenaPop(mark)
+LinalgArenaMark linalgArenaPush(LinalgArena* arena)
+{
+    LinalgArenaMark mark = {NULL, 0};
+    LINALG_CHECK_ERROR(!arena, mark, "arena is null!");
+    mark.block = arena->block;
+    mark.top = arena->block ? arena->block->top : 0;
+    return mark;
+}
+
+// release everything allocated since mark in O(1)(frees chained blocks, if any)
+void linalgArenaPop(LinalgArena* arena, LinalgArenaMark mark)
+{
+    LINALG_CHECK_ERROR(!arena, , "arena is null!");
+    while(arena->block && arena->block != mark.block)
+    {
+        LinalgArenaBlock* block = arena->block;
+        arena->block = block->prev;
+        // keep the biggest block around, so a loop that overflows every iteration stops calling malloc
+        if(!arena->spare || arena->spare->size < block->size)
+        {
+            la_arena_block_free(arena->spare);
+            block->prev = NULL;
+            arena->spare = block;
+        }
+        else la_arena_block_free(block);
+    }
+    LINALG_CHECK_ERROR(arena->block != mark.block, , "mark does not belong to this arena!");
+    if(arena->block) arena->block->top = mark.top;
+}
+
+// allocate 64-byte aligned memory from the arena, returns NULL on failure
+void* linalgArenaAlloc(LinalgArena* arena, size_t bytes)
+{
+    LINALG_CHECK_ERROR(!arena, NULL, "arena is null!");
+    bytes = LA_ALIGN_UP(bytes, LA_ARENA_ALIGN);
+
+    LinalgArenaBlock* block = arena->block;
+    if(!block || block->size - block->top < bytes)
+    {
+        if(arena->spare && arena->spare->size >= bytes)
+        {
+            block = arena->spare;
+            arena->spare = NULL;
+            block->top = 0;
+            block->prev = arena->block;
+        }
+        else
+        {
+            // grow geometrically, so a scope needs O(log n) blocks
+            size_t size = arena->block_size * 2;
+            if(size < bytes) size = bytes;
+            block = la_arena_block_create(size, arena->block);
+            LINALG_ASSERT_ERROR(!block, NULL, "unknown error occured when allocation memory!");
+            arena->block_size = block->size;
+        }
+        arena->block = block;
+    }
+
+    void* ptr = block->data + block->top;
+    block->top += bytes;
+    return ptr;
+}
+
+// free the arena and everything allocated from it
+void freeLinalgArena(LinalgArena* arena)
+{
+    if(!arena) return;
+    while(arena->block)
+    {
+        LinalgArenaBlock* prev = arena->block->prev;
+        la_arena_block_free(arena->block);
+        arena->block = prev;
+    }
+    la_arena_block_free(arena->spare);
+    arena->spare = NULL;
+    arena->block_size = 0;
+}
+
+// initialzie the vector in the arena with some initial value
+Vec vecInitArena(LinalgArena* arena, long double value, size_t len)
+{
+    Vec x = {NULL, 0, 0};
+    LINALG_ASSERT_ERROR(len == 0, x, "invalid zero length vector requested!");
+    x.x = linalgArenaAlloc(arena, sizeof(long double) * len);
+    LINALG_ASSERT_ERROR(!x.x, x, "unknown error occured when allocation memory!");
+    x.len = len;
+    x.offset = 1;
+    for(size_t i = 0; i < len; i++) x.x[i] = value;
+    return x;
+}
+
+// initialize the vector in the arena to zeros
+Vec vecInitZerosArena(LinalgArena* arena, size_t len)
+{
+    return vecInitArena(arena, 0, len);
+}
+
+// make a copy of a vector in the arena(the copy is contiguous)
+Vec vecCopyArena(LinalgArena* arena, Vec vector)
+{
+    Vec x = {NULL, 0, 0};
+    LINALG_ASSERT_ERROR(!vector.x, x, "invalid source pointer(null)!");
+    x = vecInitArena(arena, 0, vector.len);
+    if(!x.x) return x;
+    for(size_t i = 0; i < vector.len; i++) x.x[i] = vector.x[i * vector.offset];
+    return x;
+}
+
+// initialzie the matrix in the arena with some initial value
+Mat2d mat2DInitArena(LinalgArena* arena, long double value, size_t rows, size_t cols)
+{
+    Mat2d mat = {NULL, 0, 0, 0};
+    LINALG_ASSERT_ERROR(rows == 0 || cols == 0, mat, "invalid zero row or col matrix requested!");
+    size_t ld = la_padded_ld(cols);
+    mat.mat = linalgArenaAlloc(arena, sizeof(long double) * rows * ld);
+    LINALG_ASSERT_ERROR(!mat.mat, mat, "unknown error occured when allocation memory!");
+    mat.rows = rows;
+    mat.cols = cols;
+    mat.ld = ld;
+    for(size_t i = 0; i < rows * ld; i++) mat.mat[i] = value;
+    return mat;
+}
+
+// initialize the matrix in the arena to zeros
+Mat2d mat2DInitZerosArena(LinalgArena* arena, size_t rows, size_t cols)
+{
+    return mat2DInitArena(arena, 0, rows, cols);
+}
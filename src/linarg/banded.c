@@ -0,0 +1,278 @@
+#include "include/linalg.h"
+#include "src/linarg/alloc.h"
+#include "src/linarg/gemm.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+// width of a stored band row
+#define LA_BAND_W(A) ((A).kl + (A).ku + 1)
+// entry(i, j) of a banded matrix, NO band check
+#define LA_BAND(A, i, j) (A).band[(i) * LA_BAND_W(A) + (A).kl + (j) - (i)]
+
+/*=========================*/
+// banded
+/*=========================*/
+
+// initialize a banded matrix on the heap to zeros
+MatBand matBandInitA(size_t n, size_t kl, size_t ku)
+{
+    MatBand A = {NULL, 0, 0, 0};
+    LINALG_ASSERT_ERROR(n == 0, A, "invalid zero size matrix requested!");
+    LINALG_ASSERT_ERROR(kl >= n || ku >= n, A, "bandwidth(%zu, %zu) does not fit a mat(%zux%zu)!", kl, ku, n, n);
+    A.band = calloc(n * (kl + ku + 1), sizeof(long double));
+    LINALG_ASSERT_ERROR(!A.band, A, "unknown error occured when allocation memory!");
+    A.n = n;
+    A.kl = kl;
+    A.ku = ku;
+    return A;
+}
+
+// gets the value at row and col(0 outside the band)
+long double matBandGet(MatBand A, size_t row, size_t col)
+{
+    LINALG_CHECK_ERROR(row >= A.n || col >= A.n, NAN, "out of bounds matrix access!");
+    if(col + A.kl < row || col > row + A.ku) return 0;
+    return LA_BAND(A, row, col);
+}
+
+// gets the value at row and col(by ref), returns nullptr outside the band or the matrix
+long double* matBandRef(MatBand A, size_t row, size_t col)
+{
+    LINALG_CHECK_ERROR(row >= A.n || col >= A.n, NULL, "out of bounds matrix access!");
+    LINALG_CHECK_ERROR(col + A.kl < row || col > row + A.ku, NULL, "access outside the band!");
+    return &LA_BAND(A, row, col);
+}
+
+// compute result = Ax. prints error if the input is invalid
+int matBandTransform(MatBand A, Vec x, Vec* result)
+{
+    LINALG_CHECK_ERROR(!result || !result->x, LINALG_ERROR, "result vector is null!");
+    LINALG_CHECK_ERROR(!A.band || !x.x, LINALG_ERROR, "input is null!");
+    LINALG_CHECK_ERROR(x.len != A.n || result->len != A.n, LINALG_ERROR, "band(%zux%zu) applied over vec(%zu) into vec(%zu)", A.n, A.n, x.len, result->len);
+    LINALG_CHECK_ERROR(result->x == x.x, LINALG_ERROR, "result vector can not be the input vector!");
+    LINALG_SCAN_WARN(vecContainsNan(x), "input vector contains INF or NAN!");
+
+    for(size_t i = 0; i < A.n; i++)
+    {
+        size_t j0 = i > A.kl ? i - A.kl : 0;
+        size_t j1 = i + A.ku < A.n ? i + A.ku : A.n - 1;
+        long double val = 0;
+        for(size_t j = j0; j <= j1; j++) val += LA_BAND(A, i, j) * LA_VIDX(x, j);
+        LA_VIDX((*result), i) = val;
+    }
+    return LINALG_OK;
+}
+
+// LU in place WITHOUT pivoting, so there is no fill outside the band(L in the kl lower diagonals, U in the rest)
+int matBandLUFactor(MatBand* A)
+{
+    LINALG_CHECK_ERROR(!A || !A->band, LINALG_ERROR, "input matrix is null!");
+
+    for(size_t k = 0; k < A->n; k++)
+    {
+        long double pivot = LA_BAND(*A, k, k);
+        LINALG_ASSERT_ERROR(pivot == 0, LINALG_ERROR, "zero pivot in row %zu(banded LU does not pivot)!", k);
+        size_t i1 = k + A->kl < A->n ? k + A->kl : A->n - 1;
+        size_t j1 = k + A->ku < A->n ? k + A->ku : A->n - 1;
+        for(size_t i = k + 1; i <= i1; i++)
+        {
+            long double l = LA_BAND(*A, i, k) / pivot;
+            LA_BAND(*A, i, k) = l;
+            if(l == 0) continue;
+            // row i reaches column i + ku >= k + ku, so the update stays inside the band
+            for(size_t j = k + 1; j <= j1; j++) LA_BAND(*A, i, j) -= l * LA_BAND(*A, k, j);
+        }
+    }
+    return LINALG_OK;
+}
+
+// solve Ax = b with the factors from matBandLUFactor, x may be b. prints error if the input is invalid
+int matBandLUSolve(MatBand LU, Vec b, Vec* x)
+{
+    LINALG_CHECK_ERROR(!x || !x->x, LINALG_ERROR, "result vector is null!");
+    LINALG_CHECK_ERROR(!LU.band || !b.x, LINALG_ERROR, "input is null!");
+    LINALG_CHECK_ERROR(b.len != LU.n || x->len != LU.n, LINALG_ERROR, "band(%zux%zu) solved with vec(%zu) into vec(%zu)", LU.n, LU.n, b.len, x->len);
+    LINALG_SCAN_WARN(vecContainsNan(b), "input vector contains INF or NAN!");
+
+    // every step only reads values it already wrote, so x can be b
+    for(size_t i = 0; i < LU.n; i++)
+    {
+        size_t j0 = i > LU.kl ? i - LU.kl : 0;
+        long double val = LA_VIDX(b, i);
+        for(size_t j = j0; j < i; j++) val -= LA_BAND(LU, i, j) * LA_VIDX((*x), j);
+        LA_VIDX((*x), i) = val;
+    }
+    for(size_t i = LU.n; i-- > 0;)
+    {
+        size_t j1 = i + LU.ku < LU.n ? i + LU.ku : LU.n - 1;
+        long double val = LA_VIDX((*x), i);
+        for(size_t j = i + 1; j <= j1; j++) val -= LA_BAND(LU, i, j) * LA_VIDX((*x), j);
+        LA_VIDX((*x), i) = val / LA_BAND(LU, i, i);
+    }
+    return LINALG_OK;
+}
+
+// free the banded matrix on the heap
+void freeMatBand(MatBand* A)
+{
+    if(!A) return;
+    free(A->band);
+    *A = (MatBand){NULL, 0, 0, 0};
+}
+
+/*=========================*/
+// block tridiagonal
+/*=========================*/
+
+// blocks are stored sub, main, sup for every block row
+#define LA_BTD_BLOCK(A, k, which) mat2DConstruct((A).data + ((k) * 3 + (which)) * (A).bs * (A).bs, (A).bs, (A).bs)
+
+// initialize a block tridiagonal matrix on the heap to zeros
+MatBlockTD matBlockTDInitA(size_t blocks, size_t bs)
+{
+    MatBlockTD A = {NULL, 0, 0};
+    LINALG_ASSERT_ERROR(blocks == 0 || bs == 0, A, "invalid zero size matrix requested!");
+    A.data = calloc(3 * blocks * bs * bs, sizeof(long double));
+    LINALG_ASSERT_ERROR(!A.data, A, "unknown error occured when allocation memory!");
+    A.blocks = blocks;
+    A.bs = bs;
+    return A;
+}
+
+// block(k, k-1) as a matrix(by ref), k >= 1
+Mat2d matBlockTDSub(MatBlockTD A, size_t k)
+{
+    Mat2d bad = {NULL, 0, 0, 0};
+    LINALG_CHECK_ERROR(k == 0 || k >= A.blocks, bad, "no sub diagonal block in block row %zu!", k);
+    return LA_BTD_BLOCK(A, k, 0);
+}
+
+// block(k, k) as a matrix(by ref)
+Mat2d matBlockTDMain(MatBlockTD A, size_t k)
+{
+    Mat2d bad = {NULL, 0, 0, 0};
+    LINALG_CHECK_ERROR(k >= A.blocks, bad, "no block row %zu!", k);
+    return LA_BTD_BLOCK(A, k, 1);
+}
+
+// block(k, k+1) as a matrix(by ref), k < blocks - 1
+Mat2d matBlockTDSup(MatBlockTD A, size_t k)
+{
+    Mat2d bad = {NULL, 0, 0, 0};
+    LINALG_CHECK_ERROR(k + 1 >= A.blocks, bad, "no super diagonal block in block row %zu!", k);
+    return LA_BTD_BLOCK(A, k, 2);
+}
+
+// compute result = Ax. prints error if the input is invalid, result can not be x
+int matBlockTDTransform(MatBlockTD A, Vec x, Vec* result)
+{
+    size_t n = A.blocks * A.bs;
+    LINALG_CHECK_ERROR(!result || !result->x, LINALG_ERROR, "result vector is null!");
+    LINALG_CHECK_ERROR(!A.data || !x.x, LINALG_ERROR, "input is null!");
+    LINALG_CHECK_ERROR(x.len != n || result->len != n, LINALG_ERROR, "block tridiagonal(%zux%zu) applied over vec(%zu) into vec(%zu)", n, n, x.len, result->len);
+    LINALG_CHECK_ERROR(result->x == x.x, LINALG_ERROR, "result vector can not be the input vector!");
+    LINALG_SCAN_WARN(vecContainsNan(x), "input vector contains INF or NAN!");
+
+    for(size_t k = 0; k < A.blocks; k++)
+    {
+        for(size_t r = 0; r < A.bs; r++)
+        {
+            long double val = 0;
+            for(size_t which = 0; which < 3; which++)
+            {
+                // block column k - 1 + which
+                if((which == 0 && k == 0) || (which == 2 && k + 1 == A.blocks)) continue;
+                const long double* row = LA_BTD_BLOCK(A, k, which).mat + r * A.bs;
+                size_t c0 = (k + which - 1) * A.bs;
+                for(size_t c = 0; c < A.bs; c++) val += row[c] * LA_VIDX(x, c0 + c);
+            }
+            LA_VIDX((*result), k * A.bs + r) = val;
+        }
+    }
+    return LINALG_OK;
+}
+
+// solve Ax = b with block Thomas elimination(pivoted LU of every reduced diagonal block), A is not modified
+int matBlockTDSolve(MatBlockTD A, Vec b, Vec* x)
+{
+    size_t n = A.blocks * A.bs, bs = A.bs;
+    LINALG_CHECK_ERROR(!x || !x->x, LINALG_ERROR, "result vector is null!");
+    LINALG_CHECK_ERROR(!A.data || !b.x, LINALG_ERROR, "input is null!");
+    LINALG_CHECK_ERROR(b.len != n || x->len != n, LINALG_ERROR, "block tridiagonal(%zux%zu) solved with vec(%zu) into vec(%zu)", n, n, b.len, x->len);
+    LINALG_SCAN_WARN(vecContainsNan(b), "input vector contains INF or NAN!");
+
+    // G_k = D'_k^-1 C_k and y_k = D'_k^-1 (b_k - A_k y_k-1), with D'_k = D_k - A_k G_k-1
+    MatLU lu = matLUInitA(bs);
+    // a single block has no G, malloc(0) may return NULL so keep one spare value
+    long double* G = malloc(sizeof(long double) * ((A.blocks - 1) * bs * bs + 1));
+    long double* y = malloc(sizeof(long double) * n);
+    if(!lu.perm || !G || !y)
+    {
+        freeMatLU(&lu), free(G), free(y);
+        LINALG_REPORT_ERROR("unknown error occured when allocation memory!");
+        return LINALG_ERROR;
+    }
+
+    int status = LINALG_OK;
+    for(size_t k = 0; k < A.blocks && status == LINALG_OK; k++)
+    {
+        Mat2d D = LA_BTD_BLOCK(A, k, 1);
+        long double* yk = y + k * bs;
+        for(size_t i = 0; i < bs; i++)
+            for(size_t j = 0; j < bs; j++) lu.lu.mat[i * lu.lu.ld + j] = D.mat[i * bs + j];
+        for(size_t i = 0; i < bs; i++) yk[i] = LA_VIDX(b, k * bs + i);
+        if(k > 0)
+        {
+            Mat2d L = LA_BTD_BLOCK(A, k, 0);
+            const long double* yprev = y + (k - 1) * bs;
+            linalgGemm(bs, bs, bs, -1, L.mat, bs, G + (k - 1) * bs * bs, bs, 1, lu.lu.mat, lu.lu.ld);
+            for(size_t i = 0; i < bs; i++)
+                for(size_t j = 0; j < bs; j++) yk[i] -= L.mat[i * bs + j] * yprev[j];
+        }
+        if(matLUFactor(lu.lu, &lu) != LINALG_OK)
+        {
+            LINALG_REPORT_ERROR("reduced diagonal block %zu is singular!", k);
+            status = LINALG_ERROR;
+            break;
+        }
+        Vec yv = vecConstruct(yk, bs);
+        matLUSolve(lu, yv, &yv);
+        if(k + 1 < A.blocks)
+        {
+            Mat2d Gk = mat2DConstruct(G + k * bs * bs, bs, bs);
+            Mat2d C = LA_BTD_BLOCK(A, k, 2);
+            matLUSolveMulti(lu, C, &Gk);
+        }
+    }
+
+    if(status == LINALG_OK)
+    {
+        // x_k = y_k - G_k x_k+1, from the last block up
+        for(size_t k = A.blocks; k-- > 0;)
+        {
+            long double* yk = y + k * bs;
+            if(k + 1 < A.blocks)
+            {
+                const long double* Gk = G + k * bs * bs;
+                const long double* xnext = y + (k + 1) * bs;
+                for(size_t i = 0; i < bs; i++)
+                    for(size_t j = 0; j < bs; j++) yk[i] -= Gk[i * bs + j] * xnext[j];
+            }
+        }
+        for(size_t i = 0; i < n; i++) LA_VIDX((*x), i) = y[i];
+    }
+
+    freeMatLU(&lu);
+    free(G);
+    free(y);
+    return status;
+}
+
+// free the block tridiagonal matrix on the heap
+void freeMatBlockTD(MatBlockTD* A)
+{
+    if(!A) return;
+    free(A->data);
+    *A = (MatBlockTD){NULL, 0, 0};
+}
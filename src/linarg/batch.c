@@ -0,0 +1,256 @@
+#include "include/linalg.h"
+#include "src/linarg/simd.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// systems of a batch per LINALG_ALIGN line
+#define LA_BATCH_PAD (LINALG_ALIGN / sizeof(double))
+
+// stride of a batch, whole LINALG_ALIGN lines
+static size_t la_batch_stride(size_t batch)
+{
+    return (batch + LA_BATCH_PAD - 1) / LA_BATCH_PAD * LA_BATCH_PAD;
+}
+
+// zeroed, LINALG_ALIGN aligned buffer of count doubles. returns NULL on failure
+static double* la_batch_alloc(size_t count)
+{
+    size_t bytes = (count * sizeof(double) + LINALG_ALIGN - 1) / LINALG_ALIGN * LINALG_ALIGN;
+    double* p = aligned_alloc(LINALG_ALIGN, bytes);
+    if(p) memset(p, 0, bytes);
+    return p;
+}
+
+// 1 if any value of the rows x batch block(rows of stride) is INF or NAN
+static int la_batch_contains_nan(const double* p, size_t rows, size_t batch, size_t stride)
+{
+    for(size_t i = 0; i < rows; i++)
+        for(size_t s = 0; s < batch; s++)
+            if(!isfinite(p[i * stride + s])) return 1;
+    return 0;
+}
+
+// initialize batch n x n matrices on the heap to zeros
+MatBatchD matBatchDInitA(size_t n, size_t batch)
+{
+    MatBatchD A = {NULL, 0, 0, 0};
+    LINALG_ASSERT_ERROR(n == 0 || batch == 0, A, "invalid empty batch requested(n = %zu, batch = %zu)!", n, batch);
+
+    size_t stride = la_batch_stride(batch);
+    A.mat = la_batch_alloc(n * n * stride);
+    LINALG_ASSERT_ERROR(!A.mat, A, "unknown error occured when allocation memory!");
+    A.n = n;
+    A.batch = batch;
+    A.stride = stride;
+    return A;
+}
+
+// initialize batch vectors of length n on the heap to zeros
+VecBatchD vecBatchDInitA(size_t n, size_t batch)
+{
+    VecBatchD x = {NULL, 0, 0, 0};
+    LINALG_ASSERT_ERROR(n == 0 || batch == 0, x, "invalid empty batch requested(n = %zu, batch = %zu)!", n, batch);
+
+    size_t stride = la_batch_stride(batch);
+    x.x = la_batch_alloc(n * stride);
+    LINALG_ASSERT_ERROR(!x.x, x, "unknown error occured when allocation memory!");
+    x.n = n;
+    x.batch = batch;
+    x.stride = stride;
+    return x;
+}
+
+// copy system s out of a batch
+int matBatchDGetSystem(MatBatchD A, size_t s, Mat2d* result)
+{
+    LINALG_CHECK_ERROR(!result || !result->mat, LINALG_ERROR, "result matrix is null!");
+    LINALG_CHECK_ERROR(!A.mat, LINALG_ERROR, "input batch is null!");
+    LINALG_CHECK_ERROR(s >= A.batch, LINALG_ERROR, "system %zu of a batch of %zu!", s, A.batch);
+    LINALG_CHECK_ERROR(result->rows != A.n || result->cols != A.n, LINALG_ERROR, "batch of %zux%zu stored in mat(%zux%zu)", A.n, A.n, result->rows, result->cols);
+
+    for(size_t i = 0; i < A.n; i++)
+        for(size_t j = 0; j < A.n; j++) result->mat[i * result->ld + j] = *matBatchDRef(A, s, i, j);
+    return LINALG_OK;
+}
+
+// copy M into system s of a batch
+int matBatchDSetSystem(MatBatchD* A, size_t s, Mat2d M)
+{
+    LINALG_CHECK_ERROR(!A || !A->mat, LINALG_ERROR, "result batch is null!");
+    LINALG_CHECK_ERROR(!M.mat, LINALG_ERROR, "input matrix is null!");
+    LINALG_CHECK_ERROR(s >= A->batch, LINALG_ERROR, "system %zu of a batch of %zu!", s, A->batch);
+    LINALG_CHECK_ERROR(M.rows != A->n || M.cols != A->n, LINALG_ERROR, "mat(%zux%zu) stored in a batch of %zux%zu", M.rows, M.cols, A->n, A->n);
+    LINALG_SCAN_WARN(mat2DContainsNan(M), "input matrix contains INF or NAN!");
+
+    for(size_t i = 0; i < M.rows; i++)
+        for(size_t j = 0; j < M.cols; j++) *matBatchDRef(*A, s, i, j) = M.mat[i * M.ld + j];
+    return LINALG_OK;
+}
+
+// compute y = Ax for every system, one fma kernel across the batch per matrix entry
+int matBatchDTransform(MatBatchD A, VecBatchD x, VecBatchD* y)
+{
+    LINALG_CHECK_ERROR(!y || !y->x, LINALG_ERROR, "result batch is null!");
+    LINALG_CHECK_ERROR(!A.mat || !x.x, LINALG_ERROR, "input batch is null!");
+    LINALG_CHECK_ERROR(x.n != A.n || y->n != A.n || x.batch != A.batch || y->batch != A.batch, LINALG_ERROR,
+        "batch of %zu %zux%zu applied over %zu vec(%zu) into %zu vec(%zu)", A.batch, A.n, A.n, x.batch, x.n, y->batch, y->n);
+    LINALG_CHECK_ERROR(y->x == x.x, LINALG_ERROR, "result batch can't be the input!");
+    LINALG_SCAN_WARN(la_batch_contains_nan(A.mat, A.n * A.n, A.batch, A.stride), "input batch contains INF or NAN!");
+    LINALG_SCAN_WARN(la_batch_contains_nan(x.x, x.n, x.batch, x.stride), "input vectors contain INF or NAN!");
+
+    const LinalgSimdKernelsD* kernels = linalgSimdKernelsD();
+    size_t n = A.n, batch = A.batch;
+    for(size_t i = 0; i < n; i++)
+    {
+        double* yi = y->x + i * y->stride;
+        memset(yi, 0, sizeof(double) * batch);
+        for(size_t j = 0; j < n; j++) kernels->mulAdd(A.mat + (i * n + j) * A.stride, x.x + j * x.stride, yi, batch);
+    }
+    return LINALG_OK;
+}
+
+// allocate an (unfactored) LU object for batch n x n systems(allocates memory)
+MatBatchLUD matBatchLUDInitA(size_t n, size_t batch)
+{
+    MatBatchLUD lu = {{NULL, 0, 0, 0}, NULL, NULL};
+    lu.lu = matBatchDInitA(n, batch);
+    if(!lu.lu.mat) return lu;
+    lu.perm = malloc(sizeof(size_t) * n * lu.lu.stride);
+    lu.singular = malloc(sizeof(int) * batch);
+    if(!lu.perm || !lu.singular)
+    {
+        freeMatBatchLUD(&lu);
+        LINALG_REPORT_ERROR("unknown error occured when allocation memory!");
+        return lu;
+    }
+    // unfactored, solves fail
+    for(size_t s = 0; s < batch; s++) lu.singular[s] = 1;
+    return lu;
+}
+
+// factor every system of A(right looking, partial pivoting)
+// the pivot search and row swaps differ per system and run scalar, O(n^2) per system.
+// the O(n^3) elimination is the same for every system and runs the simd kernels across the batch
+int matBatchLUDFactor(MatBatchD A, MatBatchLUD* lu)
+{
+    LINALG_CHECK_ERROR(!lu || !lu->lu.mat || !lu->perm || !lu->singular, LINALG_ERROR, "LU object is null!");
+    LINALG_CHECK_ERROR(!A.mat, LINALG_ERROR, "input batch is null!");
+    LINALG_CHECK_ERROR(A.n != lu->lu.n || A.batch != lu->lu.batch, LINALG_ERROR,
+        "batch of %zu %zux%zu factored into a batch of %zu %zux%zu", A.batch, A.n, A.n, lu->lu.batch, lu->lu.n, lu->lu.n);
+    LINALG_SCAN_WARN(la_batch_contains_nan(A.mat, A.n * A.n, A.batch, A.stride), "input batch contains INF or NAN!");
+
+    const LinalgSimdKernelsD* kernels = linalgSimdKernelsD();
+    size_t n = A.n, batch = A.batch, stride = lu->lu.stride;
+    double* a = lu->lu.mat;
+    if(a != A.mat)
+        for(size_t e = 0; e < n * n; e++) memcpy(a + e * stride, A.mat + e * A.stride, sizeof(double) * batch);
+    for(size_t i = 0; i < n; i++)
+        for(size_t s = 0; s < batch; s++) lu->perm[i * stride + s] = i;
+    for(size_t s = 0; s < batch; s++) lu->singular[s] = 0;
+
+    for(size_t k = 0; k < n; k++)
+    {
+        for(size_t s = 0; s < batch; s++)
+        {
+            size_t p = k;
+            double max = fabs(a[(k * n + k) * stride + s]);
+            for(size_t i = k + 1; i < n; i++)
+            {
+                double v = fabs(a[(i * n + k) * stride + s]);
+                if(v > max) max = v, p = i;
+            }
+            // a zero pivot only poisons its own lane
+            if(max == 0) lu->singular[s] = 1;
+            if(p == k) continue;
+            for(size_t j = 0; j < n; j++)
+            {
+                double tmp = a[(k * n + j) * stride + s];
+                a[(k * n + j) * stride + s] = a[(p * n + j) * stride + s];
+                a[(p * n + j) * stride + s] = tmp;
+            }
+            size_t tmp = lu->perm[k * stride + s];
+            lu->perm[k * stride + s] = lu->perm[p * stride + s];
+            lu->perm[p * stride + s] = tmp;
+        }
+
+        const double* pivot = a + (k * n + k) * stride;
+        for(size_t i = k + 1; i < n; i++)
+        {
+            double* l = a + (i * n + k) * stride;
+            kernels->div(l, pivot, l, batch);
+            for(size_t j = k + 1; j < n; j++) kernels->mulSub(l, a + (k * n + j) * stride, a + (i * n + j) * stride, batch);
+        }
+    }
+
+    size_t singular = 0;
+    for(size_t s = 0; s < batch; s++) singular += lu->singular[s];
+    if(singular)
+    {
+        LINALG_REPORT_WARN("%zu of %zu systems are singular!", singular, batch);
+        return LINALG_ERROR;
+    }
+    return LINALG_OK;
+}
+
+// solve Ax = b for every system with a factored A, x may be b
+int matBatchLUDSolve(MatBatchLUD lu, VecBatchD b, VecBatchD* x)
+{
+    LINALG_CHECK_ERROR(!x || !x->x, LINALG_ERROR, "result batch is null!");
+    LINALG_CHECK_ERROR(!lu.lu.mat || !lu.perm || !lu.singular || !b.x, LINALG_ERROR, "input is null!");
+    LINALG_CHECK_ERROR(b.n != lu.lu.n || x->n != lu.lu.n || b.batch != lu.lu.batch || x->batch != lu.lu.batch, LINALG_ERROR,
+        "LU batch of %zu %zux%zu solved with %zu vec(%zu) into %zu vec(%zu)", lu.lu.batch, lu.lu.n, lu.lu.n, b.batch, b.n, x->batch, x->n);
+    LINALG_SCAN_WARN(la_batch_contains_nan(b.x, b.n, b.batch, b.stride), "input vectors contain INF or NAN!");
+
+    const LinalgSimdKernelsD* kernels = linalgSimdKernelsD();
+    size_t n = lu.lu.n, batch = lu.lu.batch, stride = lu.lu.stride;
+    const double* a = lu.lu.mat;
+    double* y = la_batch_alloc(n * stride);
+    LINALG_ASSERT_ERROR(!y, LINALG_ERROR, "unknown error occured when allocation memory!");
+
+    // y = Pb, then Ly = y(unit diagonal) and Ux = y
+    for(size_t i = 0; i < n; i++)
+        for(size_t s = 0; s < batch; s++) y[i * stride + s] = b.x[lu.perm[i * stride + s] * b.stride + s];
+    for(size_t i = 1; i < n; i++)
+        for(size_t j = 0; j < i; j++) kernels->mulSub(a + (i * n + j) * stride, y + j * stride, y + i * stride, batch);
+    for(size_t i = n; i-- > 0;)
+    {
+        for(size_t j = i + 1; j < n; j++) kernels->mulSub(a + (i * n + j) * stride, y + j * stride, y + i * stride, batch);
+        kernels->div(y + i * stride, a + (i * n + i) * stride, y + i * stride, batch);
+    }
+
+    for(size_t i = 0; i < n; i++)
+        for(size_t s = 0; s < batch; s++) x->x[i * x->stride + s] = lu.singular[s] ? NAN : y[i * stride + s];
+    free(y);
+    return LINALG_OK;
+}
+
+// free the batch of matrices on the heap
+void freeMatBatchD(MatBatchD* A)
+{
+    if(!A) return;
+    free(A->mat);
+    A->mat = NULL;
+    A->n = A->batch = A->stride = 0;
+}
+
+// free the batch of vectors on the heap
+void freeVecBatchD(VecBatchD* x)
+{
+    if(!x) return;
+    free(x->x);
+    x->x = NULL;
+    x->n = x->batch = x->stride = 0;
+}
+
+// free the batched LU object on the heap
+void freeMatBatchLUD(MatBatchLUD* lu)
+{
+    if(!lu) return;
+    freeMatBatchD(&lu->lu);
+    free(lu->perm);
+    free(lu->singular);
+    lu->perm = NULL;
+    lu->singular = NULL;
+}
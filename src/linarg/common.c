@@ -1,8 +1,28 @@
 #include "include/linalg.h"
 
+// breakpoint hook, the message itself is printed by linalgDiagFlush(see src/linarg/diag.c)
 void error_handler(const char* file, const char* function, size_t line_no)
 {
-    printf("in function %s, defined in file %s at line %zu:\n\t", function, file, line_no);
+    (void)file;
+    (void)function;
+    (void)line_no;
 }
 
 
+
+int la_validation_level = LINALG_VALIDATION;
+
+// get the runtime validation level
+int linalgValidationLevel()
+{
+    return la_validation_level;
+}
+
+// set the runtime validation level(clamped to off..full), returns the level actually selected
+int linalgValidationSetLevel(int level)
+{
+    if(level < LINALG_VALIDATE_OFF) level = LINALG_VALIDATE_OFF;
+    if(level > LINALG_VALIDATE_FULL) level = LINALG_VALIDATE_FULL;
+    la_validation_level = level;
+    return la_validation_level;
+}
@@ -0,0 +1,215 @@
+#include "include/linalg.h"
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+// messages a thread keeps between flushes, the oldest is overwritten when the ring is full
+#define LA_DIAG_RING 64
+// longest message kept, longer ones are truncated
+#define LA_DIAG_MSG 256
+
+typedef struct LaDiagEntry
+{
+    unsigned long long seq;     // global report order
+    LinalgDiagSite* site;
+    char msg[LA_DIAG_MSG];
+} LaDiagEntry;
+
+// one per thread that reported, handed to a new thread once its owner exited
+typedef struct LaDiagRing
+{
+    pthread_mutex_t lock;       // the owner writes, linalgDiagFlush reads
+    size_t written;             // entries written since the last flush
+    int in_use;                 // owned by a live thread
+    struct LaDiagRing* next;
+    LaDiagEntry entry[LA_DIAG_RING];
+} LaDiagRing;
+
+// guards the ring and site lists and serializes the flushes
+static pthread_mutex_t la_diag_lock = PTHREAD_MUTEX_INITIALIZER;
+static LaDiagRing* la_diag_rings = NULL;
+static LinalgDiagSite* la_diag_sites = NULL;
+static FILE* la_diag_stream = NULL;
+static _Atomic int la_diag_mode = LINALG_DIAG_BUFFERED;
+
+static atomic_ullong la_diag_seq = 0;
+static atomic_size_t la_diag_total[2];
+
+static pthread_once_t la_diag_once = PTHREAD_ONCE_INIT;
+static pthread_key_t la_diag_key;
+static _Thread_local LaDiagRing* la_diag_ring = NULL;
+
+static const char* la_diag_severity(const LinalgDiagSite* site)
+{
+    return site->severity == LINALG_DIAG_ERROR ? "Error" : "Warning";
+}
+
+// the thread exited, its ring keeps the pending messages until a new thread takes it
+static void la_diag_release(void* ring)
+{
+    pthread_mutex_lock(&la_diag_lock);
+    ((LaDiagRing*)ring)->in_use = 0;
+    pthread_mutex_unlock(&la_diag_lock);
+}
+
+static void la_diag_init()
+{
+    pthread_key_create(&la_diag_key, la_diag_release);
+    atexit(linalgDiagFlush);
+}
+
+// the calling thread's ring, NULL if it could not be allocated
+static LaDiagRing* la_diag_thread_ring()
+{
+    if(la_diag_ring) return la_diag_ring;
+
+    pthread_mutex_lock(&la_diag_lock);
+    LaDiagRing* ring = la_diag_rings;
+    while(ring && ring->in_use) ring = ring->next;
+    if(!ring && (ring = calloc(1, sizeof(LaDiagRing))))
+    {
+        pthread_mutex_init(&ring->lock, NULL);
+        ring->next = la_diag_rings;
+        la_diag_rings = ring;
+    }
+    if(ring) ring->in_use = 1;
+    pthread_mutex_unlock(&la_diag_lock);
+
+    if(ring) pthread_setspecific(la_diag_key, ring);
+    la_diag_ring = ring;
+    return ring;
+}
+
+static int la_diag_seq_cmp(const void* a, const void* b)
+{
+    unsigned long long sa = ((const LaDiagEntry*)a)->seq, sb = ((const LaDiagEntry*)b)->seq;
+    return (sa > sb) - (sa < sb);
+}
+
+// la_diag_lock must be held
+static void la_diag_flush_locked()
+{
+    FILE* out = la_diag_stream ? la_diag_stream : stdout;
+
+    size_t rings = 0, dropped = 0;
+    for(LaDiagRing* ring = la_diag_rings; ring; ring = ring->next) rings++;
+
+    // copy the rings out, so reporting threads only wait for their own ring
+    LaDiagEntry* entries = rings ? malloc(sizeof(LaDiagEntry) * LA_DIAG_RING * rings) : NULL;
+    size_t n = 0;
+    for(LaDiagRing* ring = la_diag_rings; ring; ring = ring->next)
+    {
+        pthread_mutex_lock(&ring->lock);
+        size_t kept = ring->written < LA_DIAG_RING ? ring->written : LA_DIAG_RING;
+        dropped += ring->written - kept;
+        if(!entries) dropped += kept;
+        else for(size_t k = 0; k < kept; k++) entries[n++] = ring->entry[(ring->written - kept + k) % LA_DIAG_RING];
+        ring->written = 0;
+        pthread_mutex_unlock(&ring->lock);
+    }
+
+    if(n > 1) qsort(entries, n, sizeof(LaDiagEntry), la_diag_seq_cmp);
+    for(size_t k = 0; k < n; k++)
+    {
+        const LinalgDiagSite* site = entries[k].site;
+        fprintf(out, "%s: in function %s, defined in file %s at line %zu:\n\t%s\n",
+                la_diag_severity(site), site->function, site->file, site->line, entries[k].msg);
+    }
+    free(entries);
+
+    for(LinalgDiagSite* site = la_diag_sites; site; site = site->next)
+    {
+        size_t pending = atomic_exchange(&site->pending, 0);
+        if(pending <= LINALG_DIAG_SITE_MESSAGES) continue;
+        fprintf(out, "%s: in function %s, defined in file %s at line %zu:\n\trepeated %zu more times(%zu in total)\n",
+                la_diag_severity(site), site->function, site->file, site->line,
+                pending - LINALG_DIAG_SITE_MESSAGES, atomic_load(&site->hits));
+    }
+    if(dropped) fprintf(out, "Warning: %zu linalg diagnostics were dropped(ring buffer full or out of memory)!\n", dropped);
+    fflush(out);
+}
+
+// record a report from site, called by the LINALG_REPORT_* macros
+void linalgDiagReport(LinalgDiagSite* site, const char* format, ...)
+{
+    error_handler(site->file, site->function, site->line);
+    pthread_once(&la_diag_once, la_diag_init);
+
+    atomic_fetch_add_explicit(&la_diag_total[site->severity], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&site->hits, 1, memory_order_relaxed);
+    size_t pending = atomic_fetch_add_explicit(&site->pending, 1, memory_order_relaxed) + 1;
+
+    if(!atomic_load_explicit(&site->registered, memory_order_acquire) && !atomic_exchange(&site->registered, 1))
+    {
+        pthread_mutex_lock(&la_diag_lock);
+        site->next = la_diag_sites;
+        la_diag_sites = site;
+        pthread_mutex_unlock(&la_diag_lock);
+    }
+
+    // past the budget of this site, only counted
+    if(pending > LINALG_DIAG_SITE_MESSAGES) return;
+
+    va_list args;
+    va_start(args, format);
+    LaDiagRing* ring = la_diag_thread_ring();
+    if(ring)
+    {
+        pthread_mutex_lock(&ring->lock);
+        LaDiagEntry* entry = &ring->entry[ring->written % LA_DIAG_RING];
+        entry->seq = atomic_fetch_add(&la_diag_seq, 1);
+        entry->site = site;
+        vsnprintf(entry->msg, LA_DIAG_MSG, format, args);
+        ring->written++;
+        pthread_mutex_unlock(&ring->lock);
+    }
+    else
+    {
+        // no ring, print it right away
+        pthread_mutex_lock(&la_diag_lock);
+        FILE* out = la_diag_stream ? la_diag_stream : stdout;
+        fprintf(out, "%s: in function %s, defined in file %s at line %zu:\n\t", la_diag_severity(site), site->function, site->file, site->line);
+        vfprintf(out, format, args);
+        fprintf(out, "\n");
+        pthread_mutex_unlock(&la_diag_lock);
+    }
+    va_end(args);
+
+    if(la_diag_mode == LINALG_DIAG_IMMEDIATE) linalgDiagFlush();
+}
+
+// print the buffered messages of all threads in order, then how often each call site repeated since the last flush
+void linalgDiagFlush()
+{
+    pthread_mutex_lock(&la_diag_lock);
+    la_diag_flush_locked();
+    pthread_mutex_unlock(&la_diag_lock);
+}
+
+// get the number of reports of a severity since the start
+size_t linalgDiagCount(int severity)
+{
+    if(severity != LINALG_DIAG_ERROR && severity != LINALG_DIAG_WARN) return 0;
+    return atomic_load(&la_diag_total[severity]);
+}
+
+// set the diagnostics mode, returns the mode actually selected
+int linalgDiagSetMode(int mode)
+{
+    mode = mode == LINALG_DIAG_IMMEDIATE ? LINALG_DIAG_IMMEDIATE : LINALG_DIAG_BUFFERED;
+    la_diag_mode = mode;
+    if(mode == LINALG_DIAG_IMMEDIATE) linalgDiagFlush();
+    return mode;
+}
+
+// set the stream diagnostics are printed to(NULL = stdout)
+void linalgDiagSetStream(FILE* stream)
+{
+    pthread_mutex_lock(&la_diag_lock);
+    la_diag_flush_locked();
+    la_diag_stream = stream;
+    pthread_mutex_unlock(&la_diag_lock);
+}
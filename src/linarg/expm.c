@@ -0,0 +1,357 @@
+#include "include/linalg.h"
+#include "src/linarg/alloc.h"
+#include "src/linarg/gemm.h"
+#include "src/linarg/norms.h"
+
+#include <stdlib.h>
+#include <memory.h>
+#include <math.h>
+
+// Pade degrees tried in order, and the largest ||A||_1 each one handles without scaling.
+// Higham's(2005) theta_m bound the backward error by the double unit roundoff 2^-53, and the bound grows as theta^(2m+1),
+// so the long double(2^-64) values are theta_m * 2^(-11/(2m+1))
+#define LA_PADE_DEGREES 5
+static const int la_pade_degree[LA_PADE_DEGREES] = {3, 5, 7, 9, 13};
+static const long double la_pade_theta[LA_PADE_DEGREES] = {
+    5.032271082370424e-3L, 1.269699165031615e-1L, 5.716882639894904e-1L, 1.404408619536243L, 4.050304875153942L
+};
+// mat2DSqPowU takes the power as an unsigned int, larger scalings are undone in several calls
+#define LA_EXPM_MAX_SQUARINGS 31
+
+// numerator coefficients b_0 ... b_m of the [m/m] Pade approximant of e^x
+static const long double la_pade3[] = {120, 60, 12, 1};
+static const long double la_pade5[] = {30240, 15120, 3360, 420, 30, 1};
+static const long double la_pade7[] = {17297280, 8648640, 1995840, 277200, 25200, 1512, 56, 1};
+static const long double la_pade9[] = {17643225600.L, 8821612800.L, 2075673600, 302702400, 30270240, 2162160, 110880, 3960, 90, 1};
+static const long double la_pade13[] = {
+    64764752532480000.L, 32382376266240000.L, 7771770303897600.L, 1187353796428800.L, 129060195264000.L,
+    10559470521600.L, 670442572800.L, 33522128640.L, 1323241920, 40840800, 960960, 16380, 182, 1
+};
+
+// Krylov step control(Expokit): rejected steps before giving up and the safety factors of the step size
+#define LA_EXPMV_MAX_REJECT 10
+#define LA_EXPMV_GAMMA 0.9L
+#define LA_EXPMV_DELTA 1.2L
+// happy breakdown: the next Krylov vector is this small relative to ||A||, the subspace is invariant
+#define LA_EXPMV_BTOL 1e-7L
+
+#define LA_PI 3.14159265358979323846264338327950288L
+
+// M = (accumulate ? M : 0) + c0*I + sum c[i]*P[i], all n x n
+static void la_expm_combine(Mat2d M, int accumulate, long double c0, const long double* c, const Mat2d* P, size_t count)
+{
+    size_t n = M.rows;
+    for(size_t i = 0; i < n; i++)
+    {
+        long double* row = M.mat + i * M.ld;
+        if(!accumulate) for(size_t j = 0; j < n; j++) row[j] = 0;
+        row[i] += c0;
+        for(size_t p = 0; p < count; p++)
+        {
+            const long double* prow = P[p].mat + i * P[p].ld;
+            for(size_t j = 0; j < n; j++) row[j] += c[p] * prow[j];
+        }
+    }
+}
+
+// compute result = e^A(scaling and squaring with a Pade approximant, Higham 2005). prints error if the input is invalid
+int mat2DExpm(Mat2d A, Mat2d* result)
+{
+    LINALG_CHECK_ERROR(!result || !result->mat, LINALG_ERROR, "result matrix is null!");
+    LINALG_CHECK_ERROR(!A.mat, LINALG_ERROR, "input matrix is null!");
+    LINALG_CHECK_ERROR(A.rows != A.cols, LINALG_ERROR, "exponential of a non square mat(%zux%zu)!", A.rows, A.cols);
+    LINALG_CHECK_ERROR(result->rows != A.rows || result->cols != A.cols, LINALG_ERROR, "e^mat(%zux%zu) stored in mat(%zux%zu)", A.rows, A.cols, result->rows, result->cols);
+    LINALG_SCAN_WARN(mat2DContainsNan(A), "input matrix contains INF or NAN!");
+
+    size_t n = A.rows;
+    long double norm;
+    LINALG_ASSERT_ERROR(la_norm1(A, &norm) != LINALG_OK, LINALG_ERROR, "unknown error occured when allocation memory!");
+    LINALG_ASSERT_ERROR(!isfinite(norm), LINALG_ERROR, "input matrix norm is not finite!");
+
+    // lowest degree that is accurate for A, otherwise degree 13 on A/2^s
+    int d = 0, s = 0;
+    while(d < LA_PADE_DEGREES - 1 && norm > la_pade_theta[d]) d++;
+    if(norm > la_pade_theta[LA_PADE_DEGREES - 1]) s = (int)ceill(log2l(norm / la_pade_theta[LA_PADE_DEGREES - 1]));
+    int degree = la_pade_degree[d];
+
+    // X = A/2^s, pw = X^2, X^4, X^6(, X^8), U and V are the odd and even parts of the approximant
+    Mat2d X = mat2DInitUninitA(n, n), U = mat2DInitUninitA(n, n), V = mat2DInitUninitA(n, n), T = mat2DInitUninitA(n, n);
+    Mat2d pw[4] = {mat2DInitUninitA(n, n), {NULL, 0, 0, 0}, {NULL, 0, 0, 0}, {NULL, 0, 0, 0}};
+    size_t npw = degree == 13 ? 3 : (size_t)(degree - 1) / 2;
+    for(size_t p = 1; p < npw; p++) pw[p] = mat2DInitUninitA(n, n);
+    int ok = X.mat && U.mat && V.mat && T.mat;
+    for(size_t p = 0; p < npw; p++) ok = ok && pw[p].mat;
+    if(!ok)
+    {
+        freeMat2D(&X), freeMat2D(&U), freeMat2D(&V), freeMat2D(&T);
+        for(size_t p = 0; p < 4; p++) freeMat2D(&pw[p]);
+        LINALG_REPORT_ERROR("unknown error occured when allocation memory!");
+        return LINALG_ERROR;
+    }
+
+    long double scale = ldexpl(1.0L, -s);
+    for(size_t i = 0; i < n; i++)
+        for(size_t j = 0; j < n; j++) X.mat[i * X.ld + j] = scale * A.mat[i * A.ld + j];
+    linalgGemm(n, n, n, 1, X.mat, X.ld, X.mat, X.ld, 0, pw[0].mat, pw[0].ld);
+    for(size_t p = 1; p < npw; p++) linalgGemm(n, n, n, 1, pw[p - 1].mat, pw[p - 1].ld, pw[0].mat, pw[0].ld, 0, pw[p].mat, pw[p].ld);
+
+    if(degree < 13)
+    {
+        const long double* b = degree == 3 ? la_pade3 : degree == 5 ? la_pade5 : degree == 7 ? la_pade7 : la_pade9;
+        long double odd[4], even[4];
+        for(size_t p = 0; p < npw; p++) odd[p] = b[2 * p + 3], even[p] = b[2 * p + 2];
+        la_expm_combine(T, 0, b[1], odd, pw, npw);
+        la_expm_combine(V, 0, b[0], even, pw, npw);
+    }
+    else
+    {
+        // X^6 (b13 X^6 + b11 X^4 + b9 X^2) + b7 X^6 + b5 X^4 + b3 X^2 + b1 I, same for the even part
+        const long double* b = la_pade13;
+        long double hi_odd[3] = {b[9], b[11], b[13]}, lo_odd[3] = {b[3], b[5], b[7]};
+        long double hi_even[3] = {b[8], b[10], b[12]}, lo_even[3] = {b[2], b[4], b[6]};
+        la_expm_combine(U, 0, 0, hi_odd, pw, 3);
+        linalgGemm(n, n, n, 1, pw[2].mat, pw[2].ld, U.mat, U.ld, 0, T.mat, T.ld);
+        la_expm_combine(T, 1, b[1], lo_odd, pw, 3);
+        la_expm_combine(U, 0, 0, hi_even, pw, 3);
+        linalgGemm(n, n, n, 1, pw[2].mat, pw[2].ld, U.mat, U.ld, 0, V.mat, V.ld);
+        la_expm_combine(V, 1, b[0], lo_even, pw, 3);
+    }
+    linalgGemm(n, n, n, 1, X.mat, X.ld, T.mat, T.ld, 0, U.mat, U.ld);
+
+    // (V - U) R = V + U, R in T
+    for(size_t i = 0; i < n; i++)
+    {
+        for(size_t j = 0; j < n; j++)
+        {
+            long double u = U.mat[i * U.ld + j], v = V.mat[i * V.ld + j];
+            T.mat[i * T.ld + j] = v + u;
+            V.mat[i * V.ld + j] = v - u;
+        }
+    }
+    MatLU lu = matLUFactorA(V);
+    int status = lu.singular ? LINALG_ERROR : matLUSolveMulti(lu, T, &T);
+    freeMatLU(&lu);
+
+    if(status == LINALG_OK)
+    {
+        // undo the scaling: e^A = (e^(A/2^s))^(2^s)
+        for(int left = s; left > 0 && status == LINALG_OK; left -= LA_EXPM_MAX_SQUARINGS)
+        {
+            int step = left < LA_EXPM_MAX_SQUARINGS ? left : LA_EXPM_MAX_SQUARINGS;
+            status = mat2DSqPowU(T, 1u << step, &T);
+        }
+        if(status == LINALG_OK)
+            for(size_t i = 0; i < n; i++) memcpy(result->mat + i * result->ld, T.mat + i * T.ld, n * sizeof(long double));
+    }
+    else
+    {
+        LINALG_REPORT_ERROR("Pade denominator is singular!");
+    }
+
+    freeMat2D(&X), freeMat2D(&U), freeMat2D(&V), freeMat2D(&T);
+    for(size_t p = 0; p < 4; p++) freeMat2D(&pw[p]);
+    return status;
+}
+
+// compute e^A(allocates memory). prints error if the input is invalid
+Mat2d mat2DExpmA(Mat2d A)
+{
+    Mat2d bad_mat = {NULL, 0, 0, 0};
+    LINALG_CHECK_ERROR(A.rows != A.cols, bad_mat, "exponential of a non square mat(%zux%zu)!", A.rows, A.cols);
+    Mat2d result = mat2DInitUninitA(A.rows, A.cols);
+    if(!result.mat) return result;
+    if(mat2DExpm(A, &result) != LINALG_OK)
+    {
+        freeMat2D(&result);
+        return bad_mat;
+    }
+    return result;
+}
+
+/*=========================*/
+// Krylov e^(tA) v
+/*=========================*/
+
+// y = Ax for whichever matrix type the caller holds
+typedef int (*LaExpmvMatvec)(const void* A, Vec x, Vec* y);
+
+static int la_expmv_dense(const void* A, Vec x, Vec* y) { return mat2DTransform(*(const Mat2d*)A, x, y); }
+static int la_expmv_csr(const void* A, Vec x, Vec* y) { return matCSRTransform(*(const MatCSR*)A, x, y); }
+
+// rounds a step size up to 2 significant digits, as Expokit does
+static long double la_expmv_round(long double step)
+{
+    long double s = powl(10.0L, floorl(log10l(step)) - 1);
+    return ceill(step / s) * s;
+}
+
+static long double la_expmv_norm(const long double* x, size_t n)
+{
+    long double sum = 0;
+    for(size_t i = 0; i < n; i++) sum += x[i] * x[i];
+    return sqrtl(sum);
+}
+
+// e^(tA) v with Arnoldi on m dimensional Krylov subspaces and local error control(Sidje, Expokit expv)
+// anorm is ||A||_inf, result can be v
+static int la_expmv(size_t n, LaExpmvMatvec mv, const void* A, long double anorm, long double t, Vec v, size_t m, long double tol, Vec* result)
+{
+    if(m > n) m = n;
+    long double* w = malloc(sizeof(long double) * n);
+    long double* av = malloc(sizeof(long double) * n);
+    Mat2d K = mat2DInitUninitA(m + 1, n);           // Krylov basis, one vector per row
+    Mat2d H = mat2DInitZerosA(m + 2, m + 2);        // Hessenberg matrix with the error estimate extension
+    Mat2d F = mat2DInitUninitA(m + 2, m + 2);
+    if(!w || !av || !K.mat || !H.mat || !F.mat)
+    {
+        free(w), free(av), freeMat2D(&K), freeMat2D(&H), freeMat2D(&F);
+        LINALG_REPORT_ERROR("unknown error occured when allocation memory!");
+        return LINALG_ERROR;
+    }
+
+    for(size_t i = 0; i < n; i++) w[i] = LA_VIDX(v, i);
+    long double beta = la_expmv_norm(w, n);
+    long double t_out = fabsl(t), sgn = t < 0 ? -1 : 1, t_now = 0;
+    int status = LINALG_OK;
+
+    if(beta == 0 || anorm == 0 || t_out == 0) t_now = t_out;
+    long double fact = powl((m + 1) / expl(1.0L), m + 1) * sqrtl(2 * LA_PI * (m + 1));
+    long double xm = 1.0L / m;
+    long double t_new = t_now < t_out ? la_expmv_round(powl(fact * tol / (4 * beta * anorm), xm) / anorm) : 0;
+
+    while(t_now < t_out)
+    {
+        long double t_step = t_out - t_now < t_new ? t_out - t_now : t_new;
+        size_t mb = m;
+        int k1 = 2;
+
+        // Arnoldi(modified Gram-Schmidt)
+        for(size_t i = 0; i < (m + 2) * H.ld; i++) H.mat[i] = 0;
+        for(size_t i = 0; i < n; i++) K.mat[i] = w[i] / beta;
+        for(size_t j = 0; j < m; j++)
+        {
+            Vec kj = mat2DRow(K, j), p = mat2DRow(K, j + 1);
+            mv(A, kj, &p);
+            for(size_t i = 0; i <= j; i++)
+            {
+                const long double* ki = K.mat + i * K.ld;
+                long double h = 0;
+                for(size_t c = 0; c < n; c++) h += ki[c] * p.x[c];
+                for(size_t c = 0; c < n; c++) p.x[c] -= h * ki[c];
+                H.mat[i * H.ld + j] = h;
+            }
+            long double s = la_expmv_norm(p.x, n);
+            if(s < LA_EXPMV_BTOL * anorm)
+            {
+                // invariant subspace, the remaining interval is exact in one step
+                k1 = 0;
+                mb = j + 1;
+                t_step = t_out - t_now;
+                break;
+            }
+            H.mat[(j + 1) * H.ld + j] = s;
+            for(size_t c = 0; c < n; c++) p.x[c] /= s;
+        }
+        long double avnorm = 0;
+        if(k1)
+        {
+            H.mat[(m + 1) * H.ld + m] = 1;
+            Vec km = mat2DRow(K, m), avv = vecConstruct(av, n);
+            mv(A, km, &avv);
+            avnorm = la_expmv_norm(av, n);
+        }
+
+        // shrink the step until the local error estimate is below tol
+        long double err_loc = LA_EXPMV_BTOL;
+        size_t mx = mb + k1;
+        for(int reject = 0;; reject++)
+        {
+            Mat2d Hs = mat2DView(F, 0, 0, mx, mx);
+            for(size_t i = 0; i < mx; i++)
+                for(size_t j = 0; j < mx; j++) Hs.mat[i * Hs.ld + j] = sgn * t_step * H.mat[i * H.ld + j];
+            if(mat2DExpm(Hs, &Hs) != LINALG_OK)
+            {
+                status = LINALG_ERROR;
+                break;
+            }
+            if(!k1) break;
+
+            long double phi1 = fabsl(beta * F.mat[m * F.ld]);
+            long double phi2 = fabsl(beta * F.mat[(m + 1) * F.ld] * avnorm);
+            if(phi1 > 10 * phi2) err_loc = phi2, xm = 1.0L / m;
+            else if(phi1 > phi2) err_loc = phi1 * phi2 / (phi1 - phi2), xm = 1.0L / m;
+            else err_loc = phi1, xm = m > 1 ? 1.0L / (m - 1) : 1.0L;
+            if(err_loc <= LA_EXPMV_DELTA * t_step * tol) break;
+
+            if(reject == LA_EXPMV_MAX_REJECT)
+            {
+                LINALG_REPORT_ERROR("e^(tA)v: step size rejected %d times at t = %Lg, tolerance too small?", LA_EXPMV_MAX_REJECT, t_now);
+                status = LINALG_ERROR;
+                break;
+            }
+            t_step = la_expmv_round(LA_EXPMV_GAMMA * t_step * powl(t_step * tol / err_loc, xm));
+        }
+        if(status != LINALG_OK) break;
+
+        // w = beta K^T F e_1 over the first mb(+1) basis vectors
+        mx = mb + (k1 ? 1 : 0);
+        for(size_t c = 0; c < n; c++) w[c] = 0;
+        for(size_t i = 0; i < mx; i++)
+        {
+            long double coef = beta * F.mat[i * F.ld];
+            const long double* ki = K.mat + i * K.ld;
+            for(size_t c = 0; c < n; c++) w[c] += coef * ki[c];
+        }
+        beta = la_expmv_norm(w, n);
+        t_now += t_step;
+        if(beta == 0) break;
+        t_new = la_expmv_round(LA_EXPMV_GAMMA * t_step * powl(t_step * tol / err_loc, xm));
+    }
+
+    if(status == LINALG_OK)
+        for(size_t i = 0; i < n; i++) LA_VIDX((*result), i) = w[i];
+
+    free(w), free(av), freeMat2D(&K), freeMat2D(&H), freeMat2D(&F);
+    return status;
+}
+
+// compute result = e^(tA) v without forming e^(tA): Krylov subspaces of dimension m with adaptive time steps(Expokit expv)
+int mat2DExpmv(Mat2d A, long double t, Vec v, size_t m, long double tol, Vec* result)
+{
+    LINALG_CHECK_ERROR(!result || !result->x, LINALG_ERROR, "result vector is null!");
+    LINALG_CHECK_ERROR(!A.mat || !v.x, LINALG_ERROR, "input is null!");
+    LINALG_CHECK_ERROR(A.rows != A.cols, LINALG_ERROR, "exponential of a non square mat(%zux%zu)!", A.rows, A.cols);
+    LINALG_CHECK_ERROR(v.len != A.rows || result->len != A.rows, LINALG_ERROR, "e^mat(%zux%zu) applied over vec(%zu) into vec(%zu)", A.rows, A.cols, v.len, result->len);
+    LINALG_CHECK_ERROR(m == 0 || !(tol > 0), LINALG_ERROR, "invalid Krylov dimension(%zu) or tolerance(%Lg)!", m, tol);
+    LINALG_SCAN_WARN(mat2DContainsNan(A), "input matrix contains INF or NAN!");
+    LINALG_SCAN_WARN(vecContainsNan(v), "input vector contains INF or NAN!");
+
+    long double anorm = 0;
+    for(size_t i = 0; i < A.rows; i++)
+    {
+        long double sum = 0;
+        for(size_t j = 0; j < A.cols; j++) sum += fabsl(A.mat[i * A.ld + j]);
+        anorm = sum > anorm ? sum : anorm;
+    }
+    return la_expmv(A.rows, la_expmv_dense, &A, anorm, t, v, m, tol, result);
+}
+
+// compute result = e^(tA) v, same as mat2DExpmv. prints error if the input is invalid or the steps fail, result can be v
+int matCSRExpmv(MatCSR A, long double t, Vec v, size_t m, long double tol, Vec* result)
+{
+    LINALG_CHECK_ERROR(!result || !result->x, LINALG_ERROR, "result vector is null!");
+    LINALG_CHECK_ERROR(!A.rowptr || !v.x, LINALG_ERROR, "input is null!");
+    LINALG_CHECK_ERROR(A.rows != A.cols, LINALG_ERROR, "exponential of a non square csr(%zux%zu)!", A.rows, A.cols);
+    LINALG_CHECK_ERROR(v.len != A.rows || result->len != A.rows, LINALG_ERROR, "e^csr(%zux%zu) applied over vec(%zu) into vec(%zu)", A.rows, A.cols, v.len, result->len);
+    LINALG_CHECK_ERROR(m == 0 || !(tol > 0), LINALG_ERROR, "invalid Krylov dimension(%zu) or tolerance(%Lg)!", m, tol);
+    LINALG_SCAN_WARN(vecContainsNan(v), "input vector contains INF or NAN!");
+
+    long double anorm = 0;
+    for(size_t i = 0; i < A.rows; i++)
+    {
+        long double sum = 0;
+        for(size_t k = A.rowptr[i]; k < A.rowptr[i + 1]; k++) sum += fabsl(A.val[k]);
+        anorm = sum > anorm ? sum : anorm;
+    }
+    return la_expmv(A.rows, la_expmv_csr, &A, anorm, t, v, m, tol, result);
+}
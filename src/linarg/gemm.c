@@ -0,0 +1,175 @@
+#include "include/linalg.h"
+#include "src/linarg/gemm.h"
+#include "src/linarg/parallel.h"
+
+#include <stdlib.h>
+
+// register block(micro-kernel) size, MR x NR accumulators
+// long double lives on the 8 register x87 stack: 2x2 accumulators + 2 values of A + 2 of B fill it exactly
+#define LA_GEMM_MR 2
+#define LA_GEMM_NR 2
+// cache blocks: a MC x KC block of A stays in L2, a KC x NC panel of B in L3
+// KC x NR slivers of B stream through L1. long double is 16 bytes.
+#define LA_GEMM_MC 48
+#define LA_GEMM_KC 128
+#define LA_GEMM_NC 256
+
+// below this many multiply-adds the plain loop wins(no packing buffers)
+#define LA_GEMM_SMALL (32 * 32 * 32)
+// below this many multiply-adds one thread is used
+#define LA_GEMM_PARALLEL (64 * 64 * 64)
+
+#define LA_MIN(a, b) ((a) < (b) ? (a) : (b))
+
+typedef struct LaGemmArgs
+{
+    size_t m, n, k;
+    long double alpha;
+    const long double* A;
+    size_t lda;
+    const long double* B;
+    size_t ldb;
+    long double beta;
+    long double* C;
+    size_t ldc;
+} LaGemmArgs;
+
+// C[r0:r1, :] = beta*C[r0:r1, :]
+static void la_gemm_scale_rows(const LaGemmArgs* g, size_t r0, size_t r1)
+{
+    if(g->beta == 1) return;
+    for(size_t i = r0; i < r1; i++)
+    {
+        long double* c = g->C + i * g->ldc;
+        if(g->beta == 0) for(size_t j = 0; j < g->n; j++) c[j] = 0;
+        else for(size_t j = 0; j < g->n; j++) c[j] *= g->beta;
+    }
+}
+
+// C[r0:r1, :] += alpha*A[r0:r1, :]*B, i-k-j order so B and C are walked along rows
+static void la_gemm_plain(const LaGemmArgs* g, size_t r0, size_t r1)
+{
+    for(size_t i = r0; i < r1; i++)
+    {
+        long double* c = g->C + i * g->ldc;
+        for(size_t p = 0; p < g->k; p++)
+        {
+            long double aip = g->alpha * g->A[i * g->lda + p];
+            const long double* b = g->B + p * g->ldb;
+            for(size_t j = 0; j < g->n; j++) c[j] += aip * b[j];
+        }
+    }
+}
+
+// pack A[ic:ic+mc, pc:pc+kc] into MR tall panels(column of a panel is contiguous), zero padded
+static void la_gemm_pack_a(const LaGemmArgs* g, size_t ic, size_t mc, size_t pc, size_t kc, long double* Ap)
+{
+    for(size_t ir = 0; ir < mc; ir += LA_GEMM_MR)
+    {
+        size_t mr = LA_MIN(LA_GEMM_MR, mc - ir);
+        for(size_t p = 0; p < kc; p++)
+        {
+            for(size_t i = 0; i < mr; i++) Ap[i] = g->A[(ic + ir + i) * g->lda + pc + p];
+            for(size_t i = mr; i < LA_GEMM_MR; i++) Ap[i] = 0;
+            Ap += LA_GEMM_MR;
+        }
+    }
+}
+
+// pack B[pc:pc+kc, jc:jc+nc] into NR wide panels(row of a panel is contiguous), zero padded
+static void la_gemm_pack_b(const LaGemmArgs* g, size_t pc, size_t kc, size_t jc, size_t nc, long double* Bp)
+{
+    for(size_t jr = 0; jr < nc; jr += LA_GEMM_NR)
+    {
+        size_t nr = LA_MIN(LA_GEMM_NR, nc - jr);
+        for(size_t p = 0; p < kc; p++)
+        {
+            const long double* b = g->B + (pc + p) * g->ldb + jc + jr;
+            for(size_t j = 0; j < nr; j++) Bp[j] = b[j];
+            for(size_t j = nr; j < LA_GEMM_NR; j++) Bp[j] = 0;
+            Bp += LA_GEMM_NR;
+        }
+    }
+}
+
+// C[0:mr, 0:nr] += alpha * (MR panel of A) * (NR panel of B)
+static void la_gemm_micro(size_t kc, const long double* Ap, const long double* Bp, long double alpha,
+                          long double* C, size_t ldc, size_t mr, size_t nr)
+{
+    long double acc[LA_GEMM_MR][LA_GEMM_NR] = {{0}};
+    for(size_t p = 0; p < kc; p++)
+    {
+        const long double* a = Ap + p * LA_GEMM_MR;
+        const long double* b = Bp + p * LA_GEMM_NR;
+        for(size_t i = 0; i < LA_GEMM_MR; i++)
+            for(size_t j = 0; j < LA_GEMM_NR; j++) acc[i][j] += a[i] * b[j];
+    }
+    for(size_t i = 0; i < mr; i++)
+        for(size_t j = 0; j < nr; j++) C[i * ldc + j] += alpha * acc[i][j];
+}
+
+// row blocks [begin, end) of C, each block is LA_GEMM_MC rows
+static void la_gemm_rows(size_t begin, size_t end, void* ctx)
+{
+    const LaGemmArgs* g = ctx;
+    size_t r0 = begin * LA_GEMM_MC, r1 = LA_MIN(end * LA_GEMM_MC, g->m);
+
+    la_gemm_scale_rows(g, r0, r1);
+    if(g->alpha == 0 || g->k == 0) return;
+
+    // every thread packs into its own buffers
+    long double* Ap = malloc(sizeof(long double) * LA_GEMM_MC * LA_GEMM_KC);
+    long double* Bp = malloc(sizeof(long double) * LA_GEMM_KC * LA_GEMM_NC);
+    if(!Ap || !Bp)
+    {
+        free(Ap), free(Bp);
+        la_gemm_plain(g, r0, r1);
+        return;
+    }
+
+    for(size_t jc = 0; jc < g->n; jc += LA_GEMM_NC)
+    {
+        size_t nc = LA_MIN(LA_GEMM_NC, g->n - jc);
+        for(size_t pc = 0; pc < g->k; pc += LA_GEMM_KC)
+        {
+            size_t kc = LA_MIN(LA_GEMM_KC, g->k - pc);
+            la_gemm_pack_b(g, pc, kc, jc, nc, Bp);
+            for(size_t ic = r0; ic < r1; ic += LA_GEMM_MC)
+            {
+                size_t mc = LA_MIN(LA_GEMM_MC, r1 - ic);
+                la_gemm_pack_a(g, ic, mc, pc, kc, Ap);
+                for(size_t jr = 0; jr < nc; jr += LA_GEMM_NR)
+                {
+                    for(size_t ir = 0; ir < mc; ir += LA_GEMM_MR)
+                    {
+                        la_gemm_micro(kc, Ap + ir * kc, Bp + jr * kc, g->alpha,
+                                      g->C + (ic + ir) * g->ldc + jc + jr, g->ldc,
+                                      LA_MIN(LA_GEMM_MR, mc - ir), LA_MIN(LA_GEMM_NR, nc - jr));
+                    }
+                }
+            }
+        }
+    }
+
+    free(Ap);
+    free(Bp);
+}
+
+void linalgGemm(size_t m, size_t n, size_t k, long double alpha, const long double* A, size_t lda,
+                const long double* B, size_t ldb, long double beta, long double* C, size_t ldc)
+{
+    if(m == 0 || n == 0) return;
+    LaGemmArgs g = {m, n, k, alpha, A, lda, B, ldb, beta, C, ldc};
+
+    size_t work = m * n * k;
+    if(work < LA_GEMM_SMALL)
+    {
+        la_gemm_scale_rows(&g, 0, m);
+        if(alpha != 0) la_gemm_plain(&g, 0, m);
+        return;
+    }
+
+    size_t blocks = (m + LA_GEMM_MC - 1) / LA_GEMM_MC;
+    if(work < LA_GEMM_PARALLEL) la_gemm_rows(0, blocks, &g);
+    else linalgParallelFor(blocks, 1, la_gemm_rows, &g);
+}
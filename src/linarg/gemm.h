@@ -0,0 +1,12 @@
+#pragma once
+
+// internal to src/linarg, mat2DMul/mat2DMulA are the public wrappers
+
+#include <stddef.h>
+
+// C = alpha*A*B + beta*C
+// A is m x k, B is k x n and C is m x n, all row-major with leading dimensions(row strides) lda, ldb and ldc
+// C must not overlap A or B. beta == 0 overwrites C without reading it.
+// packed and register blocked, the row blocks of C are split over linalgParallelThreads() threads for large products
+void linalgGemm(size_t m, size_t n, size_t k, long double alpha, const long double* A, size_t lda,
+                const long double* B, size_t ldb, long double beta, long double* C, size_t ldc);
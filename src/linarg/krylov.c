@@ -0,0 +1,311 @@
+#include "include/linalg.h"
+#include "src/linarg/alloc.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+/*=========================*/
+// Operators
+/*=========================*/
+
+static int la_apply_dense(Vec x, Vec* y, void* ctx) { return mat2DTransform(*(Mat2d*)ctx, x, y); }
+static int la_apply_csr(Vec x, Vec* y, void* ctx) { return matCSRTransform(*(MatCSR*)ctx, x, y); }
+static int la_apply_ilu0(Vec x, Vec* y, void* ctx) { return matCSRILU0Solve(*(MatCSR*)ctx, x, y); }
+static int la_apply_jacobi(Vec x, Vec* y, void* ctx)
+{
+    Vec d = *(Vec*)ctx;
+    LINALG_CHECK_ERROR(d.len != x.len || y->len != x.len, LINALG_ERROR, "jacobi of size %zu applied over vec(%zu) into vec(%zu)", d.len, x.len, y->len);
+    for(size_t i = 0; i < x.len; i++) LA_VIDX((*y), i) = LA_VIDX(d, i) * LA_VIDX(x, i);
+    return LINALG_OK;
+}
+
+// operator y = Ax of a dense matrix(by ref, A must outlive the operator)
+LinalgOperator linalgOperatorMat2D(Mat2d* A) { return (LinalgOperator){la_apply_dense, A}; }
+// operator y = Ax of a CSR matrix(by ref)
+LinalgOperator linalgOperatorCSR(MatCSR* A) { return (LinalgOperator){la_apply_csr, A}; }
+// Jacobi preconditioner z = inv_diag .* r(by ref)
+LinalgOperator linalgOperatorJacobi(Vec* inv_diag) { return (LinalgOperator){la_apply_jacobi, inv_diag}; }
+// ILU(0) preconditioner z = (LU)^-1 r(by ref)
+LinalgOperator linalgOperatorILU0(MatCSR* LU) { return (LinalgOperator){la_apply_ilu0, LU}; }
+
+// inverse of the diagonal of a dense matrix(allocates memory). prints error on a zero diagonal entry
+Vec mat2DJacobiA(Mat2d A)
+{
+    Vec bad = {NULL, 0, 0};
+    LINALG_ASSERT_ERROR(!A.mat, bad, "input matrix is null!");
+    LINALG_ASSERT_ERROR(A.rows != A.cols, bad, "diagonal of a non square mat(%zux%zu)!", A.rows, A.cols);
+
+    Vec d = vecInitUninitA(A.rows);
+    if(!d.x) return d;
+    for(size_t i = 0; i < A.rows; i++)
+    {
+        long double a = A.mat[i * A.ld + i];
+        if(a == 0)
+        {
+            freeVec(&d);
+            LINALG_REPORT_ERROR("zero diagonal entry in row %zu!", i);
+            return bad;
+        }
+        d.x[i] = 1 / a;
+    }
+    return d;
+}
+
+/*=========================*/
+// Solvers
+/*=========================*/
+
+// the solvers work on contiguous n long scratch arrays, x and b are only read/written at entry and exit
+
+static long double la_krylov_dot(const long double* a, const long double* b, size_t n)
+{
+    long double sum = 0;
+    for(size_t i = 0; i < n; i++) sum += a[i] * b[i];
+    return sum;
+}
+
+// z = M^-1 r, identity when there is no preconditioner
+static int la_krylov_precond(LinalgOperator M, long double* r, long double* z, size_t n)
+{
+    if(!M.apply)
+    {
+        for(size_t i = 0; i < n; i++) z[i] = r[i];
+        return LINALG_OK;
+    }
+    Vec vr = vecConstruct(r, n), vz = vecConstruct(z, n);
+    return M.apply(vr, &vz, M.ctx);
+}
+
+// r = b - Ax
+static int la_krylov_residual(LinalgOperator A, const long double* b, long double* x, long double* r, size_t n)
+{
+    Vec vx = vecConstruct(x, n), vr = vecConstruct(r, n);
+    if(A.apply(vx, &vr, A.ctx) != LINALG_OK) return LINALG_ERROR;
+    for(size_t i = 0; i < n; i++) r[i] = b[i] - r[i];
+    return LINALG_OK;
+}
+
+// checks shared by the solvers, returns ||b||(0 sets x = 0) or NAN on invalid input
+static long double la_krylov_check(LinalgOperator A, Vec b, Vec* x, LinalgKrylovConfig config)
+{
+    LINALG_CHECK_ERROR(!A.apply, NAN, "operator is null!");
+    LINALG_CHECK_ERROR(!x || !x->x || !b.x, NAN, "input vector is null!");
+    LINALG_CHECK_ERROR(b.len != x->len || b.len == 0, NAN, "solving for vec(%zu) with right side vec(%zu)", x->len, b.len);
+    LINALG_CHECK_ERROR(!(config.tol > 0) || config.max_iter == 0, NAN, "invalid tolerance(%Lg) or iteration limit(%zu)!", config.tol, config.max_iter);
+    LINALG_SCAN_WARN(vecContainsNan(b), "right side contains INF or NAN!");
+    LINALG_SCAN_WARN(vecContainsNan(*x), "initial guess contains INF or NAN!");
+
+    long double bnorm = 0;
+    for(size_t i = 0; i < b.len; i++) bnorm += LA_VIDX(b, i) * LA_VIDX(b, i);
+    bnorm = sqrtl(bnorm);
+    if(bnorm == 0)
+        for(size_t i = 0; i < x->len; i++) LA_VIDX((*x), i) = 0;
+    return bnorm;
+}
+
+// write the result back and report
+static int la_krylov_finish(const char* name, long double* xs, Vec* x, int status, int converged, size_t its, long double residual, LinalgKrylovInfo* info)
+{
+    if(status == LINALG_OK)
+        for(size_t i = 0; i < x->len; i++) LA_VIDX((*x), i) = xs[i];
+    if(info) info->iterations = its, info->residual = residual;
+    if(status != LINALG_OK) return status;
+    if(!converged)
+    {
+        LINALG_REPORT_WARN("%s did not converge in %zu iterations(relative residual %Lg)!", name, its, residual);
+        return LINALG_ERROR;
+    }
+    return LINALG_OK;
+}
+
+// solve Ax = b with restarted, right preconditioned GMRES(Saad & Schultz 1986)
+// modified Gram-Schmidt Arnoldi, Givens rotations on the Hessenberg matrix, the true residual is recomputed every restart
+int linalgGMRES(LinalgOperator A, LinalgOperator M, Vec b, Vec* x, LinalgKrylovConfig config, LinalgKrylovInfo* info)
+{
+    long double bnorm = la_krylov_check(A, b, x, config);
+    if(isnan(bnorm)) return LINALG_ERROR;
+    if(info) info->iterations = 0, info->residual = 0;
+    if(bnorm == 0) return LINALG_OK;
+    LINALG_CHECK_ERROR(config.restart == 0, LINALG_ERROR, "invalid restart length(0)!");
+
+    size_t n = b.len, m = config.restart < n ? config.restart : n;
+    Mat2d V = mat2DInitUninitA(m + 1, n);       // Krylov basis, one vector per row
+    Mat2d H = mat2DInitUninitA(m + 1, m);       // Hessenberg matrix, triangularized as it is built
+    long double* work = malloc(sizeof(long double) * (4 * n + 4 * m + 1));
+    if(!V.mat || !H.mat || !work)
+    {
+        freeMat2D(&V), freeMat2D(&H), free(work);
+        LINALG_REPORT_ERROR("unknown error occured when allocation memory!");
+        return LINALG_ERROR;
+    }
+    long double *xs = work, *bs = xs + n, *r = bs + n, *z = r + n;
+    long double *cs = z + n, *sn = cs + m, *y = sn + m, *g = y + m;
+    for(size_t i = 0; i < n; i++) xs[i] = LA_VIDX((*x), i), bs[i] = LA_VIDX(b, i);
+
+    int status = la_krylov_residual(A, bs, xs, r, n);
+    long double rnorm = sqrtl(la_krylov_dot(r, r, n));
+    size_t its = 0;
+    while(status == LINALG_OK && rnorm > config.tol * bnorm && its < config.max_iter)
+    {
+        for(size_t i = 0; i < n; i++) V.mat[i] = r[i] / rnorm;
+        for(size_t i = 0; i <= m; i++) g[i] = 0;
+        g[0] = rnorm;
+
+        size_t k = 0;
+        while(k < m && its < config.max_iter)
+        {
+            long double* vk = V.mat + k * V.ld;
+            long double* w = V.mat + (k + 1) * V.ld;
+            Vec vz = vecConstruct(z, n), vw = vecConstruct(w, n);
+            if(la_krylov_precond(M, vk, z, n) != LINALG_OK || A.apply(vz, &vw, A.ctx) != LINALG_OK)
+            {
+                status = LINALG_ERROR;
+                break;
+            }
+            its++;
+
+            for(size_t i = 0; i <= k; i++)
+            {
+                const long double* vi = V.mat + i * V.ld;
+                long double h = la_krylov_dot(vi, w, n);
+                for(size_t c = 0; c < n; c++) w[c] -= h * vi[c];
+                H.mat[i * H.ld + k] = h;
+            }
+            long double hn = sqrtl(la_krylov_dot(w, w, n));
+            if(hn > 0)
+                for(size_t c = 0; c < n; c++) w[c] /= hn;
+
+            // previous rotations on the new column, then the one eliminating hn
+            for(size_t i = 0; i < k; i++)
+            {
+                long double a = H.mat[i * H.ld + k], c = H.mat[(i + 1) * H.ld + k];
+                H.mat[i * H.ld + k] = cs[i] * a + sn[i] * c;
+                H.mat[(i + 1) * H.ld + k] = -sn[i] * a + cs[i] * c;
+            }
+            long double hk = H.mat[k * H.ld + k], den = hypotl(hk, hn);
+            cs[k] = den > 0 ? hk / den : 1;
+            sn[k] = den > 0 ? hn / den : 0;
+            H.mat[k * H.ld + k] = den;
+            g[k + 1] = -sn[k] * g[k];
+            g[k] = cs[k] * g[k];
+            k++;
+
+            // hn == 0 is a happy breakdown, the subspace holds the solution
+            if(fabsl(g[k]) <= config.tol * bnorm || hn == 0) break;
+        }
+        if(status != LINALG_OK || k == 0) break;
+
+        // y = H^-1 g(upper triangular), x += M^-1 V y
+        for(size_t i = k; i-- > 0;)
+        {
+            long double val = g[i];
+            for(size_t j = i + 1; j < k; j++) val -= H.mat[i * H.ld + j] * y[j];
+            if(H.mat[i * H.ld + i] == 0)
+            {
+                LINALG_REPORT_ERROR("GMRES breakdown, singular Hessenberg matrix!");
+                status = LINALG_ERROR;
+                break;
+            }
+            y[i] = val / H.mat[i * H.ld + i];
+        }
+        if(status != LINALG_OK) break;
+        for(size_t c = 0; c < n; c++) r[c] = 0;
+        for(size_t i = 0; i < k; i++)
+        {
+            const long double* vi = V.mat + i * V.ld;
+            for(size_t c = 0; c < n; c++) r[c] += y[i] * vi[c];
+        }
+        if(la_krylov_precond(M, r, z, n) != LINALG_OK)
+        {
+            status = LINALG_ERROR;
+            break;
+        }
+        for(size_t c = 0; c < n; c++) xs[c] += z[c];
+
+        status = la_krylov_residual(A, bs, xs, r, n);
+        rnorm = sqrtl(la_krylov_dot(r, r, n));
+    }
+
+    int converged = rnorm <= config.tol * bnorm;
+    status = la_krylov_finish("GMRES", xs, x, status, converged, its, rnorm / bnorm, info);
+    freeMat2D(&V), freeMat2D(&H), free(work);
+    return status;
+}
+
+// solve Ax = b with right preconditioned BiCGSTAB(van der Vorst 1992)
+int linalgBiCGSTAB(LinalgOperator A, LinalgOperator M, Vec b, Vec* x, LinalgKrylovConfig config, LinalgKrylovInfo* info)
+{
+    long double bnorm = la_krylov_check(A, b, x, config);
+    if(isnan(bnorm)) return LINALG_ERROR;
+    if(info) info->iterations = 0, info->residual = 0;
+    if(bnorm == 0) return LINALG_OK;
+
+    size_t n = b.len;
+    long double* work = malloc(sizeof(long double) * 9 * n);
+    LINALG_ASSERT_ERROR(!work, LINALG_ERROR, "unknown error occured when allocation memory!");
+    long double *xs = work, *bs = xs + n, *r = bs + n, *rhat = r + n, *p = rhat + n;
+    long double *v = p + n, *ph = v + n, *sh = ph + n, *t = sh + n;
+    for(size_t i = 0; i < n; i++) xs[i] = LA_VIDX((*x), i), bs[i] = LA_VIDX(b, i), p[i] = v[i] = 0;
+
+    int status = la_krylov_residual(A, bs, xs, r, n);
+    for(size_t i = 0; i < n; i++) rhat[i] = r[i];
+    long double rnorm = sqrtl(la_krylov_dot(r, r, n));
+    long double rho = 1, alpha = 1, omega = 1;
+    size_t its = 0;
+    Vec vph = vecConstruct(ph, n), vsh = vecConstruct(sh, n), vv = vecConstruct(v, n), vt = vecConstruct(t, n);
+    while(status == LINALG_OK && rnorm > config.tol * bnorm && its < config.max_iter)
+    {
+        long double rho_new = la_krylov_dot(rhat, r, n);
+        if(rho_new == 0 || omega == 0)
+        {
+            LINALG_REPORT_WARN("BiCGSTAB breakdown(rho = %Lg, omega = %Lg) after %zu iterations!", rho_new, omega, its);
+            break;
+        }
+        long double beta = rho_new / rho * alpha / omega;
+        rho = rho_new;
+        for(size_t i = 0; i < n; i++) p[i] = r[i] + beta * (p[i] - omega * v[i]);
+
+        if(la_krylov_precond(M, p, ph, n) != LINALG_OK || A.apply(vph, &vv, A.ctx) != LINALG_OK)
+        {
+            status = LINALG_ERROR;
+            break;
+        }
+        its++;
+        long double rv = la_krylov_dot(rhat, v, n);
+        if(rv == 0)
+        {
+            LINALG_REPORT_WARN("BiCGSTAB breakdown(rhat.v = 0) after %zu iterations!", its);
+            break;
+        }
+        alpha = rho / rv;
+        // r becomes s = r - alpha v
+        for(size_t i = 0; i < n; i++) r[i] -= alpha * v[i];
+        rnorm = sqrtl(la_krylov_dot(r, r, n));
+        if(rnorm <= config.tol * bnorm)
+        {
+            for(size_t i = 0; i < n; i++) xs[i] += alpha * ph[i];
+            break;
+        }
+
+        if(la_krylov_precond(M, r, sh, n) != LINALG_OK || A.apply(vsh, &vt, A.ctx) != LINALG_OK)
+        {
+            status = LINALG_ERROR;
+            break;
+        }
+        long double tt = la_krylov_dot(t, t, n);
+        omega = tt > 0 ? la_krylov_dot(t, r, n) / tt : 0;
+        for(size_t i = 0; i < n; i++) xs[i] += alpha * ph[i] + omega * sh[i], r[i] -= omega * t[i];
+        rnorm = sqrtl(la_krylov_dot(r, r, n));
+    }
+
+    // the recurrence drifts from b - Ax in long runs, report the true residual
+    if(status == LINALG_OK)
+    {
+        status = la_krylov_residual(A, bs, xs, r, n);
+        rnorm = sqrtl(la_krylov_dot(r, r, n));
+    }
+    int converged = rnorm <= config.tol * bnorm;
+    status = la_krylov_finish("BiCGSTAB", xs, x, status, converged, its, rnorm / bnorm, info);
+    free(work);
+    return status;
+}
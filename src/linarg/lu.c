@@ -0,0 +1,349 @@
+#include "include/linalg.h"
+#include "src/linarg/alloc.h"
+#include "src/linarg/gemm.h"
+#include "src/linarg/norms.h"
+#include "src/linarg/parallel.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+// iterations of the condition estimator(Higham recommends 5)
+#define LA_COND_ITERS 5
+
+// panel width of the blocked factorization, and the size it starts at
+#define LA_LU_BLOCK 64
+#define LA_LU_BLOCKED_MIN 192
+
+// allocate an (unfactored) n x n LU object(allocates memory)
+MatLU matLUInitA(size_t n)
+{
+    MatLU lu = {{NULL, 0, 0, 0}, NULL, 1, 1, 0};
+    LINALG_ASSERT_ERROR(n == 0, lu, "invalid zero size LU requested!");
+    lu.lu = mat2DInitZerosA(n, n);
+    lu.perm = malloc(sizeof(size_t) * n);
+    if(!lu.lu.mat || !lu.perm)
+    {
+        freeMatLU(&lu);
+        LINALG_REPORT_ERROR("unknown error occured when allocation memory!");
+        return lu;
+    }
+    for(size_t i = 0; i < n; i++) lu.perm[i] = i;
+    return lu;
+}
+
+// factor A into a new LU object(allocates memory). prints error if the input is invalid or singular
+MatLU matLUFactorA(Mat2d A)
+{
+    MatLU bad = {{NULL, 0, 0, 0}, NULL, 1, 1, 0};
+    LINALG_ASSERT_ERROR(A.rows != A.cols, bad, "LU of a non square mat(%zux%zu)!", A.rows, A.cols);
+    MatLU lu = matLUInitA(A.rows);
+    if(!lu.perm) return lu;
+    matLUFactor(A, &lu);
+    return lu;
+}
+
+// factors columns [k0, k1) of rows [k0, n) with partial pivoting, the updates stop at column k1
+// rows are swapped whole, so every update sweeps contiguous rows. the first zero pivot column is kept in first_zero
+static void la_lu_panel(long double* a, size_t lda, size_t n, size_t k0, size_t k1, size_t* perm, int* sign, size_t* first_zero)
+{
+    for(size_t k = k0; k < k1; k++)
+    {
+        size_t p = k;
+        long double max_val = fabsl(a[k * lda + k]);
+        for(size_t i = k + 1; i < n; i++)
+        {
+            if(fabsl(a[i * lda + k]) > max_val)
+            {
+                max_val = fabsl(a[i * lda + k]);
+                p = i;
+            }
+        }
+        if(max_val == 0)
+        {
+            // nothing to eliminate in this column, keep going so U is still complete
+            if(*first_zero == n) *first_zero = k;
+            continue;
+        }
+        if(p != k)
+        {
+            long double* row_k = a + k * lda;
+            long double* row_p = a + p * lda;
+            for(size_t j = 0; j < n; j++)
+            {
+                long double temp = row_k[j];
+                row_k[j] = row_p[j];
+                row_p[j] = temp;
+            }
+            size_t temp = perm[k];
+            perm[k] = perm[p];
+            perm[p] = temp;
+            *sign = -*sign;
+        }
+
+        const long double* row_k = a + k * lda;
+        long double pivot = row_k[k];
+        for(size_t i = k + 1; i < n; i++)
+        {
+            long double* row_i = a + i * lda;
+            long double l = row_i[k] / pivot;
+            row_i[k] = l;
+            if(l == 0) continue;
+            for(size_t j = k + 1; j < k1; j++) row_i[j] -= l * row_k[j];
+        }
+    }
+}
+
+typedef struct LaLUTrsmArgs
+{
+    long double* a;
+    size_t lda;
+    size_t k0, k1;
+} LaLUTrsmArgs;
+
+// U12 = L11^-1 A12 on the columns [k1 + begin, k1 + end) of the block rows [k0, k1)
+static void la_lu_trsm(size_t begin, size_t end, void* ctx)
+{
+    const LaLUTrsmArgs* args = ctx;
+    size_t c0 = args->k1 + begin, c1 = args->k1 + end;
+    for(size_t i = args->k0 + 1; i < args->k1; i++)
+    {
+        long double* row_i = args->a + i * args->lda;
+        for(size_t j = args->k0; j < i; j++)
+        {
+            long double l = row_i[j];
+            if(l == 0) continue;
+            const long double* row_j = args->a + j * args->lda;
+            for(size_t c = c0; c < c1; c++) row_i[c] -= l * row_j[c];
+        }
+    }
+}
+
+// LU with partial pivoting of the n x n row-major matrix a(row stride lda). returns the first zero pivot column or n
+// small matrices are eliminated directly. large ones are factored right looking in LA_LU_BLOCK wide panels:
+// panel factorization, U12 = L11^-1 A12, then the trailing update A22 -= L21 U12 through the threaded GEMM
+static size_t la_lu_kernel(long double* a, size_t lda, size_t n, size_t* perm, int* sign)
+{
+    size_t first_zero = n;
+    if(n < LA_LU_BLOCKED_MIN)
+    {
+        la_lu_panel(a, lda, n, 0, n, perm, sign, &first_zero);
+        return first_zero;
+    }
+
+    for(size_t k0 = 0; k0 < n; k0 += LA_LU_BLOCK)
+    {
+        size_t k1 = k0 + LA_LU_BLOCK < n ? k0 + LA_LU_BLOCK : n;
+        la_lu_panel(a, lda, n, k0, k1, perm, sign, &first_zero);
+        if(k1 == n) break;
+
+        LaLUTrsmArgs trsm = {a, lda, k0, k1};
+        linalgParallelFor(n - k1, LA_LU_BLOCK, la_lu_trsm, &trsm);
+        linalgGemm(n - k1, n - k1, k1 - k0, -1, a + k1 * lda + k0, lda, a + k0 * lda + k1, lda, 1, a + k1 * lda + k1, lda);
+    }
+    return first_zero;
+}
+
+// factor A into an existing LU object of the same size, A may be lu->lu(in place). prints error if the input is invalid or singular
+int matLUFactor(Mat2d A, MatLU* lu)
+{
+    LINALG_CHECK_ERROR(!lu || !lu->lu.mat || !lu->perm, LINALG_ERROR, "LU object is null!");
+    LINALG_CHECK_ERROR(!A.mat, LINALG_ERROR, "input matrix is null!");
+    LINALG_CHECK_ERROR(A.rows != A.cols, LINALG_ERROR, "LU of a non square mat(%zux%zu)!", A.rows, A.cols);
+    LINALG_CHECK_ERROR(A.rows != lu->lu.rows, LINALG_ERROR, "mat(%zux%zu) factored into LU of size %zu!", A.rows, A.cols, lu->lu.rows);
+    LINALG_SCAN_WARN(mat2DContainsNan(A), "input matrix contains INF or NAN!");
+
+    size_t n = A.rows, lda = lu->lu.ld;
+    long double* a = lu->lu.mat;
+
+    LINALG_ASSERT_ERROR(la_norm1(A, &lu->anorm) != LINALG_OK, LINALG_ERROR, "unknown error occured when allocation memory!");
+
+    if(a != A.mat)
+        for(size_t i = 0; i < n; i++)
+            for(size_t j = 0; j < n; j++) a[i * lda + j] = A.mat[i * A.ld + j];
+
+    for(size_t i = 0; i < n; i++) lu->perm[i] = i;
+    lu->sign = 1;
+
+    size_t zero = la_lu_kernel(a, lda, n, lu->perm, &lu->sign);
+    lu->singular = zero != n;
+    LINALG_ASSERT_ERROR(lu->singular, LINALG_ERROR, "matrix is singular(zero pivot in column %zu)!", zero);
+
+    return LINALG_OK;
+}
+
+// y = L^-1 y, then y = U^-1 y for a contiguous y
+static void la_lu_substitute(MatLU lu, long double* y)
+{
+    size_t n = lu.lu.rows, lda = lu.lu.ld;
+    const long double* a = lu.lu.mat;
+    for(size_t i = 1; i < n; i++)
+    {
+        const long double* row = a + i * lda;
+        long double val = y[i];
+        for(size_t j = 0; j < i; j++) val -= row[j] * y[j];
+        y[i] = val;
+    }
+    for(size_t i = n; i-- > 0;)
+    {
+        const long double* row = a + i * lda;
+        long double val = y[i];
+        for(size_t j = i + 1; j < n; j++) val -= row[j] * y[j];
+        y[i] = val / row[i];
+    }
+}
+
+// y = A^-T y for a contiguous y: U^T z = y, L^T w = z, y = P^T w(needs a scratch of n)
+static void la_lu_substituteT(MatLU lu, long double* y, long double* scratch)
+{
+    size_t n = lu.lu.rows, lda = lu.lu.ld;
+    const long double* a = lu.lu.mat;
+    // U^T is lower triangular, eliminate with the rows of U(contiguous)
+    for(size_t i = 0; i < n; i++)
+    {
+        const long double* row = a + i * lda;
+        y[i] /= row[i];
+        for(size_t j = i + 1; j < n; j++) y[j] -= row[j] * y[i];
+    }
+    // L^T is unit upper triangular
+    for(size_t i = n; i-- > 0;)
+    {
+        const long double* row = a + i * lda;
+        for(size_t j = 0; j < i; j++) y[j] -= row[j] * y[i];
+    }
+    for(size_t i = 0; i < n; i++) scratch[lu.perm[i]] = y[i];
+    for(size_t i = 0; i < n; i++) y[i] = scratch[i];
+}
+
+// solve Ax = b with a factored A, x may be b. prints error if the input is invalid
+int matLUSolve(MatLU lu, Vec b, Vec* x)
+{
+    LINALG_CHECK_ERROR(!lu.lu.mat || !lu.perm, LINALG_ERROR, "LU object is null!");
+    LINALG_CHECK_ERROR(!x || !x->x, LINALG_ERROR, "result vector is null!");
+    LINALG_CHECK_ERROR(!b.x, LINALG_ERROR, "input vector is null!");
+    LINALG_CHECK_ERROR(b.len != lu.lu.rows || x->len != lu.lu.rows, LINALG_ERROR,
+                       "LU of size %zu solved with vec(%zu) into vec(%zu)!", lu.lu.rows, b.len, x->len);
+    LINALG_ASSERT_ERROR(lu.singular, LINALG_ERROR, "solve with a singular(or unfactored) LU!");
+    LINALG_SCAN_WARN(vecContainsNan(b), "input vector contains INF or NAN!");
+
+    size_t n = lu.lu.rows;
+    long double* y = malloc(sizeof(long double) * n);
+    LINALG_ASSERT_ERROR(!y, LINALG_ERROR, "unknown error occured when allocation memory!");
+
+    for(size_t i = 0; i < n; i++) y[i] = LA_VIDX(b, lu.perm[i]);
+    la_lu_substitute(lu, y);
+    for(size_t i = 0; i < n; i++) LA_VIDX((*x), i) = y[i];
+
+    free(y);
+    return LINALG_OK;
+}
+
+// solve AX = B for every column of B, X may be B. prints error if the input is invalid
+int matLUSolveMulti(MatLU lu, Mat2d B, Mat2d* X)
+{
+    LINALG_CHECK_ERROR(!lu.lu.mat || !lu.perm, LINALG_ERROR, "LU object is null!");
+    LINALG_CHECK_ERROR(!X || !X->mat, LINALG_ERROR, "result matrix is null!");
+    LINALG_CHECK_ERROR(!B.mat, LINALG_ERROR, "input matrix is null!");
+    LINALG_CHECK_ERROR(B.rows != lu.lu.rows || X->rows != B.rows || X->cols != B.cols, LINALG_ERROR,
+                       "LU of size %zu solved with mat(%zux%zu) into mat(%zux%zu)!", lu.lu.rows, B.rows, B.cols, X->rows, X->cols);
+    LINALG_ASSERT_ERROR(lu.singular, LINALG_ERROR, "solve with a singular(or unfactored) LU!");
+    LINALG_SCAN_WARN(mat2DContainsNan(B), "input matrix contains INF or NAN!");
+
+    size_t n = lu.lu.rows, m = B.cols, lda = lu.lu.ld;
+    const long double* a = lu.lu.mat;
+    long double* y = malloc(sizeof(long double) * n * m);
+    LINALG_ASSERT_ERROR(!y, LINALG_ERROR, "unknown error occured when allocation memory!");
+
+    // all right hand sides at once: every update is a row of y(m contiguous values)
+    for(size_t i = 0; i < n; i++)
+        for(size_t c = 0; c < m; c++) y[i * m + c] = B.mat[lu.perm[i] * B.ld + c];
+    for(size_t i = 1; i < n; i++)
+    {
+        long double* y_i = y + i * m;
+        for(size_t j = 0; j < i; j++)
+        {
+            long double l = a[i * lda + j];
+            if(l == 0) continue;
+            const long double* y_j = y + j * m;
+            for(size_t c = 0; c < m; c++) y_i[c] -= l * y_j[c];
+        }
+    }
+    for(size_t i = n; i-- > 0;)
+    {
+        long double* y_i = y + i * m;
+        for(size_t j = i + 1; j < n; j++)
+        {
+            long double u = a[i * lda + j];
+            if(u == 0) continue;
+            const long double* y_j = y + j * m;
+            for(size_t c = 0; c < m; c++) y_i[c] -= u * y_j[c];
+        }
+        for(size_t c = 0; c < m; c++) y_i[c] /= a[i * lda + i];
+    }
+    for(size_t i = 0; i < n; i++)
+        for(size_t c = 0; c < m; c++) X->mat[i * X->ld + c] = y[i * m + c];
+
+    free(y);
+    return LINALG_OK;
+}
+
+// estimate of the 1-norm condition number ||A||_1 ||A^-1||_1(Hager/Higham), O(n^2). INFINITY for singular A
+long double matLUCond1Est(MatLU lu)
+{
+    LINALG_CHECK_ERROR(!lu.lu.mat || !lu.perm, NAN, "LU object is null!");
+    if(lu.singular) return INFINITY;
+
+    size_t n = lu.lu.rows;
+    long double* x = malloc(sizeof(long double) * n);
+    long double* y = malloc(sizeof(long double) * n);
+    long double* scratch = malloc(sizeof(long double) * n);
+    if(!x || !y || !scratch)
+    {
+        free(x), free(y), free(scratch);
+        LINALG_REPORT_ERROR("unknown error occured when allocation memory!");
+        return NAN;
+    }
+
+    // maximize ||A^-1 x||_1 over ||x||_1 = 1, starting from the uniform vector
+    for(size_t i = 0; i < n; i++) x[i] = 1.0L / n;
+    long double est = 0;
+    size_t last_j = n;
+    for(int iter = 0; iter < LA_COND_ITERS; iter++)
+    {
+        // y = A^-1 x
+        for(size_t i = 0; i < n; i++) y[i] = x[lu.perm[i]];
+        la_lu_substitute(lu, y);
+        long double norm = 0;
+        for(size_t i = 0; i < n; i++) norm += fabsl(y[i]);
+        if(iter > 0 && norm <= est) break;
+        est = norm;
+
+        // z = A^-T sign(y), stored in y
+        long double zx = 0;
+        for(size_t i = 0; i < n; i++) y[i] = y[i] >= 0 ? 1.0L : -1.0L;
+        la_lu_substituteT(lu, y, scratch);
+        size_t j = 0;
+        for(size_t i = 0; i < n; i++)
+        {
+            zx += y[i] * x[i];
+            if(fabsl(y[i]) > fabsl(y[j])) j = i;
+        }
+        if(fabsl(y[j]) <= zx || j == last_j) break;
+        last_j = j;
+        for(size_t i = 0; i < n; i++) x[i] = 0;
+        x[j] = 1;
+    }
+
+    free(x), free(y), free(scratch);
+    return est * lu.anorm;
+}
+
+// free the LU object on the heap
+void freeMatLU(MatLU* lu)
+{
+    if(!lu) return;
+    freeMat2D(&lu->lu);
+    free(lu->perm);
+    lu->perm = NULL;
+    lu->lu = (Mat2d){NULL, 0, 0, 0};
+    lu->singular = 1;
+}
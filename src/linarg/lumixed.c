@@ -0,0 +1,262 @@
+#include "include/linalg.h"
+#include "src/linarg/alloc.h"
+#include "src/linarg/simd.h"
+
+#include <stdlib.h>
+#include <float.h>
+#include <math.h>
+
+// refinement steps before giving up, every step gains about -log10(cond(A) * DBL_EPSILON) digits
+#define LA_REFINE_MAX_ITERS 20
+// converged once the correction is this small relative to x
+#define LA_REFINE_TOL (8 * LDBL_EPSILON)
+// plain refinement gaining less than a digit per step hands over to GMRES-IR
+#define LA_REFINE_SLOW 0.1L
+// a GMRES-IR correction that shrinks by less than this factor means the refinement stalled
+#define LA_REFINE_CONTRACTION 0.5L
+// GMRES-IR corrections(see matLUDSolveRefined): relative residual, matrix products and restart length
+#define LA_REFINE_GMRES_TOL 1e-12L
+#define LA_REFINE_GMRES_ITERS 100
+#define LA_REFINE_GMRES_RESTART 50
+
+// allocate an (unfactored) n x n double LU object(allocates memory)
+MatLUD matLUDInitA(size_t n)
+{
+    MatLUD lu = {{NULL, 0, 0}, NULL, 1};
+    LINALG_ASSERT_ERROR(n == 0, lu, "invalid zero size LU requested!");
+    lu.lu = mat2DDInitZerosA(n, n);
+    lu.perm = malloc(sizeof(size_t) * n);
+    if(!lu.lu.mat || !lu.perm)
+    {
+        freeMatLUD(&lu);
+        LINALG_REPORT_ERROR("unknown error occured when allocation memory!");
+        return lu;
+    }
+    for(size_t i = 0; i < n; i++) lu.perm[i] = i;
+    return lu;
+}
+
+// round A to double and factor it into lu(right looking, partial pivoting, rows swapped whole)
+// the row updates are contiguous double axpys, they run the simd kernels
+int matLUDFactor(Mat2d A, MatLUD* lu)
+{
+    LINALG_CHECK_ERROR(!lu || !lu->lu.mat || !lu->perm, LINALG_ERROR, "LU object is null!");
+    LINALG_CHECK_ERROR(!A.mat, LINALG_ERROR, "input matrix is null!");
+    LINALG_CHECK_ERROR(A.rows != A.cols, LINALG_ERROR, "LU of a non square mat(%zux%zu)!", A.rows, A.cols);
+    LINALG_CHECK_ERROR(A.rows != lu->lu.rows, LINALG_ERROR, "mat(%zux%zu) factored into LU of size %zu!", A.rows, A.cols, lu->lu.rows);
+    LINALG_SCAN_WARN(mat2DContainsNan(A), "input matrix contains INF or NAN!");
+
+    const LinalgSimdKernelsD* kernels = linalgSimdKernelsD();
+    size_t n = A.rows, zero = n;
+    double* a = lu->lu.mat;
+    for(size_t i = 0; i < n; i++)
+        for(size_t j = 0; j < n; j++) a[i * n + j] = (double)A.mat[i * A.ld + j];
+    for(size_t i = 0; i < n; i++) lu->perm[i] = i;
+
+    for(size_t k = 0; k < n; k++)
+    {
+        size_t p = k;
+        double max_val = fabs(a[k * n + k]);
+        for(size_t i = k + 1; i < n; i++)
+            if(fabs(a[i * n + k]) > max_val) max_val = fabs(a[i * n + k]), p = i;
+        if(max_val == 0)
+        {
+            if(zero == n) zero = k;
+            continue;
+        }
+        if(p != k)
+        {
+            for(size_t j = 0; j < n; j++)
+            {
+                double tmp = a[k * n + j];
+                a[k * n + j] = a[p * n + j];
+                a[p * n + j] = tmp;
+            }
+            size_t tmp = lu->perm[k];
+            lu->perm[k] = lu->perm[p];
+            lu->perm[p] = tmp;
+        }
+
+        const double* row_k = a + k * n;
+        for(size_t i = k + 1; i < n; i++)
+        {
+            double* row_i = a + i * n;
+            double l = row_i[k] /= row_k[k];
+            if(l != 0) kernels->axpy(-l, row_k + k + 1, row_i + k + 1, n - k - 1);
+        }
+    }
+
+    lu->singular = zero != n;
+    LINALG_ASSERT_ERROR(lu->singular, LINALG_ERROR, "matrix is singular(zero pivot in column %zu)!", zero);
+    return LINALG_OK;
+}
+
+// y = U^-1 L^-1 y in double
+static void la_lud_substitute(MatLUD lu, double* y)
+{
+    size_t n = lu.lu.rows;
+    const double* a = lu.lu.mat;
+    for(size_t i = 1; i < n; i++)
+    {
+        const double* row = a + i * n;
+        double val = y[i];
+        for(size_t j = 0; j < i; j++) val -= row[j] * y[j];
+        y[i] = val;
+    }
+    for(size_t i = n; i-- > 0;)
+    {
+        const double* row = a + i * n;
+        double val = y[i];
+        for(size_t j = i + 1; j < n; j++) val -= row[j] * y[j];
+        y[i] = val / row[i];
+    }
+}
+
+// d = A^-1 r through the double factors. r is scaled to max 1 first, so tiny residuals do not underflow in double
+static void la_lud_correction(MatLUD lu, const long double* r, double* y, long double* d)
+{
+    size_t n = lu.lu.rows;
+    long double scale = 0;
+    for(size_t i = 0; i < n; i++) scale = fabsl(r[i]) > scale ? fabsl(r[i]) : scale;
+    if(scale == 0)
+    {
+        for(size_t i = 0; i < n; i++) d[i] = 0;
+        return;
+    }
+    for(size_t i = 0; i < n; i++) y[i] = (double)(r[lu.perm[i]] / scale);
+    la_lud_substitute(lu, y);
+    for(size_t i = 0; i < n; i++) d[i] = scale * y[i];
+}
+
+// r = b - Ax(b NULL: r = -Ax) as if in twice the long double precision(compensated dot product, Ogita, Rump & Oishi 2005)
+// near singular systems cancel most of Ax against b, a plain long double residual would keep only its rounding error
+static void la_lud_residual(Mat2d A, const long double* b, const long double* x, long double* r)
+{
+    // Dekker split: 2^ceil(mantissa / 2) + 1
+    const long double split = ldexpl(1, (LDBL_MANT_DIG + 1) / 2) + 1;
+    size_t n = A.rows;
+    for(size_t i = 0; i < n; i++)
+    {
+        const long double* row = A.mat + i * A.ld;
+        long double sum = b ? b[i] : 0, err = 0;
+        for(size_t j = 0; j < n; j++)
+        {
+            // p + pe = -a*x exactly
+            long double a = -row[j], p = a * x[j];
+            long double ta = split * a, ah = ta - (ta - a), al = a - ah;
+            long double tx = split * x[j], xh = tx - (tx - x[j]), xl = x[j] - xh;
+            long double pe = al * xl - (((p - ah * xh) - al * xh) - ah * xl);
+            // sum + se = sum + p exactly
+            long double t = sum + p, z = t - sum;
+            long double se = (sum - (t - z)) + (p - z);
+            sum = t;
+            err += pe + se;
+        }
+        r[i] = sum + err;
+    }
+}
+
+// the left preconditioned operator of GMRES-IR, y = (LU)^-1 A x with the compensated product.
+// its residuals are well scaled even when A is near singular(right preconditioning would measure b - Ax instead)
+typedef struct LaLUDLeftOp
+{
+    MatLUD lu;
+    Mat2d A;
+    long double* x;
+    long double* ax;
+    double* y;
+} LaLUDLeftOp;
+
+static int la_lud_leftop(Vec x, Vec* y, void* ctx)
+{
+    LaLUDLeftOp* op = ctx;
+    for(size_t i = 0; i < x.len; i++) op->x[i] = LA_VIDX(x, i);
+    la_lud_residual(op->A, NULL, op->x, op->ax);
+    la_lud_correction(op->lu, op->ax, op->y, op->ax);
+    for(size_t i = 0; i < x.len; i++) LA_VIDX((*y), i) = -op->ax[i];
+    return LINALG_OK;
+}
+
+// solve Ax = b with lu = the double factors of A, refined to long double accuracy. x may be b
+// every step solves A d = b - Ax with the residual in extra precision. plain refinement(d = (LU)^-1 r) contracts by
+// about cond(A) * DBL_EPSILON per step, once it stalls(cond(A) near 1/DBL_EPSILON) d comes from GMRES in long double
+// preconditioned by the same factors(GMRES-IR, Carson & Higham 2017), which still converges up to cond(A) ~ 1/LDBL_EPSILON
+int matLUDSolveRefined(MatLUD lu, Mat2d A, Vec b, Vec* x)
+{
+    LINALG_CHECK_ERROR(!lu.lu.mat || !lu.perm, LINALG_ERROR, "LU object is null!");
+    LINALG_CHECK_ERROR(!x || !x->x, LINALG_ERROR, "result vector is null!");
+    LINALG_CHECK_ERROR(!A.mat || !b.x, LINALG_ERROR, "input is null!");
+    LINALG_CHECK_ERROR(A.rows != lu.lu.rows || A.cols != lu.lu.rows, LINALG_ERROR,
+                       "LU of size %zu refined against mat(%zux%zu)!", lu.lu.rows, A.rows, A.cols);
+    LINALG_CHECK_ERROR(b.len != lu.lu.rows || x->len != lu.lu.rows, LINALG_ERROR,
+                       "LU of size %zu solved with vec(%zu) into vec(%zu)!", lu.lu.rows, b.len, x->len);
+    LINALG_ASSERT_ERROR(lu.singular, LINALG_ERROR, "solve with a singular(or unfactored) LU!");
+    LINALG_SCAN_WARN(vecContainsNan(b), "input vector contains INF or NAN!");
+
+    size_t n = lu.lu.rows;
+    long double* work = malloc(sizeof(long double) * 7 * n);
+    double* y = malloc(sizeof(double) * n);
+    if(!work || !y)
+    {
+        free(work), free(y);
+        LINALG_REPORT_ERROR("unknown error occured when allocation memory!");
+        return LINALG_ERROR;
+    }
+    // b is copied, x may be b. mr = (LU)^-1 r, ox and ax are the GMRES-IR scratch
+    long double *bs = work, *xs = bs + n, *r = xs + n, *d = r + n, *mr = d + n, *ox = mr + n, *ax = ox + n;
+    for(size_t i = 0; i < n; i++) bs[i] = LA_VIDX(b, i);
+
+    LaLUDLeftOp leftop = {lu, A, ox, ax, y};
+    LinalgKrylovConfig config = {LA_REFINE_GMRES_TOL, LA_REFINE_GMRES_ITERS, LA_REFINE_GMRES_RESTART};
+    Vec vmr = vecConstruct(mr, n), vd = vecConstruct(d, n);
+
+    la_lud_correction(lu, bs, y, xs);
+    int converged = 0, gmres = 0;
+    long double prev = INFINITY;
+    for(size_t it = 0; it < LA_REFINE_MAX_ITERS; it++)
+    {
+        la_lud_residual(A, bs, xs, r);
+        la_lud_correction(lu, r, y, gmres ? mr : d);
+        if(gmres)
+        {
+            // plain refinement is this with the initial guess d = mr and no iterations
+            for(size_t i = 0; i < n; i++) d[i] = mr[i];
+            if(linalgGMRES((LinalgOperator){la_lud_leftop, &leftop}, (LinalgOperator){NULL, NULL}, vmr, &vd, config, NULL) != LINALG_OK) break;
+        }
+
+        long double dnorm = 0, xnorm = 0;
+        for(size_t i = 0; i < n; i++)
+        {
+            xs[i] += d[i];
+            dnorm = fabsl(d[i]) > dnorm ? fabsl(d[i]) : dnorm;
+            xnorm = fabsl(xs[i]) > xnorm ? fabsl(xs[i]) : xnorm;
+        }
+        if(dnorm <= LA_REFINE_TOL * xnorm)
+        {
+            converged = 1;
+            break;
+        }
+        if(gmres && dnorm > LA_REFINE_CONTRACTION * prev) break;
+        if(!gmres && dnorm > LA_REFINE_SLOW * prev)
+        {
+            gmres = 1;
+            dnorm = INFINITY;
+        }
+        prev = dnorm;
+    }
+
+    for(size_t i = 0; i < n; i++) LA_VIDX((*x), i) = xs[i];
+    free(work), free(y);
+    LINALG_ASSERT_WARN(!converged, LINALG_ERROR, "iterative refinement stalled, matrix too ill conditioned for a double LU!");
+    return LINALG_OK;
+}
+
+// free the LU object on the heap
+void freeMatLUD(MatLUD* lu)
+{
+    if(!lu) return;
+    freeMat2DD(&lu->lu);
+    free(lu->perm);
+    lu->perm = NULL;
+    lu->singular = 1;
+}
@@ -1,13 +1,20 @@
 #include "include/linalg.h"
+#include "src/linarg/alloc.h"
+#include "src/linarg/gemm.h"
+#include "src/linarg/norms.h"
+#include "src/linarg/parallel.h"
 
 #include <stdlib.h>
 #include <memory.h>
 #include <math.h>
 
-// LINALG_UNPACK_MAT(matrix, r, c)[x][y] = value at xth col and yth row
-#define LA_UNPACK(matrix) ((long double (*)[matrix.cols]) matrix.mat)
+// LINALG_UNPACK_MAT(matrix, r, c)[x][y] = value at xth col and yth row(rows are ld apart)
+#define LA_UNPACK(matrix) ((long double (*)[matrix.ld]) matrix.mat)
 
-#define LA_UNPACK_PTR(matrix) ((long double (*)[matrix->cols]) matrix->mat)
+#define LA_UNPACK_PTR(matrix) ((long double (*)[matrix->ld]) matrix->mat)
+
+// mat2DTransformT splits the rows over threads from this many elements on
+#define LA_TRANSFORMT_PARALLEL (1 << 18)
 
 #define LA_UNPACK_ROW(matrix, row) mat2DRow(matrix, row)
 #define LA_UNPACK_COL(matrix, col) mat2DCol(matrix, col)
@@ -15,14 +22,10 @@
 // initialzie the matrix on the heap with some initial value
 Mat2d mat2DInitA(long double value, size_t rows, size_t cols)
 {
-    if(rows == 0 || cols == 0)
-    {
-        LINALG_REPORT_ERROR("invalid zero row or col matrix requested!");
-        return (Mat2d){ NULL, 0, 0 };
-    }
-    Mat2d mat = { (long double*)calloc(rows*cols, sizeof(long double)), rows, cols };
-    LINALG_ASSERT_ERROR(!mat.mat, mat, "unkown error occured when allocation memory!");
-    for(size_t i = 0; i < mat.cols*mat.rows; i++) mat.mat[i] = value;
+    Mat2d mat = mat2DInitUninitA(rows, cols);
+    if(!mat.mat) return mat;
+    // padding included, so the buffer is written in one pass
+    for(size_t i = 0; i < mat.rows*mat.ld; i++) mat.mat[i] = value;
 
     return mat;
 }
@@ -36,6 +39,20 @@ Mat2d mat2DInitOnesA(size_t rows, size_t cols)
 {
     return mat2DInitA(1.0, rows, cols);
 }
+// allocate the matrix on the heap WITHOUT initializing it, for outputs that are fully overwritten
+Mat2d mat2DInitUninitA(size_t rows, size_t cols)
+{
+    if(rows == 0 || cols == 0)
+    {
+        LINALG_REPORT_ERROR("invalid zero row or col matrix requested!");
+        return (Mat2d){ NULL, 0, 0, 0 };
+    }
+    size_t ld = la_padded_ld(cols);
+    Mat2d mat = { la_aligned_alloc(rows * ld), rows, cols, ld };
+    LINALG_ASSERT_ERROR(!mat.mat, mat, "unkown error occured when allocation memory!");
+
+    return mat;
+}
 
 // make a copy of a matrix on heap
 Mat2d mat2DCopyA(Mat2d matrix)
@@ -43,25 +60,47 @@ Mat2d mat2DCopyA(Mat2d matrix)
     if(matrix.rows == 0 || matrix.cols == 0)
     {
         LINALG_REPORT_ERROR("invalid zero row or col matrix requested!");
-        return (Mat2d){ NULL, 0, 0 };
+        return (Mat2d){ NULL, 0, 0, 0 };
     }
     else if(matrix.mat == NULL)
     {
         LINALG_REPORT_ERROR("invalid matrix pointer(null)!");
-        return (Mat2d){ NULL, 0, 0 };
+        return (Mat2d){ NULL, 0, 0, 0 };
     }
-    Mat2d mat = { (long double*)calloc(matrix.rows*matrix.cols, sizeof(long double)), matrix.rows, matrix.cols };
-    LINALG_ASSERT_ERROR(!mat.mat, mat, "unkown error occured when allocation memory!");
-    for(size_t i = 0; i < mat.cols*mat.rows; i++) mat.mat[i] = matrix.mat[i];
+    Mat2d mat = mat2DInitUninitA(matrix.rows, matrix.cols);
+    if(!mat.mat) return mat;
+    for(size_t i = 0; i < mat.rows; i++) memcpy(&LA_UNPACK(mat)[i][0], &LA_UNPACK(matrix)[i][0], mat.cols * sizeof(long double));
     return mat;
 }
 
 // construct a matrix from a pointer(does not allocate)
 Mat2d mat2DConstruct(long double* ptr, size_t rows, size_t cols)
 {
-    Mat2d mat = { ptr, rows, cols };
+    Mat2d mat = { ptr, rows, cols, cols };
     return mat;
 }
+// construct a matrix from a pointer with rows ld values apart(does not allocate)
+Mat2d mat2DConstructStrided(long double* ptr, size_t rows, size_t cols, size_t ld)
+{
+    Mat2d bad_mat = {NULL, 0, 0, 0};
+    LINALG_CHECK_ERROR(ld < cols, bad_mat, "row stride %zu is shorter than a row(%zu)!", ld, cols);
+    Mat2d mat = { ptr, rows, cols, ld };
+    return mat;
+}
+
+// rows [row, row + rows) and cols [col, col + cols) of a matrix as a matrix(by ref, keeps the ld)
+// Warning: this is a copy by reference
+// DO NOT USE after matrix is freed
+Mat2d mat2DView(Mat2d matrix, size_t row, size_t col, size_t rows, size_t cols)
+{
+    Mat2d bad_mat = {NULL, 0, 0, 0};
+    LINALG_CHECK_ERROR(!matrix.mat, bad_mat, "input matrix is null!");
+    LINALG_CHECK_ERROR(row > matrix.rows || rows > matrix.rows - row, bad_mat, "view rows [%zu, %zu) of mat(%zux%zu)!", row, row + rows, matrix.rows, matrix.cols);
+    LINALG_CHECK_ERROR(col > matrix.cols || cols > matrix.cols - col, bad_mat, "view cols [%zu, %zu) of mat(%zux%zu)!", col, col + cols, matrix.rows, matrix.cols);
+
+    Mat2d view = { matrix.mat + row * matrix.ld + col, rows, cols, matrix.ld };
+    return view;
+}
 
 // pretty print a matrix
 void mat2DPrint(Mat2d a)
@@ -91,17 +130,19 @@ Vec mat2DRow(Mat2d matrix, size_t row)
 // DO NOT USE after matrix is freed
 Vec mat2DCol(Mat2d matrix, size_t col)
 {
-    // cols are not stored continuously in buffer, each value is stored at a offset of matrix.cols
-    Vec vcol = {&(LA_UNPACK(matrix)[0][col]), matrix.rows, matrix.cols};
+    // cols are not stored continuously in buffer, each value is stored at a offset of matrix.ld
+    Vec vcol = {&(LA_UNPACK(matrix)[0][col]), matrix.rows, matrix.ld};
     return vcol;
 }
 
+// checked accessors, below LINALG_VALIDATE_FULL they are inline functions in include/linalg.h
+#if LINALG_VALIDATION >= LINALG_VALIDATE_FULL
 // gets the nth value in a matrix(by value)
 // checks for out-of-bounds
 long double mat2DGet(Mat2d a, size_t row, size_t col)
 {
-    LINALG_ASSERT_ERROR(row >= a.rows, NAN, "out of bounds matrix row access!");
-    LINALG_ASSERT_ERROR(col >= a.cols, NAN, "out of bounds matrix col access!");
+    LINALG_CHECK_ERROR(row >= a.rows, NAN, "out of bounds matrix row access!");
+    LINALG_CHECK_ERROR(col >= a.cols, NAN, "out of bounds matrix col access!");
 
     return LA_UNPACK(a)[row][col];
 }
@@ -109,51 +150,55 @@ long double mat2DGet(Mat2d a, size_t row, size_t col)
 // checks for out-of-bounds( returns nullptr is performed )
 long double* mat2DRef(Mat2d a, size_t row, size_t col)
 {
-    LINALG_ASSERT_ERROR(row >= a.rows, NULL, "out of bounds matrix row access!");
-    LINALG_ASSERT_ERROR(col >= a.cols, NULL, "out of bounds matrix col access!");
+    LINALG_CHECK_ERROR(row >= a.rows, NULL, "out of bounds matrix row access!");
+    LINALG_CHECK_ERROR(col >= a.cols, NULL, "out of bounds matrix col access!");
 
     return &(LA_UNPACK(a)[row][col]);
 }
+#endif
 
 // add 2 matrixs and get result into another matrix, prints error if input is invalid
 int mat2DAdd(Mat2d a, Mat2d b, Mat2d* result)
 {
-    LINALG_ASSERT_ERROR(!result, LINALG_ERROR, "result matrix is null!");
-    LINALG_ASSERT_ERROR(!result->mat, LINALG_ERROR, "result matrix is null!");
-    LINALG_ASSERT_ERROR(a.rows != b.rows || b.cols != a.cols, LINALG_ERROR, "attempt to add mat(%zux%zu) and mat(%zux%zu)", a.cols, a.rows, b.cols, b.rows);
-    LINALG_ASSERT_ERROR(a.rows != result->rows || b.cols != result->cols, LINALG_ERROR, "result matrix is mat(%zux%zu) but inputs are mat(%zux%zu)", result->cols, result->rows, b.cols, b.rows);
-    LINALG_WARN_IF(mat2DContainsNan(a), "input matrix contains INF or NAN!");
-    LINALG_WARN_IF(mat2DContainsNan(b), "input matrix contains INF or NAN!");
+    LINALG_CHECK_ERROR(!result, LINALG_ERROR, "result matrix is null!");
+    LINALG_CHECK_ERROR(!result->mat, LINALG_ERROR, "result matrix is null!");
+    LINALG_CHECK_ERROR(a.rows != b.rows || b.cols != a.cols, LINALG_ERROR, "attempt to add mat(%zux%zu) and mat(%zux%zu)", a.cols, a.rows, b.cols, b.rows);
+    LINALG_CHECK_ERROR(a.rows != result->rows || b.cols != result->cols, LINALG_ERROR, "result matrix is mat(%zux%zu) but inputs are mat(%zux%zu)", result->cols, result->rows, b.cols, b.rows);
+    LINALG_SCAN_WARN(mat2DContainsNan(a), "input matrix contains INF or NAN!");
+    LINALG_SCAN_WARN(mat2DContainsNan(b), "input matrix contains INF or NAN!");
 
-    for(size_t i = 0; i < a.rows*a.cols; i++) result->mat[i] = a.mat[i] + b.mat[i];
+    for(size_t i = 0; i < a.rows; i++)
+        for(size_t j = 0; j < a.cols; j++) LA_UNPACK_PTR(result)[i][j] = LA_UNPACK(a)[i][j] + LA_UNPACK(b)[i][j];
 
     return LINALG_OK;
 }
 // subtract 2 matrixes(a-b) and get result into another matrix, prints error if input is invalid
 int mat2DSub(Mat2d a, Mat2d b, Mat2d* result)
 {
-    LINALG_ASSERT_ERROR(!result, LINALG_ERROR, "result matrix is null!");
-    LINALG_ASSERT_ERROR(!result->mat, LINALG_ERROR, "result matrix is null!");
-    LINALG_ASSERT_ERROR(a.rows != b.rows || b.cols != a.cols, LINALG_ERROR, "attempt to add mat(%zux%zu) and mat(%zux%zu)", a.cols, a.rows, b.cols, b.rows);
-    LINALG_ASSERT_ERROR(a.rows != result->rows || b.cols != result->cols, LINALG_ERROR, "result matrix is mat(%zux%zu) but inputs are mat(%zux%zu)", result->cols, result->rows, b.cols, b.rows);
-    LINALG_WARN_IF(mat2DContainsNan(a), "input matrix contains INF or NAN!");
-    LINALG_WARN_IF(mat2DContainsNan(b), "input matrix contains INF or NAN!");
+    LINALG_CHECK_ERROR(!result, LINALG_ERROR, "result matrix is null!");
+    LINALG_CHECK_ERROR(!result->mat, LINALG_ERROR, "result matrix is null!");
+    LINALG_CHECK_ERROR(a.rows != b.rows || b.cols != a.cols, LINALG_ERROR, "attempt to add mat(%zux%zu) and mat(%zux%zu)", a.cols, a.rows, b.cols, b.rows);
+    LINALG_CHECK_ERROR(a.rows != result->rows || b.cols != result->cols, LINALG_ERROR, "result matrix is mat(%zux%zu) but inputs are mat(%zux%zu)", result->cols, result->rows, b.cols, b.rows);
+    LINALG_SCAN_WARN(mat2DContainsNan(a), "input matrix contains INF or NAN!");
+    LINALG_SCAN_WARN(mat2DContainsNan(b), "input matrix contains INF or NAN!");
 
-    for(size_t i = 0; i < a.rows*a.cols; i++) result->mat[i] = a.mat[i] - b.mat[i];
+    for(size_t i = 0; i < a.rows; i++)
+        for(size_t j = 0; j < a.cols; j++) LA_UNPACK_PTR(result)[i][j] = LA_UNPACK(a)[i][j] - LA_UNPACK(b)[i][j];
 
     return LINALG_OK;
 }
 // multiply scalar value to matrixs and get result into another matrix, prints error if input is invalid
 int mat2DScale(long double a, Mat2d b, Mat2d* result)
 {
-    LINALG_ASSERT_ERROR(!result, LINALG_ERROR, "result matrix is null!");
-    LINALG_ASSERT_ERROR(!result->mat, LINALG_ERROR, "result matrix is null!");
-    LINALG_ASSERT_ERROR(b.rows != result->rows || b.cols != result->cols, LINALG_ERROR, "result matrix is mat(%zux%zu) but inputs are mat(%zux%zu)", result->cols, result->rows, b.cols, b.rows);
-    LINALG_WARN_IF(mat2DContainsNan(b), "input matrix contains INF or NAN!");
+    LINALG_CHECK_ERROR(!result, LINALG_ERROR, "result matrix is null!");
+    LINALG_CHECK_ERROR(!result->mat, LINALG_ERROR, "result matrix is null!");
+    LINALG_CHECK_ERROR(b.rows != result->rows || b.cols != result->cols, LINALG_ERROR, "result matrix is mat(%zux%zu) but inputs are mat(%zux%zu)", result->cols, result->rows, b.cols, b.rows);
+    LINALG_SCAN_WARN(mat2DContainsNan(b), "input matrix contains INF or NAN!");
 
-    for(size_t i = 0; i < b.rows*b.cols; i++) result->mat[i] = a * b.mat[i];
+    for(size_t i = 0; i < b.rows; i++)
+        for(size_t j = 0; j < b.cols; j++) LA_UNPACK_PTR(result)[i][j] = a * LA_UNPACK(b)[i][j];
 
-    LINALG_WARN_IF(mat2DContainsNan(*result), "input matrix contains INF or NAN!");
+    LINALG_SCAN_WARN(mat2DContainsNan(*result), "input matrix contains INF or NAN!");
 
     return LINALG_OK;
 }
@@ -161,18 +206,18 @@ int mat2DScale(long double a, Mat2d b, Mat2d* result)
 // compute result = Ax. prints error if the input is invalid
 int mat2DTransform(Mat2d A, Vec x, Vec* result)
 {
-    LINALG_ASSERT_ERROR(!result, LINALG_ERROR, "result matrix is null!");
-    LINALG_ASSERT_ERROR(!result->x, LINALG_ERROR, "result matrix is null!");
-    LINALG_ASSERT_ERROR(A.cols != x.len, LINALG_ERROR, "invalid vector: mat(%zux%zu) applied over vec(%zu)", A.rows, A.cols, x.len);
-    LINALG_ASSERT_ERROR(A.rows != result->len, LINALG_ERROR, "invalid vector: mat(%zux%zu) applied over vec(%zu) is put in vec(%zu)", A.rows, A.cols, x.len, result->len);
-    LINALG_WARN_IF(mat2DContainsNan(A), "input matrix contains INF or NAN!");
-    LINALG_WARN_IF(vecContainsNan(x), "input vector contains INF or NAN!");
+    LINALG_CHECK_ERROR(!result, LINALG_ERROR, "result matrix is null!");
+    LINALG_CHECK_ERROR(!result->x, LINALG_ERROR, "result matrix is null!");
+    LINALG_CHECK_ERROR(A.cols != x.len, LINALG_ERROR, "invalid vector: mat(%zux%zu) applied over vec(%zu)", A.rows, A.cols, x.len);
+    LINALG_CHECK_ERROR(A.rows != result->len, LINALG_ERROR, "invalid vector: mat(%zux%zu) applied over vec(%zu) is put in vec(%zu)", A.rows, A.cols, x.len, result->len);
+    LINALG_SCAN_WARN(mat2DContainsNan(A), "input matrix contains INF or NAN!");
+    LINALG_SCAN_WARN(vecContainsNan(x), "input vector contains INF or NAN!");
 
     for(size_t i = 0; i < A.rows; i++)
     {
         long double val = 0;
-        for(size_t j = 0; j < A.cols; j++) val += LA_UNPACK(A)[i][j] * VEC_INDEX(x, j);
-        VEC_INDEX(*result, i) = val;
+        for(size_t j = 0; j < A.cols; j++) val += LA_UNPACK(A)[i][j] * LA_VIDX(x, j);
+        LA_VIDX((*result), i) = val;
     }
 
     return LINALG_OK;
@@ -181,18 +226,102 @@ int mat2DTransform(Mat2d A, Vec x, Vec* result)
 Vec mat2DTransformA(Mat2d A, Vec x)
 {
     Vec badVec = {NULL, 0, 0};
-    LINALG_ASSERT_ERROR(A.cols != x.len, badVec, "invalid vector: mat(%zux%zu) applied over vec(%zu)", A.rows, A.cols, x.len);
-    LINALG_WARN_IF(mat2DContainsNan(A), "input matrix contains INF or NAN!");
-    LINALG_WARN_IF(vecContainsNan(x), "input vector contains INF or NAN!");
+    LINALG_CHECK_ERROR(A.cols != x.len, badVec, "invalid vector: mat(%zux%zu) applied over vec(%zu)", A.rows, A.cols, x.len);
+    LINALG_SCAN_WARN(mat2DContainsNan(A), "input matrix contains INF or NAN!");
+    LINALG_SCAN_WARN(vecContainsNan(x), "input vector contains INF or NAN!");
 
-    Vec result = vecInitZerosA(A.rows);
+    Vec result = vecInitUninitA(A.rows);
+    if(!result.x) return result;
 
     for(size_t i = 0; i < A.rows; i++)
     {
         long double val = 0;
-        for(size_t j = 0; j < A.cols; j++) val += LA_UNPACK(A)[i][j] * VEC_INDEX(x, j);
-        VEC_INDEX(result, i) = val;
+        for(size_t j = 0; j < A.cols; j++) val += LA_UNPACK(A)[i][j] * LA_VIDX(x, j);
+        LA_VIDX(result, i) = val;
+    }
+
+    return result;
+}
+
+// acc[j*inc] += sum over rows [r0, r1) of A[i][j]*x[i], sweeps A along its rows
+static void la_transformT_rows(Mat2d A, Vec x, size_t r0, size_t r1, long double* acc, size_t inc)
+{
+    for(size_t i = r0; i < r1; i++)
+    {
+        long double xi = LA_VIDX(x, i);
+        const long double* row = A.mat + i * A.ld;
+        if(inc == 1) for(size_t j = 0; j < A.cols; j++) acc[j] += xi * row[j];
+        else for(size_t j = 0; j < A.cols; j++) acc[j * inc] += xi * row[j];
+    }
+}
+
+typedef struct LaTransformTArgs
+{
+    Mat2d A;
+    Vec x;
+    size_t chunks;
+    long double* partial;
+} LaTransformTArgs;
+
+// chunks [begin, end) of the rows, each chunk sums into its own partial vector
+static void la_transformT_chunks(size_t begin, size_t end, void* ctx)
+{
+    LaTransformTArgs* args = ctx;
+    for(size_t t = begin; t < end; t++)
+    {
+        size_t r0 = args->A.rows * t / args->chunks, r1 = args->A.rows * (t + 1) / args->chunks;
+        long double* acc = args->partial + t * args->A.cols;
+        for(size_t j = 0; j < args->A.cols; j++) acc[j] = 0;
+        la_transformT_rows(args->A, args->x, r0, r1, acc, 1);
+    }
+}
+
+// compute result = A^T x without forming A^T. prints error if the input is invalid
+int mat2DTransformT(Mat2d A, Vec x, Vec* result)
+{
+    LINALG_CHECK_ERROR(!result, LINALG_ERROR, "result matrix is null!");
+    LINALG_CHECK_ERROR(!result->x, LINALG_ERROR, "result matrix is null!");
+    LINALG_CHECK_ERROR(A.rows != x.len, LINALG_ERROR, "invalid vector: mat(%zux%zu)^T applied over vec(%zu)", A.rows, A.cols, x.len);
+    LINALG_CHECK_ERROR(A.cols != result->len, LINALG_ERROR, "invalid vector: mat(%zux%zu)^T applied over vec(%zu) is put in vec(%zu)", A.rows, A.cols, x.len, result->len);
+    LINALG_CHECK_ERROR(result->x == x.x, LINALG_ERROR, "result vector can not be the input vector!");
+    LINALG_SCAN_WARN(mat2DContainsNan(A), "input matrix contains INF or NAN!");
+    LINALG_SCAN_WARN(vecContainsNan(x), "input vector contains INF or NAN!");
+
+    size_t chunks = (size_t)linalgParallelThreads();
+    if(chunks > A.rows) chunks = A.rows;
+
+    long double* partial = NULL;
+    if(chunks > 1 && A.rows * A.cols >= LA_TRANSFORMT_PARALLEL) partial = malloc(sizeof(long double) * chunks * A.cols);
+
+    if(!partial)
+    {
+        for(size_t j = 0; j < A.cols; j++) LA_VIDX((*result), j) = 0;
+        la_transformT_rows(A, x, 0, A.rows, result->x, result->offset);
+        return LINALG_OK;
+    }
+
+    // per-thread partial sums over row chunks, then reduced in chunk order
+    LaTransformTArgs args = {A, x, chunks, partial};
+    linalgParallelFor(chunks, 1, la_transformT_chunks, &args);
+    for(size_t j = 0; j < A.cols; j++)
+    {
+        long double val = 0;
+        for(size_t t = 0; t < chunks; t++) val += partial[t * A.cols + j];
+        LA_VIDX((*result), j) = val;
     }
+    free(partial);
+
+    return LINALG_OK;
+}
+// compute result = A^T x without forming A^T. prints error if the input is invalid(allocates memory)
+Vec mat2DTransformTA(Mat2d A, Vec x)
+{
+    Vec badVec = {NULL, 0, 0};
+    LINALG_CHECK_ERROR(A.rows != x.len, badVec, "invalid vector: mat(%zux%zu)^T applied over vec(%zu)", A.rows, A.cols, x.len);
+
+    Vec result = vecInitUninitA(A.cols);
+    if(!result.x) return result;
+    mat2DTransformT(A, x, &result);
 
     return result;
 }
@@ -200,57 +329,98 @@ Vec mat2DTransformA(Mat2d A, Vec x)
 // compute result = A*B. prints error if the input is invalid
 int mat2DMul(Mat2d A, Mat2d B, Mat2d* result)
 {
-    LINALG_ASSERT_ERROR(!result, LINALG_ERROR, "result matrix is null!");
-    LINALG_ASSERT_ERROR(!result->mat, LINALG_ERROR, "result matrix is null!");
-    LINALG_ASSERT_ERROR(A.cols != B.rows, LINALG_ERROR, "invalid operation: multiplication between mat(%zux%zu) and mat(%zux%zu)", A.rows, A.cols, B.rows, B.cols);
-    LINALG_ASSERT_ERROR(A.rows != result->rows || B.cols != result->cols, LINALG_ERROR, 
+    LINALG_CHECK_ERROR(!result, LINALG_ERROR, "result matrix is null!");
+    LINALG_CHECK_ERROR(!result->mat, LINALG_ERROR, "result matrix is null!");
+    LINALG_CHECK_ERROR(A.cols != B.rows, LINALG_ERROR, "invalid operation: multiplication between mat(%zux%zu) and mat(%zux%zu)", A.rows, A.cols, B.rows, B.cols);
+    LINALG_CHECK_ERROR(A.rows != result->rows || B.cols != result->cols, LINALG_ERROR, 
                         "invalid operation: multiplication between mat(%zux%zu) and mat(%zux%zu) stored in mat(%zux%zu)", A.rows, A.cols, B.rows, B.cols, result->rows, result->cols);
+    LINALG_CHECK_ERROR(result->mat == A.mat || result->mat == B.mat, LINALG_ERROR, "result matrix can not be an input matrix!");
 
-    LINALG_WARN_IF(mat2DContainsNan(A), "input matrix contains INF or NAN!");
-    LINALG_WARN_IF(mat2DContainsNan(B), "input matrix contains INF or NAN!");
+    LINALG_SCAN_WARN(mat2DContainsNan(A), "input matrix contains INF or NAN!");
+    LINALG_SCAN_WARN(mat2DContainsNan(B), "input matrix contains INF or NAN!");
 
-    for(size_t i = 0; i < A.rows; i++)
-    {
-        for(size_t j = 0; j < B.cols; j++)
-        {
-            long double res = 0;
-            for(size_t k = 0; k < B.rows; k++) res += LA_UNPACK(A)[i][k] * LA_UNPACK(B)[k][j];
-            LA_UNPACK_PTR(result)[i][j] = res;
-        }
-    }
+    linalgGemm(A.rows, B.cols, A.cols, 1, A.mat, A.ld, B.mat, B.ld, 0, result->mat, result->ld);
 
     return LINALG_OK;
 }
 // compute result = A*B(allocates memory). prints error if the input is invalid
 Mat2d mat2DMulA(Mat2d A, Mat2d B)
 {
-    Mat2d bad_mat = {NULL, 0, 0};
-    LINALG_ASSERT_ERROR(A.cols != B.rows, bad_mat, "invalid operation: multiplication between mat(%zux%zu) and mat(%zux%zu)", A.rows, A.cols, B.rows, B.cols);
-    LINALG_WARN_IF(mat2DContainsNan(A), "input matrix contains INF or NAN!");
-    LINALG_WARN_IF(mat2DContainsNan(B), "input matrix contains INF or NAN!");
+    Mat2d bad_mat = {NULL, 0, 0, 0};
+    LINALG_CHECK_ERROR(A.cols != B.rows, bad_mat, "invalid operation: multiplication between mat(%zux%zu) and mat(%zux%zu)", A.rows, A.cols, B.rows, B.cols);
+    LINALG_SCAN_WARN(mat2DContainsNan(A), "input matrix contains INF or NAN!");
+    LINALG_SCAN_WARN(mat2DContainsNan(B), "input matrix contains INF or NAN!");
 
-    Mat2d result = mat2DInitZerosA(A.rows, B.cols);
+    // beta == 0 never reads C
+    Mat2d result = mat2DInitUninitA(A.rows, B.cols);
+    if(!result.mat) return result;
 
-    for(size_t i = 0; i < A.rows; i++)
+    linalgGemm(A.rows, B.cols, A.cols, 1, A.mat, A.ld, B.mat, B.ld, 0, result.mat, result.ld);
+
+    return result;
+}
+
+// calculate result = A^k by repeated squaring(O(log k) products, A^0 = I). prints error if the input is invalid
+int mat2DSqPowU(Mat2d A, unsigned int k, Mat2d* result)
+{
+    LINALG_CHECK_ERROR(!result || !result->mat, LINALG_ERROR, "result matrix is null!");
+    LINALG_CHECK_ERROR(!A.mat, LINALG_ERROR, "input matrix is null!");
+    LINALG_CHECK_ERROR(A.rows != A.cols, LINALG_ERROR, "power of a non square mat(%zux%zu)!", A.rows, A.cols);
+    LINALG_CHECK_ERROR(result->rows != A.rows || result->cols != A.cols, LINALG_ERROR, "mat(%zux%zu)^k stored in mat(%zux%zu)", A.rows, A.cols, result->rows, result->cols);
+    LINALG_SCAN_WARN(mat2DContainsNan(A), "input matrix contains INF or NAN!");
+
+    size_t n = A.rows;
+    if(k == 0)
+    {
+        for(size_t i = 0; i < n; i++)
+            for(size_t j = 0; j < n; j++) LA_UNPACK_PTR(result)[i][j] = i == j;
+        return LINALG_OK;
+    }
+
+    // base = A^(2^i), acc collects the set bits of k. result is only written at the end, so it can be A
+    Mat2d base = mat2DCopyA(A);
+    Mat2d acc = mat2DInitUninitA(n, n);
+    Mat2d tmp = mat2DInitUninitA(n, n);
+    if(!base.mat || !acc.mat || !tmp.mat)
     {
-        for(size_t j = 0; j < B.cols; j++)
+        freeMat2D(&base), freeMat2D(&acc), freeMat2D(&tmp);
+        LINALG_REPORT_ERROR("unknown error occured when allocation memory!");
+        return LINALG_ERROR;
+    }
+
+    int have_acc = 0;
+    for(;;)
+    {
+        if(k & 1)
         {
-            long double res = 0;
-            for(size_t k = 0; k < B.rows; k++) res += LA_UNPACK(A)[i][k] * LA_UNPACK(B)[k][j];
-            LA_UNPACK(result)[i][j] = res;
+            if(!have_acc)
+                for(size_t i = 0; i < n; i++) memcpy(&LA_UNPACK(acc)[i][0], &LA_UNPACK(base)[i][0], n * sizeof(long double));
+            else
+            {
+                linalgGemm(n, n, n, 1, acc.mat, acc.ld, base.mat, base.ld, 0, tmp.mat, tmp.ld);
+                Mat2d swap = acc; acc = tmp; tmp = swap;
+            }
+            have_acc = 1;
         }
+        k >>= 1;
+        if(!k) break;
+        linalgGemm(n, n, n, 1, base.mat, base.ld, base.mat, base.ld, 0, tmp.mat, tmp.ld);
+        Mat2d swap = base; base = tmp; tmp = swap;
     }
 
-    return result;
+    for(size_t i = 0; i < n; i++) memcpy(&LA_UNPACK_PTR(result)[i][0], &LA_UNPACK(acc)[i][0], n * sizeof(long double));
+    freeMat2D(&base), freeMat2D(&acc), freeMat2D(&tmp);
+
+    return LINALG_OK;
 }
 
 // compute result = A^T. prints error if the input is invalid
 int mat2DTranspose(Mat2d A, Mat2d* result)
 {
-    LINALG_ASSERT_ERROR(!result, LINALG_ERROR, "result matrix is null!");
-    LINALG_ASSERT_ERROR(!result->mat, LINALG_ERROR, "result matrix is null!");
-    LINALG_ASSERT_ERROR(A.cols != result->rows || A.rows != result->cols, LINALG_ERROR, "invalid operation: multiplication between mat(%zux%zu) and mat(%zux%zu)", A.rows, A.cols, result->rows, result->cols);
-    LINALG_WARN_IF(mat2DContainsNan(A), "input matrix contains INF or NAN!");
+    LINALG_CHECK_ERROR(!result, LINALG_ERROR, "result matrix is null!");
+    LINALG_CHECK_ERROR(!result->mat, LINALG_ERROR, "result matrix is null!");
+    LINALG_CHECK_ERROR(A.cols != result->rows || A.rows != result->cols, LINALG_ERROR, "invalid operation: multiplication between mat(%zux%zu) and mat(%zux%zu)", A.rows, A.cols, result->rows, result->cols);
+    LINALG_SCAN_WARN(mat2DContainsNan(A), "input matrix contains INF or NAN!");
 
     for(size_t i = 0; i < A.rows; i++)
     {
@@ -266,39 +436,42 @@ int mat2DTranspose(Mat2d A, Mat2d* result)
 // maximum value in the matrix, prints error if input is invalid
 long double mat2DMax(Mat2d a)
 {
-    LINALG_ASSERT_ERROR(!a.mat, NAN, "input matrix is null!");
+    LINALG_CHECK_ERROR(!a.mat, NAN, "input matrix is null!");
     LINALG_ASSERT_WARN(a.rows*a.cols == 0, -INFINITY, "input matrix is null!");
-    LINALG_WARN_IF(mat2DContainsNan(a), "input matrix contains INF or NAN!");
+    LINALG_SCAN_WARN(mat2DContainsNan(a), "input matrix contains INF or NAN!");
 
     long double max_value = -INFINITY;
 
-    for(size_t i = 0; i < a.rows*a.cols; i++) max_value = max_value > a.mat[i] ? max_value : a.mat[i];
+    for(size_t i = 0; i < a.rows; i++)
+        for(size_t j = 0; j < a.cols; j++) max_value = max_value > LA_UNPACK(a)[i][j] ? max_value : LA_UNPACK(a)[i][j];
 
     return max_value;
 }
 // maximum abs value in the matrix, prints error if input is invalid
 long double mat2DMaxAbs(Mat2d a)
 {
-    LINALG_ASSERT_ERROR(!a.mat, NAN, "input matrix is null!");
+    LINALG_CHECK_ERROR(!a.mat, NAN, "input matrix is null!");
     LINALG_ASSERT_WARN(a.rows*a.cols == 0, -INFINITY, "input matrix is null!");
-    LINALG_WARN_IF(mat2DContainsNan(a), "input matrix contains INF or NAN!");
+    LINALG_SCAN_WARN(mat2DContainsNan(a), "input matrix contains INF or NAN!");
 
     long double max_value = -INFINITY;
 
-    for(size_t i = 0; i < a.rows*a.cols; i++) max_value = max_value > fabsl(a.mat[i]) ? max_value : fabsl(a.mat[i]);
+    for(size_t i = 0; i < a.rows; i++)
+        for(size_t j = 0; j < a.cols; j++) max_value = max_value > fabsl(LA_UNPACK(a)[i][j]) ? max_value : fabsl(LA_UNPACK(a)[i][j]);
 
     return max_value;
 }
 // minimum value in the matrix, prints error if input is invalid
 long double mat2DMin(Mat2d a)
 {
-    LINALG_ASSERT_ERROR(!a.mat, NAN, "input matrix is null!");
+    LINALG_CHECK_ERROR(!a.mat, NAN, "input matrix is null!");
     LINALG_ASSERT_WARN(a.rows*a.cols == 0, INFINITY, "input matrix is null!");
-    LINALG_WARN_IF(mat2DContainsNan(a), "input matrix contains INF or NAN!");
+    LINALG_SCAN_WARN(mat2DContainsNan(a), "input matrix contains INF or NAN!");
 
     long double min_value = INFINITY;
 
-    for(size_t i = 0; i < a.rows*a.cols; i++) min_value = min_value < a.mat[i] ? min_value : a.mat[i];
+    for(size_t i = 0; i < a.rows; i++)
+        for(size_t j = 0; j < a.cols; j++) min_value = min_value < LA_UNPACK(a)[i][j] ? min_value : LA_UNPACK(a)[i][j];
 
     return min_value;
 }
@@ -306,25 +479,42 @@ long double mat2DMin(Mat2d a)
 // returns 1 if matrix contains nan
 int mat2DContainsNan(Mat2d a)
 {
-    LINALG_ASSERT_ERROR(!a.mat, 0, "input matrix is null!");
+    LINALG_CHECK_ERROR(!a.mat, 0, "input matrix is null!");
     LINALG_ASSERT_WARN(a.rows*a.cols == 0, 0, "input matrix is null!");
 
-    for(size_t i = 0; i < a.rows*a.cols; i++)
+    for(size_t i = 0; i < a.rows; i++)
     {
-        if(isnan(a.mat[i]) || !isfinite(a.mat[i])) return 1;
+        for(size_t j = 0; j < a.cols; j++)
+        {
+            if(isnan(LA_UNPACK(a)[i][j]) || !isfinite(LA_UNPACK(a)[i][j])) return 1;
+        }
     }
 
     return 0;
 }
 
+// one pass difference norms of a against b, row by row
+LinalgDiffNorms mat2DDiffNorms(Mat2d a, Mat2d b)
+{
+    LinalgDiffNorms bad = {NAN, NAN, NAN, NAN, 1};
+    LINALG_CHECK_ERROR(!a.mat || !b.mat, bad, "input matrix is null!");
+    LINALG_CHECK_ERROR(a.rows != b.rows || a.cols != b.cols, bad, "attempt to compare mat(%zux%zu) and mat(%zux%zu)", a.rows, a.cols, b.rows, b.cols);
+
+    LaDiffAcc acc = {0, 0, 0, 0, 0};
+    for(size_t i = 0; i < a.rows; i++) la_diff_accumulate(&acc, a.mat + i * a.ld, 1, b.mat + i * b.ld, 1, a.cols);
+    return la_diff_finish(acc);
+}
+
 // free the matrix on the heap
 void freeMat2D(Mat2d* mat)
 {
     if(!mat->mat) return;
 
     free(mat->mat);
+    mat->mat = NULL;
     mat->rows = 0;
     mat->cols = 0;
+    mat->ld = 0;
 }
 
 
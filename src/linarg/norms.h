@@ -0,0 +1,68 @@
+#pragma once
+
+// internal to src/linarg, the one pass difference norms behind vecDiffNorms/mat2DDiffNorms and the matrix 1-norm
+
+#include "include/linalg.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+// running state of a difference a - b over one or more strided runs
+typedef struct LaDiffAcc
+{
+    long double max_diff;
+    long double max_ref;
+    long double sq_diff;
+    long double sq_ref;
+    size_t count;
+} LaDiffAcc;
+
+// accumulate n pairs a[i*inca], b[i*incb]. INF/NAN are not tested per element, they end up in the sums of squares
+static inline void la_diff_accumulate(LaDiffAcc* acc, const long double* a, size_t inca, const long double* b, size_t incb, size_t n)
+{
+    long double max_diff = acc->max_diff, max_ref = acc->max_ref, sq_diff = acc->sq_diff, sq_ref = acc->sq_ref;
+    for(size_t i = 0; i < n; i++)
+    {
+        long double ref = b[i * incb], d = a[i * inca] - ref;
+        long double ad = fabsl(d), ar = fabsl(ref);
+        max_diff = ad > max_diff ? ad : max_diff;
+        max_ref = ar > max_ref ? ar : max_ref;
+        sq_diff += d * d;
+        sq_ref += ref * ref;
+    }
+    acc->max_diff = max_diff, acc->max_ref = max_ref, acc->sq_diff = sq_diff, acc->sq_ref = sq_ref;
+    acc->count += n;
+}
+
+// ratio of two norms, 0/0 = 0 and x/0 = INFINITY
+static inline long double la_diff_ratio(long double num, long double den)
+{
+    if(den == 0) return num == 0 ? 0 : INFINITY;
+    return num / den;
+}
+
+static inline LinalgDiffNorms la_diff_finish(LaDiffAcc acc)
+{
+    LinalgDiffNorms norms;
+    // a NAN or INF in a or b makes a - b or b^2 non finite, overflowing squares need |x| ~ 1e2466 in long double
+    norms.nonfinite = !isfinite(acc.sq_diff) || !isfinite(acc.sq_ref);
+    norms.max_diff = acc.max_diff;
+    norms.rms_diff = acc.count ? sqrtl(acc.sq_diff / acc.count) : 0;
+    norms.rel_max = la_diff_ratio(acc.max_diff, acc.max_ref);
+    norms.rel_rms = la_diff_ratio(sqrtl(acc.sq_diff), sqrtl(acc.sq_ref));
+    if(norms.nonfinite) norms.rel_max = norms.rel_rms = NAN;
+    return norms;
+}
+
+// *norm = ||A||_1(max column sum), summed row by row. returns LINALG_ERROR if the column sums can not be allocated
+static inline int la_norm1(Mat2d A, long double* norm)
+{
+    long double* colsum = calloc(A.cols, sizeof(long double));
+    if(!colsum) return LINALG_ERROR;
+    for(size_t i = 0; i < A.rows; i++)
+        for(size_t j = 0; j < A.cols; j++) colsum[j] += fabsl(A.mat[i * A.ld + j]);
+    *norm = 0;
+    for(size_t j = 0; j < A.cols; j++) *norm = colsum[j] > *norm ? colsum[j] : *norm;
+    free(colsum);
+    return LINALG_OK;
+}
@@ -0,0 +1,21 @@
+#include "include/linalg.h"
+#include "src/linarg/parallel.h"
+
+// the linalg kernels run on the project wide pool in src/utils/threadpool.c
+
+// get the number of threads used by the parallel kernels
+int linalgParallelThreads()
+{
+    return threadPoolThreads();
+}
+
+// set the number of threads used by the parallel kernels(0 = number of cpus), returns the count actually selected
+int linalgParallelSetThreads(int threads)
+{
+    return threadPoolSetThreads(threads);
+}
+
+void linalgParallelFor(size_t n, size_t grain, LinalgRangeFn fn, void* ctx)
+{
+    parallelFor(n, grain, fn, ctx);
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+// internal to src/linarg, the public control is linalgParallelThreads/linalgParallelSetThreads in include/linalg.h
+
+#include <stddef.h>
+#include <include/threadpool.h>
+
+// body of a parallel loop, called with a half open range [begin, end) of the iteration space
+typedef ParallelRangeFn LinalgRangeFn;
+
+// split [0, n) into blocks of at least grain iterations and run fn over them on the shared pool(see include/threadpool.h),
+// the calling thread takes part. returns after all blocks are done.
+// runs fn(0, n, ctx) inline when there is only one block
+void linalgParallelFor(size_t n, size_t grain, LinalgRangeFn fn, void* ctx);
@@ -0,0 +1,30 @@
+#include "include/linalg.h"
+#include "src/linarg/simd.h"
+
+#include <stdlib.h>
+#include <memory.h>
+#include <math.h>
+
+// double and float families(VecD, Mat2dD, VecF, Mat2dF), see src/linarg/family.inc
+
+#define LA_FAMILY_T double
+#define LA_FAMILY_VEC VecD
+#define LA_FAMILY_MAT Mat2dD
+#define LA_FAMILY_VFN(name) vecD##name
+#define LA_FAMILY_MFN(name) mat2DD##name
+#define LA_FAMILY_VFREE freeVecD
+#define LA_FAMILY_MFREE freeMat2DD
+#define LA_FAMILY_FABS fabs
+#define LA_FAMILY_KERNELS linalgSimdKernelsD()
+#include "src/linarg/family.inc"
+
+#define LA_FAMILY_T float
+#define LA_FAMILY_VEC VecF
+#define LA_FAMILY_MAT Mat2dF
+#define LA_FAMILY_VFN(name) vecF##name
+#define LA_FAMILY_MFN(name) mat2DF##name
+#define LA_FAMILY_VFREE freeVecF
+#define LA_FAMILY_MFREE freeMat2DF
+#define LA_FAMILY_FABS fabsf
+#define LA_FAMILY_KERNELS linalgSimdKernelsF()
+#include "src/linarg/family.inc"
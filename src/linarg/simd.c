@@ -0,0 +1,216 @@
+#include "include/linalg.h"
+#include "src/linarg/simd.h"
+
+#include <math.h>
+
+// Contiguous kernels for the double and float families, picked at runtime from the cpu features.
+// long double has no simd on x86, Vec only gets the contiguous(non strided) loops in vector.c
+
+/*=========================*/
+// scalar fallback
+/*=========================*/
+
+#define LA_SCALAR_KERNELS(T, SUFFIX, FABS) \
+    static void la_scalar_add_##SUFFIX(const T* a, const T* b, T* result, size_t n) \
+    { for(size_t i = 0; i < n; i++) result[i] = a[i] + b[i]; } \
+    static void la_scalar_sub_##SUFFIX(const T* a, const T* b, T* result, size_t n) \
+    { for(size_t i = 0; i < n; i++) result[i] = a[i] - b[i]; } \
+    static void la_scalar_scale_##SUFFIX(T s, const T* a, T* result, size_t n) \
+    { for(size_t i = 0; i < n; i++) result[i] = s * a[i]; } \
+    static T la_scalar_dot_##SUFFIX(const T* a, const T* b, size_t n) \
+    { T result = 0; for(size_t i = 0; i < n; i++) result += a[i] * b[i]; return result; } \
+    static T la_scalar_maxAbs_##SUFFIX(const T* a, size_t n) \
+    { T result = -INFINITY; for(size_t i = 0; i < n; i++) result = result > FABS(a[i]) ? result : FABS(a[i]); return result; } \
+    static T la_scalar_sum_##SUFFIX(const T* a, size_t n) \
+    { T result = 0; for(size_t i = 0; i < n; i++) result += a[i]; return result; } \
+    static void la_scalar_axpy_##SUFFIX(T s, const T* a, T* c, size_t n) \
+    { for(size_t i = 0; i < n; i++) c[i] += s * a[i]; } \
+    static void la_scalar_mulAdd_##SUFFIX(const T* a, const T* b, T* c, size_t n) \
+    { for(size_t i = 0; i < n; i++) c[i] += a[i] * b[i]; } \
+    static void la_scalar_mulSub_##SUFFIX(const T* a, const T* b, T* c, size_t n) \
+    { for(size_t i = 0; i < n; i++) c[i] -= a[i] * b[i]; } \
+    static void la_scalar_div_##SUFFIX(const T* a, const T* b, T* result, size_t n) \
+    { for(size_t i = 0; i < n; i++) result[i] = a[i] / b[i]; }
+
+LA_SCALAR_KERNELS(double, d, fabs)
+LA_SCALAR_KERNELS(float, f, fabsf)
+
+static const LinalgSimdKernelsD la_scalar_kernels_d = {
+    la_scalar_add_d, la_scalar_sub_d, la_scalar_scale_d, la_scalar_dot_d, la_scalar_maxAbs_d, la_scalar_sum_d, la_scalar_axpy_d,
+    la_scalar_mulAdd_d, la_scalar_mulSub_d, la_scalar_div_d
+};
+static const LinalgSimdKernelsF la_scalar_kernels_f = {
+    la_scalar_add_f, la_scalar_sub_f, la_scalar_scale_f, la_scalar_dot_f, la_scalar_maxAbs_f, la_scalar_sum_f, la_scalar_axpy_f,
+    la_scalar_mulAdd_f, la_scalar_mulSub_f, la_scalar_div_f
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+#define LA_HAS_X86_SIMD 1
+#include <immintrin.h>
+
+/*=========================*/
+// AVX2
+/*=========================*/
+
+#define LA_SIMD_T double
+#define LA_SIMD_V __m256d
+#define LA_SIMD_W 4
+#define LA_SIMD_TARGET "avx2,fma"
+#define LA_SIMD_NAME(op) la_avx2_##op##_d
+#define LA_SIMD_LOADU(p) _mm256_loadu_pd(p)
+#define LA_SIMD_STOREU(p, v) _mm256_storeu_pd(p, v)
+#define LA_SIMD_SET1(x) _mm256_set1_pd(x)
+#define LA_SIMD_ZERO() _mm256_setzero_pd()
+#define LA_SIMD_ADD(a, b) _mm256_add_pd(a, b)
+#define LA_SIMD_SUB(a, b) _mm256_sub_pd(a, b)
+#define LA_SIMD_MUL(a, b) _mm256_mul_pd(a, b)
+#define LA_SIMD_FMADD(a, b, c) _mm256_fmadd_pd(a, b, c)
+#define LA_SIMD_FNMADD(a, b, c) _mm256_fnmadd_pd(a, b, c)
+#define LA_SIMD_DIV(a, b) _mm256_div_pd(a, b)
+#define LA_SIMD_MAX(a, b) _mm256_max_pd(a, b)
+#define LA_SIMD_ABS(a) _mm256_andnot_pd(_mm256_set1_pd(-0.0), a)
+#define LA_SIMD_FABS(x) fabs(x)
+#include "src/linarg/simd_kernels.inc"
+
+#define LA_SIMD_T float
+#define LA_SIMD_V __m256
+#define LA_SIMD_W 8
+#define LA_SIMD_TARGET "avx2,fma"
+#define LA_SIMD_NAME(op) la_avx2_##op##_f
+#define LA_SIMD_LOADU(p) _mm256_loadu_ps(p)
+#define LA_SIMD_STOREU(p, v) _mm256_storeu_ps(p, v)
+#define LA_SIMD_SET1(x) _mm256_set1_ps(x)
+#define LA_SIMD_ZERO() _mm256_setzero_ps()
+#define LA_SIMD_ADD(a, b) _mm256_add_ps(a, b)
+#define LA_SIMD_SUB(a, b) _mm256_sub_ps(a, b)
+#define LA_SIMD_MUL(a, b) _mm256_mul_ps(a, b)
+#define LA_SIMD_FMADD(a, b, c) _mm256_fmadd_ps(a, b, c)
+#define LA_SIMD_FNMADD(a, b, c) _mm256_fnmadd_ps(a, b, c)
+#define LA_SIMD_DIV(a, b) _mm256_div_ps(a, b)
+#define LA_SIMD_MAX(a, b) _mm256_max_ps(a, b)
+#define LA_SIMD_ABS(a) _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a)
+#define LA_SIMD_FABS(x) fabsf(x)
+#include "src/linarg/simd_kernels.inc"
+
+/*=========================*/
+// AVX-512
+/*=========================*/
+
+#define LA_SIMD_T double
+#define LA_SIMD_V __m512d
+#define LA_SIMD_W 8
+#define LA_SIMD_TARGET "avx512f"
+#define LA_SIMD_NAME(op) la_avx512_##op##_d
+#define LA_SIMD_LOADU(p) _mm512_loadu_pd(p)
+#define LA_SIMD_STOREU(p, v) _mm512_storeu_pd(p, v)
+#define LA_SIMD_SET1(x) _mm512_set1_pd(x)
+#define LA_SIMD_ZERO() _mm512_setzero_pd()
+#define LA_SIMD_ADD(a, b) _mm512_add_pd(a, b)
+#define LA_SIMD_SUB(a, b) _mm512_sub_pd(a, b)
+#define LA_SIMD_MUL(a, b) _mm512_mul_pd(a, b)
+#define LA_SIMD_FMADD(a, b, c) _mm512_fmadd_pd(a, b, c)
+#define LA_SIMD_FNMADD(a, b, c) _mm512_fnmadd_pd(a, b, c)
+#define LA_SIMD_DIV(a, b) _mm512_div_pd(a, b)
+#define LA_SIMD_MAX(a, b) _mm512_max_pd(a, b)
+#define LA_SIMD_ABS(a) _mm512_abs_pd(a)
+#define LA_SIMD_FABS(x) fabs(x)
+#include "src/linarg/simd_kernels.inc"
+
+#define LA_SIMD_T float
+#define LA_SIMD_V __m512
+#define LA_SIMD_W 16
+#define LA_SIMD_TARGET "avx512f"
+#define LA_SIMD_NAME(op) la_avx512_##op##_f
+#define LA_SIMD_LOADU(p) _mm512_loadu_ps(p)
+#define LA_SIMD_STOREU(p, v) _mm512_storeu_ps(p, v)
+#define LA_SIMD_SET1(x) _mm512_set1_ps(x)
+#define LA_SIMD_ZERO() _mm512_setzero_ps()
+#define LA_SIMD_ADD(a, b) _mm512_add_ps(a, b)
+#define LA_SIMD_SUB(a, b) _mm512_sub_ps(a, b)
+#define LA_SIMD_MUL(a, b) _mm512_mul_ps(a, b)
+#define LA_SIMD_FMADD(a, b, c) _mm512_fmadd_ps(a, b, c)
+#define LA_SIMD_FNMADD(a, b, c) _mm512_fnmadd_ps(a, b, c)
+#define LA_SIMD_DIV(a, b) _mm512_div_ps(a, b)
+#define LA_SIMD_MAX(a, b) _mm512_max_ps(a, b)
+#define LA_SIMD_ABS(a) _mm512_abs_ps(a)
+#define LA_SIMD_FABS(x) fabsf(x)
+#include "src/linarg/simd_kernels.inc"
+
+static const LinalgSimdKernelsD la_avx2_kernels_d = {
+    la_avx2_add_d, la_avx2_sub_d, la_avx2_scale_d, la_avx2_dot_d, la_avx2_maxAbs_d, la_avx2_sum_d, la_avx2_axpy_d,
+    la_avx2_mulAdd_d, la_avx2_mulSub_d, la_avx2_div_d
+};
+static const LinalgSimdKernelsF la_avx2_kernels_f = {
+    la_avx2_add_f, la_avx2_sub_f, la_avx2_scale_f, la_avx2_dot_f, la_avx2_maxAbs_f, la_avx2_sum_f, la_avx2_axpy_f,
+    la_avx2_mulAdd_f, la_avx2_mulSub_f, la_avx2_div_f
+};
+static const LinalgSimdKernelsD la_avx512_kernels_d = {
+    la_avx512_add_d, la_avx512_sub_d, la_avx512_scale_d, la_avx512_dot_d, la_avx512_maxAbs_d, la_avx512_sum_d, la_avx512_axpy_d,
+    la_avx512_mulAdd_d, la_avx512_mulSub_d, la_avx512_div_d
+};
+static const LinalgSimdKernelsF la_avx512_kernels_f = {
+    la_avx512_add_f, la_avx512_sub_f, la_avx512_scale_f, la_avx512_dot_f, la_avx512_maxAbs_f, la_avx512_sum_f, la_avx512_axpy_f,
+    la_avx512_mulAdd_f, la_avx512_mulSub_f, la_avx512_div_f
+};
+#else
+#define LA_HAS_X86_SIMD 0
+#endif
+
+/*=========================*/
+// dispatch
+/*=========================*/
+
+// -1 until the first query
+static int la_simd_level = -1;
+
+// best level the cpu supports(cpuid)
+static int linalgSimdDetect()
+{
+#if LA_HAS_X86_SIMD
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f")) return LINALG_SIMD_AVX512;
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return LINALG_SIMD_AVX2;
+#endif
+    return LINALG_SIMD_SCALAR;
+}
+
+// simd level used by the double/float kernels
+int linalgSimdLevel()
+{
+    if(la_simd_level < 0) la_simd_level = linalgSimdDetect();
+    return la_simd_level;
+}
+
+// force a simd level(i.e for testing or benchmarking), clamped to what the cpu supports
+// returns the level actually selected
+int linalgSimdSetLevel(int level)
+{
+    int supported = linalgSimdDetect();
+    if(level < LINALG_SIMD_SCALAR) level = LINALG_SIMD_SCALAR;
+    la_simd_level = level < supported ? level : supported;
+    return la_simd_level;
+}
+
+const LinalgSimdKernelsD* linalgSimdKernelsD()
+{
+    switch(linalgSimdLevel())
+    {
+#if LA_HAS_X86_SIMD
+        case LINALG_SIMD_AVX512: return &la_avx512_kernels_d;
+        case LINALG_SIMD_AVX2: return &la_avx2_kernels_d;
+#endif
+        default: return &la_scalar_kernels_d;
+    }
+}
+
+const LinalgSimdKernelsF* linalgSimdKernelsF()
+{
+    switch(linalgSimdLevel())
+    {
+#if LA_HAS_X86_SIMD
+        case LINALG_SIMD_AVX512: return &la_avx512_kernels_f;
+        case LINALG_SIMD_AVX2: return &la_avx2_kernels_f;
+#endif
+        default: return &la_scalar_kernels_f;
+    }
+}
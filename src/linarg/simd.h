@@ -0,0 +1,41 @@
+#pragma once
+
+// internal to src/linarg, the public controls are linalgSimdLevel/linalgSimdSetLevel in include/linalg.h
+
+#include <stddef.h>
+
+// contiguous(offset == 1) kernels of the double family
+typedef struct LinalgSimdKernelsD
+{
+    void (*add)(const double* a, const double* b, double* result, size_t n);
+    void (*sub)(const double* a, const double* b, double* result, size_t n);
+    void (*scale)(double s, const double* a, double* result, size_t n);
+    double (*dot)(const double* a, const double* b, size_t n);
+    double (*maxAbs)(const double* a, size_t n);
+    double (*sum)(const double* a, size_t n);
+    void (*axpy)(double s, const double* a, double* c, size_t n);             // c += s*a
+    // elementwise, used across the systems of a batch(see MatBatchD)
+    void (*mulAdd)(const double* a, const double* b, double* c, size_t n);    // c += a*b
+    void (*mulSub)(const double* a, const double* b, double* c, size_t n);    // c -= a*b
+    void (*div)(const double* a, const double* b, double* result, size_t n);
+} LinalgSimdKernelsD;
+
+// contiguous(offset == 1) kernels of the float family
+typedef struct LinalgSimdKernelsF
+{
+    void (*add)(const float* a, const float* b, float* result, size_t n);
+    void (*sub)(const float* a, const float* b, float* result, size_t n);
+    void (*scale)(float s, const float* a, float* result, size_t n);
+    float (*dot)(const float* a, const float* b, size_t n);
+    float (*maxAbs)(const float* a, size_t n);
+    float (*sum)(const float* a, size_t n);
+    void (*axpy)(float s, const float* a, float* c, size_t n);             // c += s*a
+    // elementwise, used across the systems of a batch(see MatBatchD)
+    void (*mulAdd)(const float* a, const float* b, float* c, size_t n);    // c += a*b
+    void (*mulSub)(const float* a, const float* b, float* c, size_t n);    // c -= a*b
+    void (*div)(const float* a, const float* b, float* result, size_t n);
+} LinalgSimdKernelsF;
+
+// kernel tables for the currently selected simd level
+const LinalgSimdKernelsD* linalgSimdKernelsD();
+const LinalgSimdKernelsF* linalgSimdKernelsF();
@@ -0,0 +1,329 @@
+#include "include/linalg.h"
+#include "src/linarg/alloc.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+// allocate an empty rows x cols CSR matrix with room for nnz entries(allocates memory)
+MatCSR matCSRInitA(size_t rows, size_t cols, size_t nnz)
+{
+    MatCSR A = {NULL, NULL, NULL, 0, 0, 0};
+    LINALG_ASSERT_ERROR(rows == 0 || cols == 0, A, "invalid zero row or col matrix requested!");
+
+    A.rowptr = calloc(rows + 1, sizeof(size_t));
+    // malloc(0) may return NULL, keep a valid pointer for empty matrices
+    A.val = malloc(sizeof(long double) * (nnz ? nnz : 1));
+    A.col = malloc(sizeof(size_t) * (nnz ? nnz : 1));
+    if(!A.rowptr || !A.val || !A.col)
+    {
+        freeMatCSR(&A);
+        LINALG_REPORT_ERROR("unknown error occured when allocation memory!");
+        return A;
+    }
+    A.rows = rows;
+    A.cols = cols;
+    A.nnz = nnz;
+    return A;
+}
+
+// keep the entries of a dense matrix with |a_ij| > tol(magnitude cutoff, allocates memory)
+MatCSR matCSRFromMat2DA(Mat2d A, long double tol)
+{
+    MatCSR bad = {NULL, NULL, NULL, 0, 0, 0};
+    LINALG_ASSERT_ERROR(!A.mat, bad, "input matrix is null!");
+
+    size_t nnz = 0;
+    for(size_t i = 0; i < A.rows; i++)
+        for(size_t j = 0; j < A.cols; j++) nnz += fabsl(A.mat[i * A.ld + j]) > tol;
+
+    MatCSR S = matCSRInitA(A.rows, A.cols, nnz);
+    if(!S.val) return S;
+
+    size_t k = 0;
+    for(size_t i = 0; i < A.rows; i++)
+    {
+        const long double* row = A.mat + i * A.ld;
+        for(size_t j = 0; j < A.cols; j++)
+        {
+            if(!(fabsl(row[j]) > tol)) continue;
+            S.val[k] = row[j];
+            S.col[k] = j;
+            k++;
+        }
+        S.rowptr[i + 1] = k;
+    }
+    return S;
+}
+
+typedef struct LaSortedPos
+{
+    long double pos;
+    size_t idx;
+} LaSortedPos;
+
+static int la_sorted_pos_cmp(const void* a, const void* b)
+{
+    const LaSortedPos* x = a;
+    const LaSortedPos* y = b;
+    if(x->pos != y->pos) return x->pos < y->pos ? -1 : 1;
+    return x->idx < y->idx ? -1 : (x->idx > y->idx);
+}
+
+static int la_size_cmp(const void* a, const void* b)
+{
+    size_t x = *(const size_t*)a, y = *(const size_t*)b;
+    return x < y ? -1 : (x > y);
+}
+
+// neighbours of sorted[r] within cutoff are a contiguous window of sorted, returns its bounds [lo, hi)
+static void la_distance_window(const LaSortedPos* sorted, size_t n, size_t r, long double cutoff, size_t* lo, size_t* hi)
+{
+    size_t l = r, h = r + 1;
+    while(l > 0 && sorted[r].pos - sorted[l - 1].pos <= cutoff) l--;
+    while(h < n && sorted[h].pos - sorted[r].pos <= cutoff) h++;
+    *lo = l;
+    *hi = h;
+}
+
+// n x n matrix with an entry for every pair with |pos[i] - pos[j]| <= cutoff(diagonal included), valued by entry(i, j, ctx)
+MatCSR matCSRFromDistanceA(Vec pos, long double cutoff, MatCSREntryFn entry, void* ctx)
+{
+    MatCSR bad = {NULL, NULL, NULL, 0, 0, 0};
+    LINALG_ASSERT_ERROR(!pos.x || pos.len == 0, bad, "input vector is null!");
+    LINALG_ASSERT_ERROR(!entry, bad, "entry function is null!");
+    LINALG_ASSERT_ERROR(isnan(cutoff) || cutoff < 0, bad, "invalid cutoff %Lg!", cutoff);
+
+    size_t n = pos.len;
+    LaSortedPos* sorted = malloc(sizeof(LaSortedPos) * n);
+    size_t* rank = malloc(sizeof(size_t) * n);
+    if(!sorted || !rank)
+    {
+        free(sorted), free(rank);
+        LINALG_REPORT_ERROR("unknown error occured when allocation memory!");
+        return bad;
+    }
+    for(size_t i = 0; i < n; i++) sorted[i] = (LaSortedPos){LA_VIDX(pos, i), i};
+    qsort(sorted, n, sizeof(LaSortedPos), la_sorted_pos_cmp);
+    for(size_t r = 0; r < n; r++) rank[sorted[r].idx] = r;
+
+    // count, then fill
+    size_t nnz = 0;
+    for(size_t i = 0; i < n; i++)
+    {
+        size_t lo, hi;
+        la_distance_window(sorted, n, rank[i], cutoff, &lo, &hi);
+        nnz += hi - lo;
+    }
+
+    MatCSR A = matCSRInitA(n, n, nnz);
+    if(!A.val)
+    {
+        free(sorted), free(rank);
+        return A;
+    }
+
+    size_t k = 0;
+    for(size_t i = 0; i < n; i++)
+    {
+        size_t lo, hi;
+        la_distance_window(sorted, n, rank[i], cutoff, &lo, &hi);
+        size_t start = k;
+        for(size_t r = lo; r < hi; r++) A.col[k++] = sorted[r].idx;
+        qsort(A.col + start, k - start, sizeof(size_t), la_size_cmp);
+        for(size_t q = start; q < k; q++) A.val[q] = entry(i, A.col[q], ctx);
+        A.rowptr[i + 1] = k;
+    }
+
+    free(sorted), free(rank);
+    return A;
+}
+
+// write the CSR matrix into a dense one of the same size(zeros elsewhere). prints error if the input is invalid
+int matCSRToMat2D(MatCSR A, Mat2d* result)
+{
+    LINALG_CHECK_ERROR(!result || !result->mat, LINALG_ERROR, "result matrix is null!");
+    LINALG_CHECK_ERROR(!A.rowptr, LINALG_ERROR, "input matrix is null!");
+    LINALG_CHECK_ERROR(A.rows != result->rows || A.cols != result->cols, LINALG_ERROR,
+                       "attempt to store csr(%zux%zu) in mat(%zux%zu)", A.rows, A.cols, result->rows, result->cols);
+
+    for(size_t i = 0; i < A.rows; i++)
+        for(size_t j = 0; j < A.cols; j++) result->mat[i * result->ld + j] = 0;
+    for(size_t i = 0; i < A.rows; i++)
+        for(size_t k = A.rowptr[i]; k < A.rowptr[i + 1]; k++) result->mat[i * result->ld + A.col[k]] = A.val[k];
+
+    return LINALG_OK;
+}
+
+// compute result = Ax. prints error if the input is invalid, result can not be x
+int matCSRTransform(MatCSR A, Vec x, Vec* result)
+{
+    LINALG_CHECK_ERROR(!result || !result->x, LINALG_ERROR, "result vector is null!");
+    LINALG_CHECK_ERROR(!A.rowptr || !x.x, LINALG_ERROR, "input is null!");
+    LINALG_CHECK_ERROR(A.cols != x.len, LINALG_ERROR, "invalid vector: csr(%zux%zu) applied over vec(%zu)", A.rows, A.cols, x.len);
+    LINALG_CHECK_ERROR(A.rows != result->len, LINALG_ERROR, "invalid vector: csr(%zux%zu) applied over vec(%zu) is put in vec(%zu)", A.rows, A.cols, x.len, result->len);
+    LINALG_CHECK_ERROR(result->x == x.x, LINALG_ERROR, "result vector can not be the input vector!");
+    LINALG_SCAN_WARN(vecContainsNan(x), "input vector contains INF or NAN!");
+
+    for(size_t i = 0; i < A.rows; i++)
+    {
+        long double val = 0;
+        for(size_t k = A.rowptr[i]; k < A.rowptr[i + 1]; k++) val += A.val[k] * LA_VIDX(x, A.col[k]);
+        LA_VIDX((*result), i) = val;
+    }
+
+    return LINALG_OK;
+}
+
+// compute result = A^T x. prints error if the input is invalid, result can not be x
+int matCSRTransformT(MatCSR A, Vec x, Vec* result)
+{
+    LINALG_CHECK_ERROR(!result || !result->x, LINALG_ERROR, "result vector is null!");
+    LINALG_CHECK_ERROR(!A.rowptr || !x.x, LINALG_ERROR, "input is null!");
+    LINALG_CHECK_ERROR(A.rows != x.len, LINALG_ERROR, "invalid vector: csr(%zux%zu)^T applied over vec(%zu)", A.rows, A.cols, x.len);
+    LINALG_CHECK_ERROR(A.cols != result->len, LINALG_ERROR, "invalid vector: csr(%zux%zu)^T applied over vec(%zu) is put in vec(%zu)", A.rows, A.cols, x.len, result->len);
+    LINALG_CHECK_ERROR(result->x == x.x, LINALG_ERROR, "result vector can not be the input vector!");
+    LINALG_SCAN_WARN(vecContainsNan(x), "input vector contains INF or NAN!");
+
+    // scatter every row into the result
+    for(size_t j = 0; j < A.cols; j++) LA_VIDX((*result), j) = 0;
+    for(size_t i = 0; i < A.rows; i++)
+    {
+        long double xi = LA_VIDX(x, i);
+        for(size_t k = A.rowptr[i]; k < A.rowptr[i + 1]; k++) LA_VIDX((*result), A.col[k]) += A.val[k] * xi;
+    }
+
+    return LINALG_OK;
+}
+
+// position of entry(i, i) in val, or nnz if row i has no diagonal entry
+static size_t la_csr_diag(MatCSR A, size_t i)
+{
+    for(size_t k = A.rowptr[i]; k < A.rowptr[i + 1] && A.col[k] <= i; k++)
+        if(A.col[k] == i) return k;
+    return A.nnz;
+}
+
+// inverse of the diagonal(Jacobi preconditioner, allocates memory). prints error on a missing or zero diagonal entry
+Vec matCSRJacobiA(MatCSR A)
+{
+    Vec bad = {NULL, 0, 0};
+    LINALG_ASSERT_ERROR(!A.rowptr, bad, "input matrix is null!");
+    LINALG_ASSERT_ERROR(A.rows != A.cols, bad, "diagonal of a non square csr(%zux%zu)!", A.rows, A.cols);
+
+    Vec d = vecInitUninitA(A.rows);
+    if(!d.x) return d;
+    for(size_t i = 0; i < A.rows; i++)
+    {
+        size_t k = la_csr_diag(A, i);
+        if(k == A.nnz || A.val[k] == 0)
+        {
+            freeVec(&d);
+            LINALG_REPORT_ERROR("zero diagonal entry in row %zu!", i);
+            return bad;
+        }
+        d.x[i] = 1 / A.val[k];
+    }
+    return d;
+}
+
+// incomplete LU with no fill(ILU(0)): L(unit diagonal, not stored) and U in the sparsity pattern of A(allocates memory)
+MatCSR matCSRILU0A(MatCSR A)
+{
+    MatCSR bad = {NULL, NULL, NULL, 0, 0, 0};
+    LINALG_ASSERT_ERROR(!A.rowptr, bad, "input matrix is null!");
+    LINALG_ASSERT_ERROR(A.rows != A.cols, bad, "ILU of a non square csr(%zux%zu)!", A.rows, A.cols);
+
+    size_t n = A.rows;
+    MatCSR LU = matCSRInitA(n, n, A.nnz);
+    // where each column of the current row is stored, nnz if it is not in the pattern
+    size_t* pos = malloc(sizeof(size_t) * n);
+    size_t* diag = malloc(sizeof(size_t) * n);
+    if(!LU.rowptr || !pos || !diag)
+    {
+        freeMatCSR(&LU), free(pos), free(diag);
+        LINALG_REPORT_ERROR("unknown error occured when allocation memory!");
+        return bad;
+    }
+    for(size_t i = 0; i <= n; i++) LU.rowptr[i] = A.rowptr[i];
+    for(size_t k = 0; k < A.nnz; k++) LU.val[k] = A.val[k], LU.col[k] = A.col[k];
+    for(size_t j = 0; j < n; j++) pos[j] = A.nnz;
+
+    // IKJ variant(Saad, Iterative Methods for Sparse Linear Systems 10.3), columns are sorted in every row
+    int status = LINALG_OK;
+    for(size_t i = 0; i < n && status == LINALG_OK; i++)
+    {
+        diag[i] = la_csr_diag(LU, i);
+        if(diag[i] == A.nnz)
+        {
+            LINALG_REPORT_ERROR("row %zu has no diagonal entry!", i);
+            status = LINALG_ERROR;
+            break;
+        }
+        for(size_t k = LU.rowptr[i]; k < LU.rowptr[i + 1]; k++) pos[LU.col[k]] = k;
+        for(size_t k = LU.rowptr[i]; k < diag[i]; k++)
+        {
+            size_t c = LU.col[k];
+            if(LU.val[diag[c]] == 0)
+            {
+                LINALG_REPORT_ERROR("zero pivot in row %zu!", c);
+                status = LINALG_ERROR;
+                break;
+            }
+            long double l = LU.val[k] /= LU.val[diag[c]];
+            for(size_t kk = diag[c] + 1; kk < LU.rowptr[c + 1]; kk++)
+                if(pos[LU.col[kk]] != A.nnz) LU.val[pos[LU.col[kk]]] -= l * LU.val[kk];
+        }
+        for(size_t k = LU.rowptr[i]; k < LU.rowptr[i + 1]; k++) pos[LU.col[k]] = A.nnz;
+    }
+    if(status == LINALG_OK && LU.val[diag[n - 1]] == 0)
+    {
+        LINALG_REPORT_ERROR("zero pivot in row %zu!", n - 1);
+        status = LINALG_ERROR;
+    }
+
+    free(pos), free(diag);
+    if(status != LINALG_OK)
+    {
+        freeMatCSR(&LU);
+        return bad;
+    }
+    return LU;
+}
+
+// solve LUz = r with the factors from matCSRILU0A, z may be r. prints error if the input is invalid
+int matCSRILU0Solve(MatCSR LU, Vec r, Vec* z)
+{
+    LINALG_CHECK_ERROR(!z || !z->x, LINALG_ERROR, "result vector is null!");
+    LINALG_CHECK_ERROR(!LU.rowptr || !r.x, LINALG_ERROR, "input is null!");
+    LINALG_CHECK_ERROR(r.len != LU.rows || z->len != LU.rows, LINALG_ERROR, "ILU of size %zu solved with vec(%zu) into vec(%zu)", LU.rows, r.len, z->len);
+    LINALG_SCAN_WARN(vecContainsNan(r), "input vector contains INF or NAN!");
+
+    // rows only read entries already written, so z can be r
+    for(size_t i = 0; i < LU.rows; i++)
+    {
+        long double val = LA_VIDX(r, i);
+        for(size_t k = LU.rowptr[i]; k < LU.rowptr[i + 1] && LU.col[k] < i; k++) val -= LU.val[k] * LA_VIDX((*z), LU.col[k]);
+        LA_VIDX((*z), i) = val;
+    }
+    for(size_t i = LU.rows; i-- > 0;)
+    {
+        long double val = LA_VIDX((*z), i), pivot = 0;
+        for(size_t k = LU.rowptr[i + 1]; k-- > LU.rowptr[i] && LU.col[k] >= i;)
+        {
+            if(LU.col[k] == i) pivot = LU.val[k];
+            else val -= LU.val[k] * LA_VIDX((*z), LU.col[k]);
+        }
+        LA_VIDX((*z), i) = val / pivot;
+    }
+    return LINALG_OK;
+}
+
+// free the CSR matrix on the heap
+void freeMatCSR(MatCSR* A)
+{
+    if(!A) return;
+    free(A->val);
+    free(A->col);
+    free(A->rowptr);
+    *A = (MatCSR){NULL, NULL, NULL, 0, 0, 0};
+}
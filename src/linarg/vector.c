@@ -1,19 +1,21 @@
 #include "include/linalg.h"
+#include "src/linarg/alloc.h"
+#include "src/linarg/norms.h"
 
 #include <stdlib.h>
 #include <memory.h>
 #include <math.h>
 
-// gets value at index from vector by reference(dereferenced)
-// allows for syntax like: LA_VIDX(a, 2) = 5;
-// DOES NOT CHECK FOR OUT OF BOUNDS ACCESS
-#define LA_VIDX(vector, index) *(vector.x + vector.offset * index)
-
 // gets value at index from vector(ptr) by reference(dereferenced)
 // allows for syntax like: LA_VIDX(a, 2) = 5;
 // DOES NOT CHECK FOR OUT OF BOUNDS ACCESS
 #define LA_VIDX_PTR(vector, index) *(vector->x + vector->offset * index)
 
+// true if all the given vectors are stored contiguously(offset == 1)
+// kernels use plain pointer loops in that case, strided views(i.e mat2DCol) take the LA_VIDX path
+#define LA_CONTIGUOUS2(a, b) ((a).offset == 1 && (b).offset == 1)
+#define LA_CONTIGUOUS3(a, b, c) ((a).offset == 1 && (b).offset == 1 && (c).offset == 1)
+
 // initialzie the vector on the heap with some initial value
 Vec vecInitA(long double value, size_t len)
 {
@@ -22,8 +24,8 @@ Vec vecInitA(long double value, size_t len)
         LINALG_REPORT_ERROR("invalid zero length vector requested!");
         return (Vec){ NULL, 0, 0 };
     }
-    Vec x = { (long double*)calloc(len, sizeof(long double)), len, 1 };
-    LINALG_ASSERT_ERROR(!x.x, x, "unknown error occured when allocation memory!");
+    Vec x = vecInitUninitA(len);
+    if(!x.x) return x;
     for(size_t i = 0; i < x.len; i++) x.x[i] = value;
     return x;
 }
@@ -37,6 +39,18 @@ Vec vecInitOnesA(size_t len)
 {
     return vecInitA(1.0, len);
 }
+// allocate the vector on the heap WITHOUT initializing it, for outputs that are fully overwritten
+Vec vecInitUninitA(size_t len)
+{
+    if(len == 0)
+    {
+        LINALG_REPORT_ERROR("invalid zero length vector requested!");
+        return (Vec){ NULL, 0, 0 };
+    }
+    Vec x = { la_aligned_alloc(len), len, 1 };
+    LINALG_ASSERT_ERROR(!x.x, x, "unknown error occured when allocation memory!");
+    return x;
+}
 
 // make a copy of a vector on heap
 Vec vecCopyA(Vec vector)
@@ -51,7 +65,7 @@ Vec vecCopyA(Vec vector)
         LINALG_REPORT_ERROR("invalid source pointer(null)!");
         return (Vec){ NULL, 0, 0 };
     }
-    Vec x = { (long double*)calloc(vector.len, sizeof(long double)), vector.len, 1 };
+    Vec x = { la_aligned_alloc(vector.len), vector.len, 1 };
     LINALG_ASSERT_ERROR(!x.x, x, "unkown error occured when allocation memory!");
     for(size_t i = 0; i < x.len; i++) x.x[i] = LA_VIDX(vector, i);
     return x;
@@ -64,6 +78,19 @@ Vec vecConstruct(long double* ptr, size_t len)
     return x;
 }
 
+// values [start, start + len) of a vector as a vector(by ref, keeps the offset)
+// Warning: this is a copy by reference
+// DO NOT USE after the vector is freed
+Vec vecSlice(Vec vector, size_t start, size_t len)
+{
+    Vec badVec = {NULL, 0, 0};
+    LINALG_CHECK_ERROR(!vector.x, badVec, "input vector is null!");
+    LINALG_CHECK_ERROR(start > vector.len || len > vector.len - start, badVec, "slice [%zu, %zu) of vec(%zu)!", start, start + len, vector.len);
+
+    Vec slice = { vector.x + vector.offset * start, len, vector.offset };
+    return slice;
+}
+
 // pretty print a vector
 void vecPrint(Vec a)
 {
@@ -86,13 +113,15 @@ void printVecUnits(Vec f_n, char a)
     printf("%Lg%c]\n", LA_VIDX(f_n, f_n.len - 1), a);
 }
 
+// checked accessors, below LINALG_VALIDATE_FULL they are inline functions in include/linalg.h
+#if LINALG_VALIDATION >= LINALG_VALIDATE_FULL
 // gets the nth value in a vector
 // handles buffer offsets
 // checks for out-of-bounds
 long double vecGet(Vec a, size_t n)
 {
-    LINALG_ASSERT_ERROR(n >= a.len, NAN, "out of bounds vector access!");
-    LINALG_ASSERT_WARN(isnan(*(a.x + a.offset * n)), *(a.x + a.offset * n), "accessing value which is INF or NAN!");
+    LINALG_CHECK_ERROR(n >= a.len, NAN, "out of bounds vector access!");
+    LINALG_SCAN_WARN(isnan(*(a.x + a.offset * n)), "accessing value which is INF or NAN!");
     return *(a.x + a.offset * n);
 }
 
@@ -101,21 +130,31 @@ long double vecGet(Vec a, size_t n)
 // checks for out-of-bounds
 long double* vecRef(Vec a, size_t n)
 {
-    LINALG_ASSERT_ERROR(n >= a.len, NULL, "out of bounds vector access!");
-    LINALG_ASSERT_WARN(isnan(*(a.x + a.offset * n)), (a.x + a.offset * n), "accessing value which is INF or NAN!");
+    LINALG_CHECK_ERROR(n >= a.len, NULL, "out of bounds vector access!");
+    LINALG_SCAN_WARN(isnan(*(a.x + a.offset * n)), "accessing value which is INF or NAN!");
     return (a.x + a.offset * n);
 }
+#endif
 
 // add 2 vectors and get result into another vector
 int vecAdd(Vec a, Vec b, Vec* result)
 {
-    LINALG_ASSERT_ERROR(a.len != b.len, LINALG_ERROR, "attempt to add vectors with dimension %zu and %zu!", a.len, b.len);
-    LINALG_ASSERT_ERROR(!result || !result->x, LINALG_ERROR, "result vector is null!");
-    LINALG_ASSERT_ERROR(!a.x || !b.x, LINALG_ERROR, "input vector/s is/are null!");
-    LINALG_ASSERT_ERROR(b.len < result->len, LINALG_ERROR, "output vector not big enough to store result!");
-    LINALG_ASSERT_ERROR(b.len > result->len, LINALG_ERROR, "output dimension larger than input dimension!");
-    LINALG_WARN_IF(vecContainsNan(a), "input vector contains INF or NAN!");
-    LINALG_WARN_IF(vecContainsNan(b), "input vector contains INF or NAN!");
+    LINALG_CHECK_ERROR(a.len != b.len, LINALG_ERROR, "attempt to add vectors with dimension %zu and %zu!", a.len, b.len);
+    LINALG_CHECK_ERROR(!result || !result->x, LINALG_ERROR, "result vector is null!");
+    LINALG_CHECK_ERROR(!a.x || !b.x, LINALG_ERROR, "input vector/s is/are null!");
+    LINALG_CHECK_ERROR(b.len < result->len, LINALG_ERROR, "output vector not big enough to store result!");
+    LINALG_CHECK_ERROR(b.len > result->len, LINALG_ERROR, "output dimension larger than input dimension!");
+    LINALG_SCAN_WARN(vecContainsNan(a), "input vector contains INF or NAN!");
+    LINALG_SCAN_WARN(vecContainsNan(b), "input vector contains INF or NAN!");
+
+    if(LA_CONTIGUOUS3(a, b, *result))
+    {
+        const long double* pa = a.x;
+        const long double* pb = b.x;
+        long double* pr = result->x;
+        for(size_t i = 0; i < a.len; i++) pr[i] = pa[i] + pb[i];
+        return LINALG_OK;
+    }
 
     for(size_t i = 0; i < a.len; i++)
     {
@@ -127,13 +166,22 @@ int vecAdd(Vec a, Vec b, Vec* result)
 // subtract 2 vectors(a - b) and get result into another vector, prints error if input is invalid
 int vecSub(Vec a, Vec b, Vec* result)
 {
-    LINALG_ASSERT_ERROR(a.len != b.len, LINALG_ERROR, "attempt to add vectors with dimension %zu and %zu!", a.len, b.len);
-    LINALG_ASSERT_ERROR(!result || !result->x, LINALG_ERROR, "result vector is null!");
-    LINALG_ASSERT_ERROR(!a.x || !b.x, LINALG_ERROR, "input vector/s is/are null!");
-    LINALG_ASSERT_ERROR(b.len < result->len, LINALG_ERROR, "output vector not big enough to store result!");
-    LINALG_ASSERT_ERROR(b.len > result->len, LINALG_ERROR, "output dimension larger than input dimension!");
-    LINALG_WARN_IF(vecContainsNan(a), "input vector contains INF or NAN!");
-    LINALG_WARN_IF(vecContainsNan(b), "input vector contains INF or NAN!");
+    LINALG_CHECK_ERROR(a.len != b.len, LINALG_ERROR, "attempt to add vectors with dimension %zu and %zu!", a.len, b.len);
+    LINALG_CHECK_ERROR(!result || !result->x, LINALG_ERROR, "result vector is null!");
+    LINALG_CHECK_ERROR(!a.x || !b.x, LINALG_ERROR, "input vector/s is/are null!");
+    LINALG_CHECK_ERROR(b.len < result->len, LINALG_ERROR, "output vector not big enough to store result!");
+    LINALG_CHECK_ERROR(b.len > result->len, LINALG_ERROR, "output dimension larger than input dimension!");
+    LINALG_SCAN_WARN(vecContainsNan(a), "input vector contains INF or NAN!");
+    LINALG_SCAN_WARN(vecContainsNan(b), "input vector contains INF or NAN!");
+
+    if(LA_CONTIGUOUS3(a, b, *result))
+    {
+        const long double* pa = a.x;
+        const long double* pb = b.x;
+        long double* pr = result->x;
+        for(size_t i = 0; i < a.len; i++) pr[i] = pa[i] - pb[i];
+        return LINALG_OK;
+    }
 
     for(size_t i = 0; i < a.len; i++)
     {
@@ -145,19 +193,92 @@ int vecSub(Vec a, Vec b, Vec* result)
 // multiply scalar value to vectors and get result into another vector
 int vecScale(long double a, Vec b, Vec* result)
 {
-    LINALG_ASSERT_ERROR(!result || !result->x, LINALG_ERROR, "resultant vector is null!");
-    LINALG_ASSERT_ERROR(!b.x, LINALG_ERROR, "input vector/s is/are null!");
-    LINALG_ASSERT_ERROR(b.len < result->len, LINALG_ERROR, "output vector not big enough to store result!");
-    LINALG_ASSERT_ERROR(b.len > result->len, LINALG_ERROR, "output dimension larger than input dimension!");
-    LINALG_WARN_IF(isnan(a), "input scalar is INF or NAN!");
-    LINALG_WARN_IF(vecContainsNan(b), "input vector contains INF or NAN!");
+    LINALG_CHECK_ERROR(!result || !result->x, LINALG_ERROR, "resultant vector is null!");
+    LINALG_CHECK_ERROR(!b.x, LINALG_ERROR, "input vector/s is/are null!");
+    LINALG_CHECK_ERROR(b.len < result->len, LINALG_ERROR, "output vector not big enough to store result!");
+    LINALG_CHECK_ERROR(b.len > result->len, LINALG_ERROR, "output dimension larger than input dimension!");
+    LINALG_SCAN_WARN(isnan(a), "input scalar is INF or NAN!");
+    LINALG_SCAN_WARN(vecContainsNan(b), "input vector contains INF or NAN!");
+
+    if(LA_CONTIGUOUS2(b, *result))
+    {
+        const long double* pb = b.x;
+        long double* pr = result->x;
+        for(size_t i = 0; i < b.len; i++) pr[i] = a * pb[i];
+    }
+    else
+    {
+        for(size_t i = 0; i < b.len; i++)
+        {
+            LA_VIDX_PTR(result, i) = a * LA_VIDX(b, i);
+        }
+    }
+
+    LINALG_SCAN_WARN(vecContainsNan(*result), "output vector contains INF or NAN!");
+
+    return LINALG_OK;
+}
+// compute result = y + a[0]*v[0] + ... + a[k-1]*v[k-1] in one pass
+// every element is read before result is written, so result may alias y or any v[i]
+int vecLinComb(Vec y, size_t k, const long double* a, const Vec* v, Vec* result)
+{
+    LINALG_CHECK_ERROR(!result || !result->x, LINALG_ERROR, "result vector is null!");
+    LINALG_CHECK_ERROR(!y.x, LINALG_ERROR, "input vector is null!");
+    LINALG_CHECK_ERROR(k > 0 && (!a || !v), LINALG_ERROR, "coefficients or vectors are null!");
+    LINALG_CHECK_ERROR(y.len != result->len, LINALG_ERROR, "attempt to store vec(%zu) in vec(%zu)!", y.len, result->len);
+    for(size_t j = 0; j < k; j++)
+    {
+        LINALG_CHECK_ERROR(!v[j].x, LINALG_ERROR, "input vector %zu is null!", j);
+        LINALG_CHECK_ERROR(v[j].len != y.len, LINALG_ERROR, "attempt to combine vectors with dimension %zu and %zu!", y.len, v[j].len);
+    }
+    LINALG_SCAN_WARN(vecContainsNan(y), "input vector contains INF or NAN!");
 
-    for(size_t i = 0; i < b.len; i++)
+    int contiguous = LA_CONTIGUOUS2(y, *result);
+    for(size_t j = 0; j < k; j++) contiguous = contiguous && v[j].offset == 1;
+
+    if(contiguous)
     {
-        LA_VIDX_PTR(result, i) = a * LA_VIDX(b, i);
+        for(size_t i = 0; i < y.len; i++)
+        {
+            long double acc = y.x[i];
+            for(size_t j = 0; j < k; j++) acc += a[j] * v[j].x[i];
+            result->x[i] = acc;
+        }
+        return LINALG_OK;
     }
 
-    LINALG_WARN_IF(vecContainsNan(*result), "output vector contains INF or NAN!");
+    for(size_t i = 0; i < y.len; i++)
+    {
+        long double acc = LA_VIDX(y, i);
+        for(size_t j = 0; j < k; j++) acc += a[j] * LA_VIDX(v[j], i);
+        LA_VIDX_PTR(result, i) = acc;
+    }
+
+    return LINALG_OK;
+}
+// compute y = a*x + y in place
+int vecAxpy(long double a, Vec x, Vec* y)
+{
+    return vecAxpby(a, x, 1.0L, y);
+}
+// compute y = a*x + b*y in place
+int vecAxpby(long double a, Vec x, long double b, Vec* y)
+{
+    LINALG_CHECK_ERROR(!y || !y->x, LINALG_ERROR, "result vector is null!");
+    LINALG_CHECK_ERROR(!x.x, LINALG_ERROR, "input vector is null!");
+    LINALG_CHECK_ERROR(x.len != y->len, LINALG_ERROR, "attempt to combine vectors with dimension %zu and %zu!", x.len, y->len);
+    LINALG_SCAN_WARN(isnan(a) || isnan(b), "input scalar is INF or NAN!");
+    LINALG_SCAN_WARN(vecContainsNan(x), "input vector contains INF or NAN!");
+
+    if(LA_CONTIGUOUS2(x, *y))
+    {
+        const long double* px = x.x;
+        long double* py = y->x;
+        for(size_t i = 0; i < x.len; i++) py[i] = a * px[i] + b * py[i];
+        return LINALG_OK;
+    }
+
+    for(size_t i = 0; i < x.len; i++) LA_VIDX_PTR(y, i) = a * LA_VIDX(x, i) + b * LA_VIDX_PTR(y, i);
 
     return LINALG_OK;
 }
@@ -169,13 +290,21 @@ int vecNormalize(Vec a, Vec* result)
 // get the dot product between 2 variables
 long double vecDot(Vec a, Vec b)
 {
-    LINALG_ASSERT_ERROR(a.len != b.len, NAN, "attempt to take dot product of vectors with dimension %zu and %zu!", a.len, b.len);
-    LINALG_ASSERT_ERROR(!a.x || !b.x, NAN, "input vector/s is/are null!");
-    LINALG_WARN_IF(vecContainsNan(a), "input vector contains INF or NAN!");
-    LINALG_WARN_IF(vecContainsNan(b), "input vector contains INF or NAN!");
+    LINALG_CHECK_ERROR(a.len != b.len, NAN, "attempt to take dot product of vectors with dimension %zu and %zu!", a.len, b.len);
+    LINALG_CHECK_ERROR(!a.x || !b.x, NAN, "input vector/s is/are null!");
+    LINALG_SCAN_WARN(vecContainsNan(a), "input vector contains INF or NAN!");
+    LINALG_SCAN_WARN(vecContainsNan(b), "input vector contains INF or NAN!");
 
     long double result = 0.0;
 
+    if(LA_CONTIGUOUS2(a, b))
+    {
+        const long double* pa = a.x;
+        const long double* pb = b.x;
+        for(size_t i = 0; i < a.len; i++) result += pa[i] * pb[i];
+        return result;
+    }
+
     for(size_t i = 0; i < a.len; i++)
     {
         result += LA_VIDX(a, i) * LA_VIDX(b, i);
@@ -192,9 +321,9 @@ long double vecMagnitude(Vec a)
 // for p = inf use vecMax 
 long double vecNorm(Vec a, long double p)
 {
-    LINALG_ASSERT_ERROR(!a.x, NAN, "input vector is null!");
-    LINALG_ASSERT_ERROR(p < 1, NAN, "L_p is not a valid norm for p = %Lf", p);
-    LINALG_WARN_IF(vecContainsNan(a), "input vector contains INF or NAN!");
+    LINALG_CHECK_ERROR(!a.x, NAN, "input vector is null!");
+    LINALG_CHECK_ERROR(p < 1, NAN, "L_p is not a valid norm for p = %Lf", p);
+    LINALG_SCAN_WARN(vecContainsNan(a), "input vector contains INF or NAN!");
 
     long double result = 0.0;
 
@@ -208,9 +337,9 @@ long double vecNorm(Vec a, long double p)
 // maximum value in the vector
 long double vecMax(Vec a)
 {
-    LINALG_ASSERT_ERROR(!a.x, NAN, "input vector is null!");
+    LINALG_CHECK_ERROR(!a.x, NAN, "input vector is null!");
     LINALG_ASSERT_WARN(a.len == 0, INFINITY, "max of a zero dimension vector");
-    LINALG_WARN_IF(vecContainsNan(a), "input vector contains INF or NAN!");
+    LINALG_SCAN_WARN(vecContainsNan(a), "input vector contains INF or NAN!");
 
     long double result = -INFINITY;
 
@@ -224,12 +353,19 @@ long double vecMax(Vec a)
 // maximum abs value in the vector, prints error if input is invalid
 long double vecMaxAbs(Vec a)
 {
-    LINALG_ASSERT_ERROR(!a.x, NAN, "input vector is null!");
+    LINALG_CHECK_ERROR(!a.x, NAN, "input vector is null!");
     LINALG_ASSERT_WARN(a.len == 0, INFINITY, "max of a zero dimension vector");
-    LINALG_WARN_IF(vecContainsNan(a), "input vector contains INF or NAN!");
+    LINALG_SCAN_WARN(vecContainsNan(a), "input vector contains INF or NAN!");
 
     long double result = -INFINITY;
 
+    if(a.offset == 1)
+    {
+        const long double* pa = a.x;
+        for(size_t i = 0; i < a.len; i++) result = result > fabsl(pa[i]) ? result : fabsl(pa[i]);
+        return result;
+    }
+
     for(size_t i = 0; i < a.len; i++)
     {
         result = result > fabsl(LA_VIDX(a, i)) ? result : fabsl(LA_VIDX(a, i));
@@ -240,9 +376,9 @@ long double vecMaxAbs(Vec a)
 // minimum value in the vector
 long double vecMin(Vec a)
 {
-    LINALG_ASSERT_ERROR(!a.x, NAN, "input vector is null!");
+    LINALG_CHECK_ERROR(!a.x, NAN, "input vector is null!");
     LINALG_ASSERT_WARN(a.len == 0, -INFINITY, "min of a zero dimension vector");
-    LINALG_WARN_IF(vecContainsNan(a), "input vector contains INF or NAN!");
+    LINALG_SCAN_WARN(vecContainsNan(a), "input vector contains INF or NAN!");
 
     long double result = INFINITY;
 
@@ -256,11 +392,17 @@ long double vecMin(Vec a)
 // sum all values in a vector
 long double vecSum(Vec a)
 {
-    LINALG_ASSERT_ERROR(!a.x, NAN, "input vector is null!");
+    LINALG_CHECK_ERROR(!a.x, NAN, "input vector is null!");
     LINALG_ASSERT_WARN(a.len == 0, 0, "sum of a zero dimension vector");
-    LINALG_WARN_IF(vecContainsNan(a), "input vector contains INF or NAN!");
+    LINALG_SCAN_WARN(vecContainsNan(a), "input vector contains INF or NAN!");
 
     long double result = 0;
+    if(a.offset == 1)
+    {
+        const long double* pa = a.x;
+        for(size_t i = 0; i < a.len; i++) result += pa[i];
+        return result;
+    }
     for(size_t i = 0; i < a.len; i++) result += LA_VIDX(a, i);
 
     return result;
@@ -268,9 +410,9 @@ long double vecSum(Vec a)
 // return the product of all values in a vector
 long double vecProd(Vec a)
 {
-    LINALG_ASSERT_ERROR(!a.x, NAN, "input vector is null!");
+    LINALG_CHECK_ERROR(!a.x, NAN, "input vector is null!");
     LINALG_ASSERT_WARN(a.len == 0, 1, "product of a zero dimension vector");
-    LINALG_WARN_IF(vecContainsNan(a), "input vector contains INF or NAN!");
+    LINALG_SCAN_WARN(vecContainsNan(a), "input vector contains INF or NAN!");
 
     long double result = 1;
     for(size_t i = 0; i < a.len; i++) result *= LA_VIDX(a, i);
@@ -280,9 +422,9 @@ long double vecProd(Vec a)
 // get the range of vector, i.e max - min
 long double vecRange(Vec a)
 {
-    LINALG_ASSERT_ERROR(!a.x, NAN, "input vector is null!");
+    LINALG_CHECK_ERROR(!a.x, NAN, "input vector is null!");
     LINALG_ASSERT_WARN(a.len == 0, 0, "input is a zero dimension vector");
-    LINALG_WARN_IF(vecContainsNan(a), "input vector contains INF or NAN!");
+    LINALG_SCAN_WARN(vecContainsNan(a), "input vector contains INF or NAN!");
 
     long double max_val = -INFINITY;
     long double min_val = INFINITY;
@@ -298,9 +440,9 @@ long double vecRange(Vec a)
 // get the (relative) range of vector, i.e (max - min) / min( |max|, |min| )
 long double vecRangeRelative(Vec a)
 {
-    LINALG_ASSERT_ERROR(!a.x, NAN, "input vector is null!");
+    LINALG_CHECK_ERROR(!a.x, NAN, "input vector is null!");
     LINALG_ASSERT_WARN(a.len == 0, 0, "input is a zero dimension vector");
-    LINALG_WARN_IF(vecContainsNan(a), "input vector contains INF or NAN!");
+    LINALG_SCAN_WARN(vecContainsNan(a), "input vector contains INF or NAN!");
 
     long double max_val = -INFINITY;
     long double min_val = INFINITY;
@@ -318,9 +460,9 @@ long double vecRangeRelative(Vec a)
 // get the standard deviation of the vector
 long double vecStandardDeviation(Vec a)
 {
-    LINALG_ASSERT_ERROR(!a.x, NAN, "input vector is null!");
+    LINALG_CHECK_ERROR(!a.x, NAN, "input vector is null!");
     LINALG_ASSERT_WARN(a.len == 0, 0, "checking a zero dimension vector");
-    LINALG_WARN_IF(vecContainsNan(a), "input vector contains INF or NAN!");
+    LINALG_SCAN_WARN(vecContainsNan(a), "input vector contains INF or NAN!");
 
     long double mean = vecSum(a)/(long double)a.len;
     long double dev = 0;
@@ -332,7 +474,7 @@ long double vecStandardDeviation(Vec a)
 // returns LINALG_OK if vec contains a nan
 int vecContainsNan(Vec a)
 {
-    LINALG_ASSERT_ERROR(!a.x, 0, "input vector is null!");
+    LINALG_CHECK_ERROR(!a.x, 0, "input vector is null!");
     LINALG_ASSERT_WARN(a.len == 0, 0, "checking a zero dimension vector");
 
     for(size_t i = 0; i < a.len; i++)
@@ -343,6 +485,18 @@ int vecContainsNan(Vec a)
     return 0;
 }
 
+// one pass difference norms of a against b, the NAN/INF detection is folded into the sums
+LinalgDiffNorms vecDiffNorms(Vec a, Vec b)
+{
+    LinalgDiffNorms bad = {NAN, NAN, NAN, NAN, 1};
+    LINALG_CHECK_ERROR(!a.x || !b.x, bad, "input vector/s is/are null!");
+    LINALG_CHECK_ERROR(a.len != b.len, bad, "attempt to compare vectors with dimension %zu and %zu!", a.len, b.len);
+
+    LaDiffAcc acc = {0, 0, 0, 0, 0};
+    la_diff_accumulate(&acc, a.x, a.offset, b.x, b.offset, a.len);
+    return la_diff_finish(acc);
+}
+
 // free the vector on the heap
 void freeVec(Vec* vec)
 {
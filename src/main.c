@@ -20,7 +20,7 @@ int main()
     data.params.V_0 = 0;
     data.params.V_L = 0;
 
-    Vec mesh = generateMesh(data.locs, data.params);
+    Mesh mesh = generateMesh(data.locs, data.params);
     // printNL();
     // printf("V_top = %Lg\n", data.params.V_L);
 
@@ -28,39 +28,40 @@ int main()
     PyViBase x_vi = pyviCreateParameter(&vis, "d", data.locs);
     PyViSec  f_n  = pyviCreateSection(&vis, "f_n", x_vi);
     
-    PyViBase meshvi = pyviCreateParameter(&vis, "mesh", mesh);
+    PyViBase meshvi = pyviCreateParameter(&vis, "mesh", mesh.x);
     PyViSec  V_vi   = pyviCreateSection(&vis, "Voltage", meshvi);
 
-    Mat2d R = R_en(data, mesh);
+    // the mesh and the traps are fixed, the poisson system is factored once
+    // and every solve after that goes into V(mesh) and E(trap energies)
+    PoissonSolver poisson = poissonSolverInitA(data, mesh);
+    Vec V = vecInitZerosA(mesh.x.len);
+    Vec E = vecInitZerosA(data.locs.len);
+    poissonSolverGridE(&poisson, data, &V, &E);
+
+    Mat2d R = R_en_from_E(data, E);
     Vec R1 = mat2DCol(R, 0);
     Vec R2 = mat2DCol(R, 1);
 
-    size_t dim = data.locs.len;
-
-    Mat2d E_nm = matrix_E_n(data, mesh);
+    Mat2d E_nm = matrix_E_n_from_E(E);
     Mat2d d_nm = matrix_d_nm(data);
 
     Mat2d coefficientMatrix = matrix_r_nm(data, E_nm, d_nm);
     for(size_t i = 0; i < coefficientMatrix.rows; i++) *mat2DRef(coefficientMatrix, i, i) = 0.0L;
 
-    Vec delta_fn = vecInitZerosA(dim);
-    Vec prev_fn = vecInitZerosA(dim);
-    Mat2d delta_E = mat2DInitZerosA(dim, dim);
-    Vec V;
+    Vec prev_fn;
+    Mat2d prev_E;
     long double w = 0.05L;
     for(size_t iter = 0; iter < ITER_MAX; iter++)
     {
         // set to prev iter values
         prev_fn = data.probs;
-        delta_fn = vecCopyA(prev_fn);
-        delta_E = E_nm;
+        prev_E = E_nm;
 
         // solve for fn
         data.probs = jacobianImplementationA(coefficientMatrix, R1, R2);
-        vecScale(w, data.probs, &data.probs);
-        vecScale(1L - w, prev_fn, &prev_fn);
-        vecAdd(prev_fn, data.probs, &data.probs);
-        V = poissonWrapper(data, mesh);
+        // relax: probs = w*new + (1-w)*old
+        vecAxpby(1L - w, prev_fn, w, &data.probs);
+        poissonSolverGridE(&poisson, data, &V, &E);
 
         // vecPrint(V);
         pyviSectionPush(V_vi, V);
@@ -69,13 +70,13 @@ int main()
         // vecPrint(data.probs);
         // printNL();
 
-        E_nm = matrix_E_n(data, mesh);
+        E_nm = matrix_E_n_from_E(E);
         
         // printf("\nEnergies[%zu]:", iter);
         // mat2DPrint(E_nm);
         // printNL();
 
-        R = R_en(data, mesh);
+        R = R_en_from_E(data, E);
         R1 = mat2DCol(R, 0);
         R2 = mat2DCol(R, 1);
 
@@ -97,22 +98,26 @@ int main()
         // d_m doesn't change? - - Of course it doesn't
         //d_nm = matrix_d_nm(data);
         
-        mat2DSub(delta_E, E_nm, &delta_E);
-        vecSub(delta_fn, data.probs, &delta_fn);
+        // one pass each, the nan checks included
+        LinalgDiffNorms diff_fn = vecDiffNorms(prev_fn, data.probs);
+        LinalgDiffNorms diff_E = mat2DDiffNorms(prev_E, E_nm);
+        freeMat2D(&prev_E);
 
-        long double error_fn = vecMaxAbs(delta_fn) / vecMaxAbs(data.probs);
-        long double error_E = mat2DMaxAbs(delta_E) / mat2DMaxAbs(E_nm);
+        long double error_fn = diff_fn.rel_max;
+        long double error_E = diff_E.rel_max;
 
         printf("Iteration[%4zu] Errors: Energy:%-25.17Lg Probability: %-25.3Lg\n", iter, error_E, error_fn);
+        // checkpoint: print the linalg diagnostics of this iteration(deduplicated, see include/linalg.h)
+        linalgDiagFlush();
 
         pyviSectionPush(f_n, data.probs);
 
-        if(mat2DContainsNan(E_nm))
+        if(diff_E.nonfinite)
         {
             printf("[Steady-State] Error: E_nm contains nan! Iter : %zu\n", iter);
             break;
         }
-        if(vecContainsNan(delta_fn))
+        if(diff_fn.nonfinite)
         {
             printf("[Steady-State] Error: f_n contains nan! Iter : %zu\n", iter);
             break;
@@ -155,11 +160,12 @@ int main()
         if (vecGet(timestamps, i) > vecGet(timestamps, i - 1)) slen = i;
     }
 
-    // TODO: change this temp
-    timestamps = vecConstruct(timestamps.x, slen+1);
+    // only the first slen+1 steps were filled by the solver
+    Vec t_used = vecSlice(timestamps, 0, slen+1);
+    Mat2d fn_used = mat2DView(fn_t, 0, 0, fn_t.rows, slen+1);
 
     PyVi trans_pyvi = pyviInitA("data/transient.pyvi");
-    PyViBase x_pyvi = pyviCreateParameter(&trans_pyvi, "t", timestamps);
+    PyViBase x_pyvi = pyviCreateParameter(&trans_pyvi, "t", t_used);
     
     for(size_t i = 0; i < data.probs.len; i++)
     {
@@ -167,12 +173,10 @@ int main()
         snprintf(buf, 32, "f_n[%zu]", i); // Scanf reads from buf, my guy. You need to print to it
         PyViSec f_n_pyvi = pyviCreateSection(&trans_pyvi, buf, x_pyvi);
 
-        Vec sec = mat2DRow(fn_t, i);
-        sec.len = slen+1;
-        pyviSectionPush(f_n_pyvi, sec);
+        pyviSectionPush(f_n_pyvi, mat2DRow(fn_used, i));
     }
-    V = poissonWrapper(data, mesh);
-    PyViBase meshvis = pyviCreateParameter(&trans_pyvi, "mesh", mesh);
+    poissonSolverSolve(&poisson, data, &V);
+    PyViBase meshvis = pyviCreateParameter(&trans_pyvi, "mesh", mesh.x);
     PyViSec  V_vis   = pyviCreateSection(&trans_pyvi, "Voltage", meshvis);
 
     pyviSectionPush(V_vis, V);
@@ -180,24 +184,37 @@ int main()
 
     PyVi evolve_pyvi = pyviInitA("data/transient.pyvi");
     PyViBase evol_traps_pyvi = pyviCreateParameter(&evolve_pyvi, "x-traps", data.locs);
-    PyViBase evol_mesh_pyvi = pyviCreateParameter(&evolve_pyvi, "x-mesh", mesh);
+    PyViBase evol_mesh_pyvi = pyviCreateParameter(&evolve_pyvi, "x-mesh", mesh.x);
     PyViSec f_n_evol_pyvi = pyviCreateSection(&evolve_pyvi, "f_n", evol_traps_pyvi);
     PyViSec V_evol_pyvi = pyviCreateSection(&evolve_pyvi, "V", evol_mesh_pyvi);
-
-    for(size_t i = 0; i < slen+1; i++)
+    pyviSectionReserve(f_n_evol_pyvi, fn_used.cols);
+    pyviSectionReserve(V_evol_pyvi, fn_used.cols);
+
+    // every snapshot(column of fn_used) is a right hand side of one batched solve, pushed in time order
+    Vec V_0_evol = vecInitA(data.params.V_0, fn_used.cols);
+    Vec V_L_evol = vecInitA(data.params.V_L, fn_used.cols);
+    Mat2d V_evol = mat2DInitUninitA(fn_used.cols, mesh.x.len);
+    poissonSolverSolveBatch(&poisson, fn_used, V_0_evol, V_L_evol, &V_evol);
+    for(size_t i = 0; i < fn_used.cols; i++)
     {
-        Vec sec = mat2DCol(fn_t, i);
-        pyviSectionPush(f_n_evol_pyvi, sec);
-        data.probs = sec;
-        V = poissonWrapper(data, mesh);
-        pyviSectionPush(V_evol_pyvi, V);
+        pyviSectionPush(f_n_evol_pyvi, mat2DCol(fn_used, i));
+        pyviSectionPush(V_evol_pyvi, mat2DRow(V_evol, i));
     }
+    freeMat2D(&V_evol);
+    freeVec(&V_0_evol);
+    freeVec(&V_L_evol);
 
     pyviWrite(evolve_pyvi);
 
     freePyVi(&vis);
     freePyVi(&trans_pyvi);
     freePyVi(&evolve_pyvi);
+    freeVec(&timestamps);
+    freeVec(&V);
+    freeVec(&E);
+    freePoissonSolver(&poisson);
+    freeMesh(&mesh);
+    freeMat2D(&fn_t);
 
     return 0;
     // int status = system("python3 visualise/visualise.py");
@@ -3,7 +3,7 @@
 #include<include/steadystate.h>
 #include<include/coefficients.h>
 
-Vec f(long double t, Vec y, InputData data, Vec mesh){
+Vec f(long double t, Vec y, InputData data, const PoissonSolver* poisson, LinalgArena* arena){
     // *(vecRef(function, 0)) = *vecRef(y, 2) + *vecRef(y, 1) + 2;
     // *(vecRef(function, 1)) = *vecRef(y, 2) + *vecRef(y, 0) + 3;
     // *(vecRef(function, 2)) = *vecRef(y, 0) + *vecRef(y, 1) + 7;
@@ -11,170 +11,90 @@ Vec f(long double t, Vec y, InputData data, Vec mesh){
     // define the rhs function here
     data.probs = y;
 
-    Mat2d E_nm = matrix_E_n(data, mesh);
+    // trap energies from the influence matrix, shared by R and the trap to trap rates
+    Vec E = vecInitZerosArena(arena, y.len);
+    poissonSolverTrapE(poisson, data, &E);
 
-    Mat2d R = R_en(data, mesh);
+    Mat2d R = R_en_from_E(data, E);
     Vec R1 = mat2DCol(R, 0);
     Vec R2 = mat2DCol(R, 1);
 
-    Mat2d d_nm = matrix_d_nm(data);
+    // r_nm only for pairs within R_NM_CUTOFF_DECAYS * gamma_0 of each other, 0 on the diagonal
+    MatCSR r_nm = matrix_r_nm_csr(data, E, 0);
 
-    Mat2d coefficientMatrix = matrix_r_nm(data, E_nm, d_nm);
-    for(size_t i = 0; i < coefficientMatrix.rows; i++) *mat2DRef(coefficientMatrix, i, i) = 0.0L;
+    Vec dy = vecInitZerosArena(arena, y.len);
+    masterEquationCoeffCSR(y, R1, R2, r_nm, arena, &dy);
 
-    return masterEquationCoeffA(y, R1, R2, E_nm);
+    freeMat2D(&R), freeMatCSR(&r_nm);
+    return dy;
 }
 
-rk45 rkf45_calculator(long double h, long double t_i, Vec y_i, InputData data, Vec mesh){
+rk45 rkf45_calculator(long double h, long double t_i, Vec y_i, InputData data, const PoissonSolver* poisson, LinalgArena* arena){
     size_t l = y_i.len;
 
+    // every stage input is y_i + sum(b_j * k_j), built in one pass by vecLinComb into this buffer
+    Vec stage = vecInitZerosArena(arena, l);
+
     // long double k_0 = h * f(t_i, y_i);
 
-    Vec k_0 = f(t_i, y_i, data, mesh); 
+    Vec k_0 = f(t_i, y_i, data, poisson, arena);
     vecScale(h, k_0, &k_0);
 
 
     // long double k_1 = h * f(t_i + h * 1 / 4, y_i + k_0 / 4);
 
-    Vec vec11 = vecInitZerosA(l);
-    vecScale(0.25, k_0, &vec11);
-    vecAdd(y_i, vec11, &vec11);
-    Vec k_1 = vecInitZerosA(l);
-    vecScale(h, f(t_i + h * 1.0 / 4.0, vec11, data, mesh), &k_1);
+    vecLinComb(y_i, 1, (long double[]){0.25}, (Vec[]){k_0}, &stage);
+    Vec k_1 = f(t_i + h * 1.0 / 4.0, stage, data, poisson, arena);
+    vecScale(h, k_1, &k_1);
 
 
     // long double k_2 = h * f(t_i + h * 3 / 8, y_i + k_0 * 3 / 32 + k_1 * 9 / 32);
 
-    Vec vec21 = vecInitZerosA(l);
-    vecScale(3.0 / 32.0, k_0, &vec21);
-    Vec vec22 = vecInitZerosA(l);
-    vecScale(9.0 / 32, k_1, &vec22);
-    vecAdd(y_i, vec21, &vec21);
-    vecAdd(vec21, vec22, &vec21);
-    Vec k_2 = vecInitZerosA(l);
-    vecScale(h, f(t_i + h * 3.0 / 8.0, vec21, data, mesh), &k_2);
+    vecLinComb(y_i, 2, (long double[]){3.0 / 32.0, 9.0 / 32}, (Vec[]){k_0, k_1}, &stage);
+    Vec k_2 = f(t_i + h * 3.0 / 8.0, stage, data, poisson, arena);
+    vecScale(h, k_2, &k_2);
 
 
     // long double k_3 = h * f(t_i + h * 12 / 13, y_i + k_0 * 1932 / 2197 + k_1 * (-7200) / 2197 + k_2 * 7296 / 2197);
 
-    Vec vec31 = vecInitZerosA(l);
-    vecScale(1932.0 / 2197.0, k_0, &vec31); 
-    Vec vec32 = vecInitZerosA(l);
-    vecScale((-7200.0) / 2197.0, k_1, &vec32); 
-    Vec vec33 = vecInitZerosA(l);
-    vecScale(7296.0 / 2197.0, k_2, &vec33); 
-    vecAdd(y_i, vec31, &vec31); 
-    vecAdd(vec31, vec32, &vec31); 
-    vecAdd(vec31, vec33, &vec31); 
-    Vec k_3 = vecInitZerosA(l);
-    vecScale(h, f(t_i + h * 12.0 / 13.0, vec31, data, mesh), &k_3);
+    vecLinComb(y_i, 3, (long double[]){1932.0 / 2197.0, (-7200.0) / 2197.0, 7296.0 / 2197.0}, (Vec[]){k_0, k_1, k_2}, &stage);
+    Vec k_3 = f(t_i + h * 12.0 / 13.0, stage, data, poisson, arena);
+    vecScale(h, k_3, &k_3);
 
 
     // long double k_4 = h * f(t_i + h, y_i + k_0 * 439 / 216 + k_1 * (-8) + k_2 * 3680 / 513 + k_3 * (-845) / 4104);
 
-    Vec vec41 = vecInitZerosA(l);
-    vecScale(439.0 / 216.0, k_0, &vec41);
-    Vec vec42 = vecInitZerosA(l);
-    vecScale(-8.0, k_1, &vec42);
-    Vec vec43 = vecInitZerosA(l);
-    vecScale(3680.0 / 513.0, k_2, &vec43);
-    Vec vec44 = vecInitZerosA(l);
-    vecScale((-845.0) / 4104.0, k_3, &vec44);
-    vecAdd(y_i, vec41, &vec41);
-    vecAdd(vec41, vec42, &vec41);
-    vecAdd(vec41, vec43, &vec41);
-    vecAdd(vec41, vec44, &vec41);
-    Vec k_4 = vecInitZerosA(l);
-    vecScale(h, f(t_i + h, vec41, data, mesh), &k_4);
-
+    vecLinComb(y_i, 4, (long double[]){439.0 / 216.0, -8.0, 3680.0 / 513.0, (-845.0) / 4104.0}, (Vec[]){k_0, k_1, k_2, k_3}, &stage);
+    Vec k_4 = f(t_i + h, stage, data, poisson, arena);
+    vecScale(h, k_4, &k_4);
 
 
     // long double k_5 = h * f(t_i + h * 1 / 2, y_i + k_0 * (-8) / 27 + k_1 * 2 + k_2 * (-3544) / 2565 + k_3 * 1859 / 4104 + k_4 * (-11) / 40);
 
-    Vec vec51 = vecInitZerosA(l);
-    vecScale(-8.0 / 27.0, k_0, &vec51);
-    Vec vec52 = vecInitZerosA(l);
-    vecScale(2, k_1, &vec52);
-    Vec vec53 = vecInitZerosA(l);
-    vecScale(-3544.0 / 2565, k_2, &vec53);
-    Vec vec54 = vecInitZerosA(l);
-    vecScale(1859.0 / 4104.0, k_3, &vec54);
-    Vec vec55 = vecInitZerosA(l);
-    vecScale(-11.0 / 40.0, k_4, &vec55);
-    vecAdd(vec51, y_i, &vec51);
-    vecAdd(vec51, vec52, &vec51);
-    vecAdd(vec51, vec53, &vec51);
-    vecAdd(vec51, vec54, &vec51);
-    vecAdd(vec51, vec55, &vec51);
-    Vec k_5 = vecInitZerosA(l);
-    vecScale(h, f(t_i + h * 0.5, vec51, data, mesh), &k_5);
+    vecLinComb(y_i, 5, (long double[]){-8.0 / 27.0, 2, -3544.0 / 2565, 1859.0 / 4104.0, -11.0 / 40.0}, (Vec[]){k_0, k_1, k_2, k_3, k_4}, &stage);
+    Vec k_5 = f(t_i + h * 0.5, stage, data, poisson, arena);
+    vecScale(h, k_5, &k_5);
 
 
     // long double y_order4 = y_i + k_0 * 25 / 216 + k_2 * 1408 / 2565 + k_3 * 2197 / 4104 + k_4 * (-1) / 5;
 
-    Vec y_4_1 = vecInitZerosA(l);
-    vecScale(25.0 / 216.0, k_0, &y_4_1);
-    Vec y_4_2 = vecInitZerosA(l);
-    vecScale(1408.0 / 2565.0, k_2, &y_4_2);
-    Vec y_4_3 = vecInitZerosA(l);
-    vecScale(2197.0 / 4104.0, k_3, &y_4_3);
-    Vec y_4_4 = vecInitZerosA(l);
-    vecScale(-0.2, k_4, &y_4_4);
-    vecAdd(y_4_1, y_i, &y_4_1);
-    vecAdd(y_4_1, y_4_2, &y_4_1);
-    vecAdd(y_4_1, y_4_3, &y_4_1);
-    vecAdd(y_4_1, y_4_4, &y_4_1);
+    Vec y_4 = vecInitZerosArena(arena, l);
+    vecLinComb(y_i, 4, (long double[]){25.0 / 216.0, 1408.0 / 2565.0, 2197.0 / 4104.0, -0.2}, (Vec[]){k_0, k_2, k_3, k_4}, &y_4);
 
 
     // long double y_order5 = y_i + k_0 * 16 / 135 + k_2 * 6656 / 12825 + k_3 * 28561 / 56430 + k_4 * (-9) / 50 + k_5 * 2 / 55;
 
+    Vec y_5 = vecInitZerosArena(arena, l);
+    vecLinComb(y_i, 5, (long double[]){16.0 / 135.0, 6656.0 / 12825.0, 28561.0 / 56430.0, -0.18, 2.0 / 55.0}, (Vec[]){k_0, k_2, k_3, k_4, k_5}, &y_5);
 
-    Vec y_5_1 = vecInitZerosA(l);
-    vecScale(16.0 / 135.0, k_0, &y_5_1);
-    Vec y_5_2 = vecInitZerosA(l);
-    vecScale(6656.0 / 12825.0, k_2, &y_5_2);
-    Vec y_5_3 = vecInitZerosA(l);
-    vecScale(28561.0 / 56430.0, k_3, &y_5_3);
-    Vec y_5_4 = vecInitZerosA(l);
-    vecScale(-0.18, k_4, &y_5_4);
-    Vec y_5_5 = vecInitZerosA(l);
-    vecScale(2.0 / 55.0, k_5, &y_5_5);
-    vecAdd(y_5_1, y_i, &y_5_1);
-    vecAdd(y_5_1, y_5_2, &y_5_1);
-    vecAdd(y_5_1, y_5_3, &y_5_1);
-    vecAdd(y_5_1, y_5_4, &y_5_1);
-    vecAdd(y_5_1, y_5_5, &y_5_1);
-
-    Vec error = vecInitZerosA(l);
-    vecSub(y_5_1, y_4_1, &error);
+    Vec error = vecInitZerosArena(arena, l);
+    vecSub(y_5, y_4, &error);
     for(size_t i = 0; i < l; i++){
         VEC_INDEX(error, i) = fabsl(VEC_INDEX(error, i));
     }
 
-    freeVec(&vec11);
-    freeVec(&vec21);
-    freeVec(&vec22);
-    freeVec(&vec31);
-    freeVec(&vec32);
-    freeVec(&vec33);
-    freeVec(&vec41);
-    freeVec(&vec42);
-    freeVec(&vec43);
-    freeVec(&vec44);
-    freeVec(&vec51);
-    freeVec(&vec52);
-    freeVec(&vec53);
-    freeVec(&vec54);
-    freeVec(&vec55);
-    freeVec(&y_4_2);
-    freeVec(&y_4_3);
-    freeVec(&y_4_4);
-    freeVec(&y_5_2);
-    freeVec(&y_5_3);
-    freeVec(&y_5_4);
-    freeVec(&y_5_5);
     rk45 res;
-    res.y_5 = y_5_1;
+    res.y_5 = y_5;
     res.err = error;
     return res;
 }
@@ -197,13 +117,22 @@ void solver(RK45Config config, Vec t_res, Mat2d res){
     }
 
 
+    // all the vectors of a step live in this arena, released in one go at the end of the step
+    // (the trap sized temporaries plus the trap energies of each stage)
+    LinalgArena arena = linalgArenaInitA((RK45_STEP_TEMPS + RK45_STAGES) * (l * sizeof(long double) + 64));
+    // the mesh does not change, factor the poisson system once and build the influence matrix,
+    // so a stage gets its trap energies from one mat-vec
+    PoissonSolver poisson = poissonSolverInitA(config.data, config.mesh);
+    poissonSolverInfluence(&poisson);
+
     size_t n = 0;
     while (VEC_INDEX(t_res, n) < t_final && n < N - 2){
         h = fmin(h, t_final - VEC_INDEX(t_res, n));
 
         Vec y = mat2DCol(res, n);
 
-        rk45 tuple = rkf45_calculator(h, VEC_INDEX(t_res, n), y, config.data, config.mesh);
+        LinalgArenaMark mark = linalgArenaPush(&arena);
+        rk45 tuple = rkf45_calculator(h, VEC_INDEX(t_res, n), y, config.data, &poisson, &arena);
         Vec y5 = tuple.y_5;
         Vec error = tuple.err;
 
@@ -220,5 +149,8 @@ void solver(RK45Config config, Vec t_res, Mat2d res){
         }
 
         h *= 0.9 * fmax(0.5, fmin(2, 0.9 * pow((tol / errmax), 1.0 / 5)));
+        linalgArenaPop(&arena, mark);
     }
+    freeLinalgArena(&arena);
+    freePoissonSolver(&poisson);
 }
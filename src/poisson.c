@@ -1,5 +1,6 @@
 #include <include/linalg.h>
 #include <include/poisson.h>
+#include <include/threadpool.h>
 
 long double analyticalPoissonSol(const Vec f_n, const Vec d, long double x)
 {
@@ -123,9 +124,13 @@ Vec getGridE(Vec f_n, Vec d, OxParams params)
                             Numerical Poisson Solver                         
 ================================================================================*/
 
-void stackToVec(DynStack* mesh, Vec *mesh_vec)
+void stackToVec(DynStack* dstack, Vec *vec)
 {
-    mesh_vec->x = (long double *)mesh->data;
+    // the vector takes over the stack buffer, no copy
+    size_t len = 0;
+    vec->x = dynStackDetach(dstack, &len);
+    vec->len = len;
+    vec->offset = 1;
 }
 
 int validateVec(const Vec d, const OxParams params)
@@ -143,23 +148,35 @@ int validateVec(const Vec d, const OxParams params)
     return 1;
 }
 
-Vec generateMesh(Vec d, OxParams oxparams)
+Mesh generateMesh(Vec d, OxParams oxparams)
 {
+    Mesh result = {{NULL, 0, 0}, NULL, NULL, 0};
     // Check Input 
     size_t chunk_size = oxparams.chunk_size ; 
-    if (!validateVec(d, oxparams))
+    if (!validateVec(d, oxparams) || chunk_size == 0)
     {
         printf("Input Invalid.\n");
-        return (Vec){NULL, 0, 0};
+        return result;
+    }
+    // 0, every trap and L, recorded as they are pushed
+    size_t* bound = malloc(sizeof(size_t) * (d.len + 2));
+    if (!bound)
+    {
+        printf("Allocation Failure!\n");
+        return result;
     }
     long double eps_dist = 1e-12;
     DynStack mesh = dynStackInit(sizeof(long double));
     long double mesh_point = 0;
+
+    // chunk_size points before every trap and after the last one, plus L: the only allocation of the mesh
+    dynStackReserve(&mesh, chunk_size * (d.len + 1) + 1);
     
     // Piecewise mesh creation. Adds all points to the mesh
 
     long double d_0 = d.x[0];
     // from 0 to d[0]
+    bound[0] = mesh.len;
     for(size_t i = 0; i < chunk_size; i++)
     {
         mesh_point = (long double)(i * d_0) / chunk_size; 
@@ -171,6 +188,8 @@ Vec generateMesh(Vec d, OxParams oxparams)
     for (size_t i = 0; i < d.len - 1; i++)
     {
         long double d_i = fabsl(d.x[i] - d.x[i + 1]);
+        // the first point of the chunk is d[i]
+        bound[i + 1] = mesh.len;
         for (size_t j = 0; j < chunk_size; j++)
         {
             mesh_point = d.x[i] + (long double)(j * d_i) / chunk_size;
@@ -186,6 +205,7 @@ Vec generateMesh(Vec d, OxParams oxparams)
     // mesh_point = d_n - eps_dist;
     // dynStackPush(&mesh, &mesh_point);
 
+    bound[d.len] = mesh.len;
     for(size_t i = 0; i < chunk_size; i++)
     {
         mesh_point = d.x[d.len - 1] + (long double)(i * d_n) / chunk_size; 
@@ -196,17 +216,28 @@ Vec generateMesh(Vec d, OxParams oxparams)
 
     // Last point
     mesh_point = oxparams.L;
+    bound[d.len + 1] = mesh.len;
     dynStackPush(&mesh, &mesh_point);
 
     // for (size_t i = 0; i < mesh.len; i ++)
     // {
     //     printf("%Lg\n", *(long double *)dynStackGet(mesh, i));
     // }
-    Vec mesh_vec = vecInitZerosA(mesh.len);
-    stackToVec(&mesh, &mesh_vec);
-    // freeDynStack(&mesh);
+    stackToVec(&mesh, &result.x);
+    result.bound = bound;
+    result.trap = bound + 1;
+    result.traps = d.len;
+
+    return result;
+}
 
-    return mesh_vec;
+void freeMesh(Mesh* mesh)
+{
+    freeVec(&mesh->x);
+    free(mesh->bound);
+    mesh->bound = NULL;
+    mesh->trap = NULL;
+    mesh->traps = 0;
 }
 
 Vec generateStepSize(Vec mesh_vec)
@@ -254,29 +285,27 @@ MatTD generateJacobian(Vec mesh)
     return jcob;
 }
 
-Vec constructB(Vec f_n, Vec d, Vec mesh, size_t chunk, OxParams params)
+Vec constructB(Vec f_n, Mesh mesh, OxParams params)
 {
-    Vec b = vecInitZerosA(mesh.len);
-    size_t idx = 0;
+    if (f_n.len != mesh.traps || !mesh.trap)
+    {
+        printf("Input Invalid.\n");
+        return (Vec){NULL, 0, 0};
+    }
+    Vec b = vecInitZerosA(mesh.x.len);
 
-    // vecPrint(mesh);
-    // printNL();
-    // vecPrint(d);
+    // vecPrint(mesh.x);
     // printNL();
     // vecPrint(f_n);
     // printNL();
 
     *vecRef(b, 0) = params.V_0;
-    for (size_t i = 0; i < mesh.len; i ++)
+    for (size_t n = 0; n < f_n.len; n ++)
     {
-        idx = i / chunk - 1;
-        if (idx > d.len - 1) continue;
-
-        long double diff = (vecGet(mesh, i + 1) - vecGet(mesh, i - 1)) / 2;
-
-        long double entry = vecGet(f_n, idx) * Q / ((params.eps_r * EPS0) * powl(diff, 3));
+        size_t i = mesh.trap[n];
+        long double diff = (vecGet(mesh.x, i + 1) - vecGet(mesh.x, i - 1)) / 2;
 
-        if ((vecGet(d, idx) - vecGet(mesh, i)) == 0) *vecRef(b, i) = entry;
+        *vecRef(b, i) = vecGet(f_n, n) * Q / ((params.eps_r * EPS0) * powl(diff, 3));
     }
     *vecRef(b, b.len - 1) = params.V_L; 
     // printNL();
@@ -321,11 +350,12 @@ Vec numSolveV(MatTD mat, Vec b)
     return sol;
 }
 
-Vec poissonWrapper(InputData data, Vec mesh)
+Vec poissonWrapper(InputData data, Mesh mesh)
 {
-    MatTD jcob = generateJacobian(mesh);
+    Vec b = constructB(data.probs, mesh, data.params);
+    if (!b.x) return b;
 
-    Vec b = constructB(data.probs, data.locs, mesh, data.params.chunk_size, data.params);
+    MatTD jcob = generateJacobian(mesh.x);
 
     Vec sol = numSolveV(jcob, b);
 
@@ -337,25 +367,21 @@ Vec poissonWrapper(InputData data, Vec mesh)
     return sol;
 }
 
-Vec getGridNumV(InputData data, Vec mesh)
+Vec getGridNumV(InputData data, Mesh mesh)
 {
     Vec numSol = poissonWrapper(data, mesh);
-    Vec gridV = vecInitA(0, data.locs.len);
+    if (!numSol.x) return numSol;
+    Vec gridV = vecInitA(0, mesh.traps);
     if (!gridV.x) printf("Allocation Failure!\n");
-    size_t idx = 0;
-    for (size_t i = 0; i < mesh.len; i ++)
-    {
-        idx = i / data.params.chunk_size - 1;
-        if (idx > data.locs.len - 1) continue;
-        if ((vecGet(data.locs, idx) - vecGet(mesh, i)) == 0) *vecRef(gridV, idx) = vecGet(numSol, i);
-    }
+    else for (size_t n = 0; n < mesh.traps; n ++) *vecRef(gridV, n) = vecGet(numSol, mesh.trap[n]);
     freeVec(&numSol);
     return gridV;
 }
 
-Vec getGridNumE(InputData data, Vec mesh)
+Vec getGridNumE(InputData data, Mesh mesh)
 {
     Vec gridV = getGridNumV(data, mesh);
+    if (!gridV.x) return gridV;
     Vec Et = vecInitA(0, gridV.len);
     
     for(size_t i = 0; i < gridV.len; i++)
@@ -368,6 +394,329 @@ Vec getGridNumE(InputData data, Vec mesh)
 
     return Et;
 }
+PoissonSolver poissonSolverInitA(InputData data, Mesh mesh)
+{
+    PoissonSolver solver = {mesh, {NULL, 0, 0}, {NULL, 0, 0}, {NULL, 0, 0}, {NULL, 0, 0},
+                            {NULL, 0, 0, 0}, {NULL, 0, 0}, {NULL, 0, 0}};
+    if (mesh.x.len < 3 || !mesh.trap || data.locs.len != mesh.traps)
+    {
+        printf("Input Invalid.\n");
+        return solver;
+    }
+
+    // b scale of every trap, same as constructB
+    solver.scale = vecInitA(1, mesh.traps);
+    if (!solver.scale.x)
+    {
+        printf("Allocation Failure!\n");
+        return solver;
+    }
+    for (size_t n = 0; n < mesh.traps; n ++)
+    {
+        size_t i = mesh.trap[n];
+        long double diff = (vecGet(mesh.x, i + 1) - vecGet(mesh.x, i - 1)) / 2;
+        *vecRef(solver.scale, n) = (data.params.eps_r * EPS0) * powl(diff, 3);
+    }
+
+    // Thomas elimination of the jacobian, same operations as numSolveV
+    MatTD jcob = generateJacobian(mesh.x);
+    solver.sub = jcob.sub;
+    solver.den = jcob.main;
+    solver.sup = jcob.sup;
+
+    *vecRef(solver.sup, 0) = vecGet(jcob.sup, 0) / vecGet(jcob.main, 0);
+    for (size_t i = 1; i < mesh.x.len; i ++)
+    {
+        long double den = vecGet(jcob.main, i) - vecGet(jcob.sub, i) * vecGet(solver.sup, i - 1);
+        *vecRef(solver.den, i) = den;
+        *vecRef(solver.sup, i) = vecGet(jcob.sup, i) / den;
+    }
+
+    return solver;
+}
+
+int poissonSolverSolve(const PoissonSolver* solver, InputData data, Vec* V)
+{
+    size_t n = solver->mesh.x.len;
+    if (!solver->scale.x || !V || !V->x || V->len != n || data.probs.len != solver->scale.len)
+    {
+        printf("Input Invalid.\n");
+        return 0;
+    }
+
+    // b: V_0, the trap charges at their nodes, V_L
+    long double* v = V->x;
+    size_t inc = V->offset;
+    const long double* sub = solver->sub.x;
+    const long double* den = solver->den.x;
+    const long double* sup = solver->sup.x;
+    for (size_t i = 0; i < n; i ++) v[i * inc] = 0;
+    v[0] = data.params.V_0;
+    for (size_t k = 0; k < solver->scale.len; k ++)
+    {
+        v[solver->mesh.trap[k] * inc] = data.probs.x[k * data.probs.offset] * Q / solver->scale.x[k];
+    }
+    v[(n - 1) * inc] = data.params.V_L;
+
+    // forward and back substitution in place
+    v[0] = v[0] / den[0];
+    for (size_t i = 1; i < n; i ++)
+    {
+        v[i * inc] = (v[i * inc] - sub[i] * v[(i - 1) * inc]) / den[i];
+    }
+    for (size_t j = n - 1; j-- > 0;)
+    {
+        v[j * inc] = v[j * inc] - sup[j] * v[(j + 1) * inc];
+    }
+
+    return 1;
+}
+
+int poissonSolverGridE(const PoissonSolver* solver, InputData data, Vec* V, Vec* E)
+{
+    if (!E || !E->x || E->len != solver->scale.len || data.energies.len < E->len)
+    {
+        printf("Input Invalid.\n");
+        return 0;
+    }
+    if (!poissonSolverSolve(solver, data, V)) return 0;
+
+    for (size_t k = 0; k < E->len; k ++)
+    {
+        // Et = -qV - χ - Ed
+        E->x[k * E->offset] = -Q * V->x[solver->mesh.trap[k] * V->offset] - Q * data.params.electron_affinity
+                              - data.energies.x[k * data.energies.offset];
+    }
+    return 1;
+}
+
+// right hand sides per block of a batched solve, the rows of a block are swept together
+#define POISSON_BATCH_GRAIN 8
+
+typedef struct BatchCtx
+{
+    const PoissonSolver* solver;
+    Mat2d probs;
+    Vec V_0;
+    Vec V_L;
+    Mat2d V;
+} BatchCtx;
+
+// rows [begin, end) of a batched solve, same operations as poissonSolverSolve
+static void batch_rows(size_t begin, size_t end, void* ctx)
+{
+    const BatchCtx* c = ctx;
+    const PoissonSolver* solver = c->solver;
+    size_t n = solver->mesh.x.len;
+    size_t ld = c->V.ld;
+    long double* V = c->V.mat;
+
+    const long double* sub = solver->sub.x;
+    const long double* den = solver->den.x;
+    const long double* sup = solver->sup.x;
+    const long double* scale = solver->scale.x;
+    const long double* probs = c->probs.mat;
+    size_t probs_ld = c->probs.ld;
+
+    // b: V_0, the trap charges at their nodes, V_L
+    for (size_t r = begin; r < end; r ++)
+    {
+        long double* row = V + r * ld;
+        for (size_t i = 0; i < n; i ++) row[i] = 0;
+        row[0] = c->V_0.x[r * c->V_0.offset];
+        for (size_t k = 0; k < solver->scale.len; k ++)
+        {
+            row[solver->mesh.trap[k]] = probs[k * probs_ld + r] * Q / scale[k];
+        }
+        row[n - 1] = c->V_L.x[r * c->V_L.offset];
+    }
+
+    // forward and back substitution, every pivot is applied to all the rows of the block
+    for (size_t r = begin; r < end; r ++) V[r * ld] = V[r * ld] / den[0];
+    for (size_t i = 1; i < n; i ++)
+    {
+        for (size_t r = begin; r < end; r ++) V[r * ld + i] = (V[r * ld + i] - sub[i] * V[r * ld + i - 1]) / den[i];
+    }
+    for (size_t j = n - 1; j-- > 0;)
+    {
+        for (size_t r = begin; r < end; r ++) V[r * ld + j] = V[r * ld + j] - sup[j] * V[r * ld + j + 1];
+    }
+}
+
+int poissonSolverSolveBatch(const PoissonSolver* solver, Mat2d probs, Vec V_0, Vec V_L, Mat2d* V)
+{
+    size_t rhs = probs.cols;
+    if (!solver->scale.x || !V || !V->mat || !probs.mat || probs.rows != solver->scale.len ||
+        V_0.len != rhs || V_L.len != rhs || V->rows != rhs || V->cols != solver->mesh.x.len)
+    {
+        printf("Input Invalid.\n");
+        return 0;
+    }
+
+    BatchCtx ctx = {solver, probs, V_0, V_L, *V};
+    parallelFor(rhs, POISSON_BATCH_GRAIN, batch_rows, &ctx);
+    return 1;
+}
+
+Mat2d poissonWrapperBatchA(InputData data, Mesh mesh, Mat2d probs, Vec V_0, Vec V_L)
+{
+    Mat2d V = {NULL, 0, 0, 0};
+    PoissonSolver solver = poissonSolverInitA(data, mesh);
+    if (!solver.scale.x) return V;
+
+    V = mat2DInitUninitA(probs.cols, mesh.x.len);
+    if (!V.mat) printf("Allocation Failure!\n");
+    else if (!poissonSolverSolveBatch(&solver, probs, V_0, V_L, &V))
+        freeMat2D(&V);
+    freePoissonSolver(&solver);
+    return V;
+}
+
+// columns [begin, end) of the influence matrix, trap k is column k, V_0 and V_L are the two after the last trap
+typedef struct InfluenceCtx
+{
+    PoissonSolver* solver;
+    _Atomic int failed;     // a block could not allocate its work vector, its columns are missing
+} InfluenceCtx;
+
+static void influence_columns(size_t begin, size_t end, void* ctx)
+{
+    InfluenceCtx* c = ctx;
+    PoissonSolver* solver = c->solver;
+    size_t n = solver->mesh.x.len;
+    size_t traps = solver->scale.len;
+    const long double* sub = solver->sub.x;
+    const long double* den = solver->den.x;
+    const long double* sup = solver->sup.x;
+    Mat2d G = solver->influence;
+
+    long double* x = malloc(sizeof(long double) * n);
+    if (!x)
+    {
+        c->failed = 1;
+        return;
+    }
+
+    for (size_t col = begin; col < end; col ++)
+    {
+        // unit right hand side at one node: a trap charge of 1 or 1 volt on an electrode
+        size_t p;
+        long double b;
+        if (col < traps)
+        {
+            p = solver->mesh.trap[col];
+            b = Q / solver->scale.x[col];
+        }
+        else
+        {
+            p = solver->mesh.bound[col == traps ? 0 : traps + 1];
+            b = 1;
+        }
+
+        // forward substitution, the entries above p stay zero
+        for (size_t i = 0; i < p; i ++) x[i] = 0;
+        x[p] = b / den[p];
+        for (size_t i = p + 1; i < n; i ++) x[i] = -sub[i] * x[i - 1] / den[i];
+        for (size_t j = n - 1; j-- > 0;) x[j] = x[j] - sup[j] * x[j + 1];
+
+        // only the rows of the traps are kept
+        long double* bias = col == traps ? solver->bias_0.x : solver->bias_L.x;
+        for (size_t k = 0; k < traps; k ++)
+        {
+            long double v = x[solver->mesh.trap[k]];
+            if (col < traps) G.mat[k * G.ld + col] = v;
+            else bias[k] = v;
+        }
+    }
+
+    free(x);
+}
+
+// frees G and the bias columns, the solver is back to mesh solves only
+static void influence_free(PoissonSolver* solver)
+{
+    freeMat2D(&solver->influence);
+    freeVec(&solver->bias_0);
+    freeVec(&solver->bias_L);
+}
+
+int poissonSolverInfluence(PoissonSolver* solver)
+{
+    if (!solver->scale.x)
+    {
+        printf("Input Invalid.\n");
+        return 0;
+    }
+    if (solver->influence.mat) return 1;
+
+    size_t traps = solver->scale.len;
+    solver->influence = mat2DInitZerosA(traps, traps);
+    solver->bias_0 = vecInitZerosA(traps);
+    solver->bias_L = vecInitZerosA(traps);
+    if (!solver->influence.mat || !solver->bias_0.x || !solver->bias_L.x)
+    {
+        printf("Allocation Failure!\n");
+        influence_free(solver);
+        return 0;
+    }
+
+    // every column is an independent back substitution over the whole mesh
+    InfluenceCtx ctx = {solver, 0};
+    parallelFor(traps + 2, 1, influence_columns, &ctx);
+    if (ctx.failed)
+    {
+        // a partial G would give wrong potentials, drop it
+        printf("Allocation Failure!\n");
+        influence_free(solver);
+        return 0;
+    }
+    return 1;
+}
+
+int poissonSolverTrapV(const PoissonSolver* solver, InputData data, Vec* V)
+{
+    size_t traps = solver->scale.len;
+    if (!solver->influence.mat || !V || !V->x || V->len != traps || data.probs.len != traps)
+    {
+        printf("Input Invalid.\n");
+        return 0;
+    }
+
+    // V = G f_n + bias
+    mat2DTransform(solver->influence, data.probs, V);
+    for (size_t k = 0; k < traps; k ++)
+    {
+        *vecRef(*V, k) += vecGet(solver->bias_0, k) * data.params.V_0 + vecGet(solver->bias_L, k) * data.params.V_L;
+    }
+    return 1;
+}
+
+int poissonSolverTrapE(const PoissonSolver* solver, InputData data, Vec* E)
+{
+    if (!E || !E->x || data.energies.len < E->len)
+    {
+        printf("Input Invalid.\n");
+        return 0;
+    }
+    if (!poissonSolverTrapV(solver, data, E)) return 0;
+
+    for (size_t k = 0; k < E->len; k ++)
+    {
+        // Et = -qV - χ - Ed
+        *vecRef(*E, k) = -Q * vecGet(*E, k) - Q * data.params.electron_affinity - vecGet(data.energies, k);
+    }
+    return 1;
+}
+
+void freePoissonSolver(PoissonSolver* solver)
+{
+    influence_free(solver);
+    freeVec(&solver->sub);
+    freeVec(&solver->den);
+    freeVec(&solver->sup);
+    freeVec(&solver->scale);
+}
+
 void printNL()
 {
     printf("\n");
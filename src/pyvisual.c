@@ -53,6 +53,13 @@ void pyviSectionPush(PyViSec section, Vec fx)
     dynStackPush(&sec->data, &tmp);
 }
 
+// reserve space for count pushes to a section
+void pyviSectionReserve(PyViSec section, size_t count)
+{
+    PyViSectionData* sec = dynStackGet(section.pyvi->sections, section.id);
+    dynStackReserve(&sec->data, sec->data.len + count);
+}
+
 void freePyVi(PyVi* pyvi)
 {
     // close the file
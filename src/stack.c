@@ -11,8 +11,40 @@ DynStack dynStackInit(size_t elem_len)
 {
     return (DynStack){NULL, 0, 0, elem_len};
 }
-// Reserve N element space
-//DynStack dynStackReserve(size_t new_len);
+// make sure there is space for new_len elements in total
+void dynStackReserve(DynStack* dstack, size_t new_len)
+{
+    if(new_len <= dstack->reserved_size) return;
+
+    // keep the old buffer if realloc fails
+    uint8_t* data = realloc(dstack->data, new_len * dstack->element_size);
+    if(!data)
+    {
+        printf("[Dyn Stack] Fatal Error: realloc returned null!\n");
+        return;
+    }
+    dstack->data = data;
+    dstack->reserved_size = new_len;
+}
+
+// release the reserve space past len
+void dynStackShrink(DynStack* dstack)
+{
+    if(dstack->reserved_size == dstack->len) return;
+    if(dstack->len == 0)
+    {
+        free(dstack->data);
+        dstack->data = NULL;
+        dstack->reserved_size = 0;
+        return;
+    }
+
+    // shrinking in place can still fail, keep the bigger buffer then
+    uint8_t* data = realloc(dstack->data, dstack->len * dstack->element_size);
+    if(!data) return;
+    dstack->data = data;
+    dstack->reserved_size = dstack->len;
+}
 
 // push element_size data to stack, WARNING: assumes data is element_size large!
 void dynStackPush(DynStack* dstack, void* data)
@@ -20,19 +52,41 @@ void dynStackPush(DynStack* dstack, void* data)
     // if we have enough reserve space then, simply copy the data onto stack
     if(dstack->reserved_size < dstack->len + 1)
     {
-        // if not empty, try to realloc
-        // Possible point of failiure
-        dstack->data = realloc(dstack->data, 2 * dstack->element_size * (dstack->reserved_size + 1));
-
-        if(!dstack->data) printf("[Dyn Stack] Fatal Error: realloc returned null!\n");
-
-        dstack->reserved_size = 2 * (dstack->reserved_size + 1);
+        dynStackReserve(dstack, 2 * (dstack->reserved_size + 1));
+        if(dstack->reserved_size < dstack->len + 1) return;
     }
 
     memcpy(&__DSTACK_PTR_GET(dstack, dstack->len), data, dstack->element_size);
     dstack->len++;
 }
 
+// push count elements at once, WARNING: assumes data is count * element_size large!
+void dynStackPushN(DynStack* dstack, const void* data, size_t count)
+{
+    if(count == 0) return;
+    if(dstack->reserved_size < dstack->len + count)
+    {
+        // grow geometrically, unless the block alone is bigger
+        size_t grow = 2 * (dstack->reserved_size + 1);
+        dynStackReserve(dstack, grow > dstack->len + count ? grow : dstack->len + count);
+        if(dstack->reserved_size < dstack->len + count) return;
+    }
+
+    memcpy(&__DSTACK_PTR_GET(dstack, dstack->len), data, count * dstack->element_size);
+    dstack->len += count;
+}
+
+// take the buffer out of the stack(shrunk to fit), the caller owns it
+void* dynStackDetach(DynStack* dstack, size_t* len)
+{
+    dynStackShrink(dstack);
+    void* data = dstack->data;
+    if(len) *len = dstack->len;
+
+    *dstack = dynStackInit(dstack->element_size);
+    return data;
+}
+
 // access a element in dyn stack, safely
 void* dynStackGet(DynStack dstack, size_t index)
 {
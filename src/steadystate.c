@@ -1,6 +1,19 @@
 #include <include/steadystate.h>
 #define MIN_ERROR 1e-15
 #define MIN_REL_ERROR 1e-4
+// number of temporary vectors masterEquationCoeff takes from its arena
+#define MASTER_EQN_TEMPS 7
+// chord newton: refactor the jacobian when a step shrinks by less than this factor, or after this many steps
+#define CHORD_CONTRACTION 0.5L
+#define CHORD_MAX_STEPS 8
+// from this size on the jacobian is factored in double and the steps refined to long double(see MatLUD)
+#define MIXED_LU_MIN 128
+// `make PRECISION=double` factors every jacobian in double
+#ifdef LINALG_WORK_DOUBLE
+#define MIXED_LU_ALWAYS 1
+#else
+#define MIXED_LU_ALWAYS 0
+#endif
 
 //returns elementwise product as a vector 
 void vecMultiply(Vec a, Vec b, Vec* result){
@@ -19,20 +32,31 @@ void vecMultiply(Vec a, Vec b, Vec* result){
     }
 }
 
-//initializes the i+1, j+1 elements of jacobian matrix
-void jacobianMatrix(Mat2d matrix /*Initialize this matrix to 0*/, Mat2d coeffmatrix/*state to state transmission coefficients*/ , Vec R1 /*electrode 1 coefficients matrix*/, Vec R2 /*electrode 2 coefficients matrix*/,Vec f , int i, int j){
-    Vec one = vecInitOnesA(f.len); //remove this dumb
-    Vec fbar = vecInitZerosA(f.len); //remove this dumb
-    vecSub(one, f, &fbar);
+//the i, j element of the jacobian matrix, fbar = 1 - f
+static long double jacobianEntry(Mat2d coeffmatrix, Vec R1, Vec R2, Vec f, Vec fbar, size_t i, size_t j){
     if(i == j){
         long double abbar = vecDot(mat2DRow(coeffmatrix, i), fbar);
         long double ab = vecDot(mat2DCol(coeffmatrix, i), f);
-        *mat2DRef(matrix, i, i) = -(VEC_INDEX(R1, i) + VEC_INDEX(R2, i) + abbar + ab);
+        return -(VEC_INDEX(R1, i) + VEC_INDEX(R2, i) + abbar + ab);
     }
-    else{
-        *mat2DRef(matrix, i, j) = *mat2DRef(coeffmatrix, i, j)*VEC_INDEX(f, i) + *mat2DRef(coeffmatrix, j, i)*VEC_INDEX(fbar, i);
+    return *mat2DRef(coeffmatrix, i, j)*VEC_INDEX(f, i) + *mat2DRef(coeffmatrix, j, i)*VEC_INDEX(fbar, i);
+}
+
+//initializes the i+1, j+1 elements of jacobian matrix
+void jacobianMatrix(Mat2d matrix /*Initialize this matrix to 0*/, Mat2d coeffmatrix/*state to state transmission coefficients*/ , Vec R1 /*electrode 1 coefficients matrix*/, Vec R2 /*electrode 2 coefficients matrix*/,Vec f , int i, int j){
+    Vec fbar = vecInitOnesA(f.len);
+    vecSub(fbar, f, &fbar);
+    *mat2DRef(matrix, i, j) = jacobianEntry(coeffmatrix, R1, R2, f, fbar, i, j);
+    freeVec(&fbar);
+}
+
+//fills the whole jacobian matrix, fbar = 1 - f is computed once by the caller
+static void jacobianAssemble(Mat2d matrix, Mat2d coeffmatrix, Vec R1, Vec R2, Vec f, Vec fbar){
+    for(size_t i = 0; i < matrix.rows; i++){
+        for(size_t j = 0; j < matrix.cols; j++){
+            *mat2DRef(matrix, i, j) = jacobianEntry(coeffmatrix, R1, R2, f, fbar, i, j);
+        }
     }
-    freeVec(&one), freeVec(&fbar); //removed them dumb
 }
 
 //swaps a, b
@@ -65,49 +89,38 @@ int find_pivot_row(Mat2d A, int start_row, int column){
 }
 
 //does gaussian elimination
+//the input is destroyed(A holds the row echelon form), the newton solve uses MatLU/MatLUD(include/linalg.h) instead
 void gaussianElimination(Mat2d A/*jacobian matrix*/, Vec b/*coefficient vector*/){
-    int pivot_row = 0;
-    long double pivot, factor;
-
-    Mat2d temp = mat2DCopyA(A);
-    Vec tempVec = vecCopyA(b);
-
-    for(size_t i = 0; i < A.rows; i++){
-        //pivot_row = find_pivot_row(A, i, i);
-        //if(pivot_row != (int)i){
-        //    swapRows(A, b, i, pivot_row);
-        //}
-
-        pivot = *mat2DRef(A, i, i);
+    size_t n = A.rows, bad_pivot = n;
+    for(size_t i = 0; i < n; i++){
+        long double* row_i = A.mat + i * A.ld;
+        long double pivot = row_i[i];
         if(fabsl(pivot) < MIN_ERROR){
-            printf("Bad Matrix:\n");
-            printf("Jacobian:");
-            mat2DPrint(temp);
-            printf("\n");
-            printf("Vec:");
-            vecPrint(tempVec);
-            printf("\n");
-            printf("RREF-Jacobian:");
-            mat2DPrint(A);
-            printf("\n");
-            printf("=============================================================================================\n");
-            return;
-        }
-        VEC_INDEX(b, i)/=pivot;
-        for(size_t j = i; j < A.rows; j++){
-            *mat2DRef(A, i, j)/=pivot;
+            bad_pivot = i;
+            break;
         }
 
-        for(size_t k = i+1; k < A.cols; k++){
-            factor = *mat2DRef(A, k, i);
-            VEC_INDEX(b, k) -= factor*VEC_INDEX(b, i);
-            for(size_t m = i; m < A.rows; m++){
-                *mat2DRef(A, k, m) -= factor*(*mat2DRef(A, i, m));
-            }
+        VEC_INDEX(b, i) /= pivot;
+        for(size_t j = i; j < n; j++) row_i[j] /= pivot;
+
+        for(size_t k = i+1; k < n; k++){
+            long double* row_k = A.mat + k * A.ld;
+            long double factor = row_k[i];
+            VEC_INDEX(b, k) -= factor * VEC_INDEX(b, i);
+            for(size_t m = i; m < n; m++) row_k[m] -= factor * row_i[m];
         }
     }
-    freeVec(&tempVec);
-    freeMat2D(&temp);
+
+    if(bad_pivot != n){
+        printf("Bad Matrix(pivot %zu):\n", bad_pivot);
+        printf("RREF-Jacobian:");
+        mat2DPrint(A);
+        printf("\n");
+        printf("Vec:");
+        vecPrint(b);
+        printf("\n");
+        printf("=============================================================================================\n");
+    }
 }
 
 //does backsubstitutin for gaussian elimination
@@ -120,68 +133,147 @@ void backSubsA(Mat2d A, Vec b, Vec* x){
     }
 }
 
-Vec masterEquationCoeffA(Vec f, Vec R1, Vec R2, Mat2d coeffmatrix){
-    Vec one = vecInitOnesA(f.len);//remove this dumb
-    Vec fbar = vecInitZerosA(f.len);//remove this dumb
-    Vec F = vecInitZerosA(f.len);
+//computes the master equation F(f) into F, temporaries are taken from the arena and released before returning
+void masterEquationCoeff(Vec f, Vec R1, Vec R2, Mat2d coeffmatrix, LinalgArena* arena, Vec* F){
+    LinalgArenaMark mark = linalgArenaPush(arena);
+
+    Vec fbar = vecInitArena(arena, 1.0L, f.len);
+    vecSub(fbar, f, &fbar);
+
+    Vec f1 = vecInitZerosArena(arena, f.len);
+    Vec f2 = vecInitZerosArena(arena, f.len);
+    Vec f3 = vecInitZerosArena(arena, f.len);
+    Vec f4 = vecInitZerosArena(arena, f.len);
+    Vec f5 = vecInitZerosArena(arena, f.len);
+    Vec f6 = vecInitZerosArena(arena, f.len);
 
-    vecSub(one, f, &fbar);
-
-    Vec f1 = vecInitZerosA(f.len);
-    Vec f2 = vecInitZerosA(f.len);
-    Vec f3 = vecInitZerosA(f.len); 
-    Vec f4 = vecInitZerosA(f.len);
-    Vec f5 = vecInitZerosA(f.len);
-    Vec f6 = vecInitZerosA(f.len);
-    Vec f7 = vecInitZerosA(f.len);
-    Vec f8 = vecInitZerosA(f.len); //don't forget to free this dumb
-    
-    
     vecMultiply(R1, fbar, &f1);
     vecMultiply(R2, f, &f2);
-    vecSub(f1, f2, &f8);
 
-    Mat2d coeffmatrixTranspose = mat2DInitZerosA(coeffmatrix.cols, coeffmatrix.rows);
-    mat2DTranspose(coeffmatrix, &coeffmatrixTranspose);
     mat2DTransform(coeffmatrix, fbar, &f3);
-    mat2DTransform(coeffmatrixTranspose, f, &f4);
+    mat2DTransformT(coeffmatrix, f, &f4);
     vecMultiply(f3, f, &f5);
     vecMultiply(f4, fbar, &f6);
-    vecSub(f6, f5, &f7);
-    vecAdd(f7, f8, &F);
 
-    freeVec(&f1), freeVec(&f2), freeVec(&f3), freeVec(&f4), freeVec(&f5), freeVec(&f6), freeVec(&f7), freeVec(&f8);
-    freeVec(&one), freeVec(&fbar);
-    freeMat2D(&coeffmatrixTranspose);
+    // F = (f6 - f5) + (f1 - f2)
+    vecLinComb(f6, 3, (long double[]){-1.0L, 1.0L, -1.0L}, (Vec[]){f5, f1, f2}, F);
+
+    linalgArenaPop(arena, mark);
+}
+
+//same as masterEquationCoeff with a sparse coefficient matrix(see matrix_r_nm_csr), O(N*neighbours)
+void masterEquationCoeffCSR(Vec f, Vec R1, Vec R2, MatCSR coeffmatrix, LinalgArena* arena, Vec* F){
+    LinalgArenaMark mark = linalgArenaPush(arena);
+
+    Vec fbar = vecInitArena(arena, 1.0L, f.len);
+    vecSub(fbar, f, &fbar);
+
+    Vec f1 = vecInitZerosArena(arena, f.len);
+    Vec f2 = vecInitZerosArena(arena, f.len);
+    Vec f3 = vecInitZerosArena(arena, f.len);
+    Vec f4 = vecInitZerosArena(arena, f.len);
+
+    vecMultiply(R1, fbar, &f1);
+    vecMultiply(R2, f, &f2);
+
+    matCSRTransform(coeffmatrix, fbar, &f3);
+    matCSRTransformT(coeffmatrix, f, &f4);
+    vecMultiply(f3, f, &f3);
+    vecMultiply(f4, fbar, &f4);
+
+    // F = (f4 - f3) + (f1 - f2)
+    vecLinComb(f4, 3, (long double[]){-1.0L, 1.0L, -1.0L}, (Vec[]){f3, f1, f2}, F);
+
+    linalgArenaPop(arena, mark);
+}
+
+Vec masterEquationCoeffA(Vec f, Vec R1, Vec R2, Mat2d coeffmatrix){
+    Vec F = vecInitZerosA(f.len);
+    LinalgArena arena = linalgArenaInitA(MASTER_EQN_TEMPS * (f.len * sizeof(long double) + 64));
+    masterEquationCoeff(f, R1, R2, coeffmatrix, &arena, &F);
+    freeLinalgArena(&arena);
     return F;
 }
 
 //implements jacobian algorithm
 Vec jacobianImplementationA(Mat2d coeffmatrix, Vec R1, Vec R2){
     srand(time(NULL));
-    Mat2d matrix = mat2DInitZerosA(coeffmatrix.rows, coeffmatrix.cols); //don't forget to remove it dumb
-    Vec f = vecInitA(1e-10, matrix.cols); //need it dumb
+    Vec f = vecInitA(1e-10, coeffmatrix.cols); //need it dumb
+    // every step writes the new iterate here and swaps, so the step norms come from one pass over old and new
+    Vec f_next = vecInitZerosA(f.len);
 
     // for(size_t i = 0; i < f.len; i++)
     // {
     //     VEC_INDEX(f, i) = ((long double)rand()) / RAND_MAX;
     // }
 
-    Vec F = vecInitA(0, matrix.cols); //need it dumb but can free it later
-    Vec delta_f = vecInitA(0.1, matrix.cols); //free it dumb
-    while(vecMaxAbs(delta_f)/vecMaxAbs(f) > MIN_REL_ERROR){
-        for(size_t i = 0; i < matrix.rows; i++){
-            for(size_t j = 0; j < matrix.cols; j++){
-                jacobianMatrix(matrix, coeffmatrix, R1, R2, f, i, j);
+    // the jacobian is assembled straight into the LU storage and factored in place
+    // large systems keep it unfactored there for the refinement and factor a double copy instead
+    MatLU jacobian = matLUInitA(coeffmatrix.rows);
+    int mixed = MIXED_LU_ALWAYS || coeffmatrix.rows >= MIXED_LU_MIN;
+    MatLUD jacobian_d = mixed ? matLUDInitA(coeffmatrix.rows) : (MatLUD){{NULL, 0, 0}, NULL, 1};
+    Vec delta_f = vecInitZerosA(f.len);
+    // every newton iteration takes its temporaries from here and releases them at the end
+    LinalgArena arena = linalgArenaInitA((MASTER_EQN_TEMPS + 2) * (f.len * sizeof(long double) + 64));
+
+    // chord newton: a factored jacobian is reused while the steps keep contracting
+    int factored = 0;
+    size_t chord_steps = 0;
+    long double prev_step = INFINITY;
+    for(;;){
+        LinalgArenaMark mark = linalgArenaPush(&arena);
+
+        if(!factored){
+            Vec fbar = vecInitArena(&arena, 1.0L, f.len);
+            vecSub(fbar, f, &fbar);
+            jacobianAssemble(jacobian.lu, coeffmatrix, R1, R2, f, fbar);
+            if(mixed && matLUDFactor(jacobian.lu, &jacobian_d) != LINALG_OK){
+                // a zero pivot after rounding to double, factor the same iterate in long double
+                mixed = 0;
+                linalgArenaPop(&arena, mark);
+                continue;
+            }
+            if(!mixed && matLUFactor(jacobian.lu, &jacobian) != LINALG_OK){
+                printf("[Steady-State] Error: singular jacobian!\n");
+                linalgArenaPop(&arena, mark);
+                break;
             }
+            factored = 1;
+            chord_steps = 0;
         }
-        F = masterEquationCoeffA(f, R1, R2, coeffmatrix);
-        gaussianElimination(matrix, F);
-        backSubsA(matrix, F, &delta_f);
-        vecSub(f, delta_f, &f);
+
+        Vec F = vecInitZerosArena(&arena, f.len);
+        masterEquationCoeff(f, R1, R2, coeffmatrix, &arena, &F);
+        if(!mixed) matLUSolve(jacobian, F, &delta_f);
+        else if(matLUDSolveRefined(jacobian_d, jacobian.lu, F, &delta_f) != LINALG_OK){
+            // too ill conditioned for double, the long double factorization re-solves the same iterate
+            // before any step is taken(the failed step may not even be finite)
+            mixed = 0;
+            factored = 0;
+            linalgArenaPop(&arena, mark);
+            continue;
+        }
+        vecSub(f, delta_f, &f_next);
+        LinalgDiffNorms step = vecDiffNorms(f, f_next);
+        Vec swap = f;
+        f = f_next;
+        f_next = swap;
+        linalgArenaPop(&arena, mark);
+
+        if(step.nonfinite){
+            printf("[Steady-State] Error: newton step is not finite!\n");
+            break;
+        }
+        if(step.rel_max <= MIN_REL_ERROR) break;
+
+        if(++chord_steps >= CHORD_MAX_STEPS || !(step.max_diff <= CHORD_CONTRACTION * prev_step)) factored = 0;
+        prev_step = step.max_diff;
     }
     // vecPrint(f);
-    freeVec(&F), freeVec(&delta_f);
-    freeMat2D(&matrix);
+    freeVec(&delta_f);
+    freeVec(&f_next);
+    freeLinalgArena(&arena);
+    freeMatLU(&jacobian);
+    freeMatLUD(&jacobian_d);
     return f;
 }
@@ -0,0 +1,346 @@
+#include <include/threadpool.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// upper limit on the threads of the pool(the calling thread included)
+#define TP_MAX_THREADS 64
+// blocks dealt to each thread by parallelFor, more blocks balance better but cost more locking
+#define TP_BLOCKS_PER_THREAD 8
+// most blocks of a deterministic reduction, independent of the thread count
+#define TP_REDUCE_BLOCKS 256
+// partials are padded to a cache line so threads do not share one
+#define TP_LINE 64
+
+#define TP_ALIGN_UP(x, a) (((x) + (a) - 1) / (a) * (a))
+
+// run block b([begin, end)) of a job on thread worker
+typedef void (*TpBlockFn)(size_t b, size_t begin, size_t end, size_t worker, void* arg);
+
+typedef struct TpJob
+{
+    TpBlockFn fn;
+    void* arg;
+    size_t n;
+    size_t block;           // iterations per block, the last block also takes the remainder
+    size_t blocks;
+    size_t participants;    // threads taking part, 0 is the caller
+} TpJob;
+
+// blocks [next, end) of a thread's run that nobody started yet
+typedef struct TpQueue
+{
+    _Alignas(TP_LINE) pthread_mutex_t lock;
+    size_t next;
+    size_t end;
+} TpQueue;
+
+typedef struct ThreadPool
+{
+    pthread_mutex_t submit;     // held by the thread running a loop on the pool
+    pthread_mutex_t lock;       // guards everything below
+    pthread_cond_t wake;        // workers wait here for a new job
+    pthread_cond_t done;        // the caller waits here for the workers to leave the job
+    unsigned long generation;   // bumped for each job
+    unsigned long started;      // generation when the workers were started, the first job they wait for is the next one
+    TpJob* job;
+    size_t busy;                // workers that did not leave the current job yet
+    int shutdown;
+    size_t workers;             // started threads, the caller not included
+    pthread_t thread[TP_MAX_THREADS];
+    TpQueue queue[TP_MAX_THREADS];
+    int ready;                  // queue locks initialized, atexit registered
+} ThreadPool;
+
+static ThreadPool tp = {
+    .submit = PTHREAD_MUTEX_INITIALIZER,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+};
+
+// 0 = not decided yet, picked from the online cpu count on first use
+static int tp_threads = 0;
+
+// set on pool threads and on a caller while it runs a job, loops started there run inline
+static _Thread_local int tp_in_pool = 0;
+
+static size_t tp_block_begin(const TpJob* job, size_t b)
+{
+    return b * job->block;
+}
+
+static size_t tp_block_end(const TpJob* job, size_t b)
+{
+    return b + 1 == job->blocks ? job->n : (b + 1) * job->block;
+}
+
+// take the next block of a run, returns 0 when the run is empty
+static int tp_pop(TpQueue* queue, size_t* b)
+{
+    pthread_mutex_lock(&queue->lock);
+    int found = queue->next < queue->end;
+    if(found) *b = queue->next++;
+    pthread_mutex_unlock(&queue->lock);
+    return found;
+}
+
+// move the back half of another thread's run into queue, returns 0 when every run is empty
+static int tp_steal(const TpJob* job, size_t self)
+{
+    for(size_t k = 1; k < job->participants; k++)
+    {
+        TpQueue* victim = &tp.queue[(self + k) % job->participants];
+        pthread_mutex_lock(&victim->lock);
+        size_t left = victim->end - victim->next;
+        size_t take = (left + 1) / 2;
+        victim->end -= take;
+        size_t first = victim->end;
+        pthread_mutex_unlock(&victim->lock);
+        if(take == 0) continue;
+
+        TpQueue* queue = &tp.queue[self];
+        pthread_mutex_lock(&queue->lock);
+        queue->next = first;
+        queue->end = first + take;
+        pthread_mutex_unlock(&queue->lock);
+        return 1;
+    }
+    return 0;
+}
+
+// run blocks until there is nothing left to run or steal
+static void tp_participate(const TpJob* job, size_t self)
+{
+    size_t b;
+    do
+    {
+        while(tp_pop(&tp.queue[self], &b)) job->fn(b, tp_block_begin(job, b), tp_block_end(job, b), self, job->arg);
+    } while(tp_steal(job, self));
+}
+
+static void* tp_worker(void* arg)
+{
+    size_t self = (size_t)arg;
+    tp_in_pool = 1;
+
+    pthread_mutex_lock(&tp.lock);
+    unsigned long seen = tp.started;
+    for(;;)
+    {
+        while(!tp.shutdown && tp.generation == seen) pthread_cond_wait(&tp.wake, &tp.lock);
+        if(tp.shutdown) break;
+        seen = tp.generation;
+        const TpJob* job = tp.job;
+        pthread_mutex_unlock(&tp.lock);
+
+        if(self < job->participants) tp_participate(job, self);
+
+        pthread_mutex_lock(&tp.lock);
+        if(--tp.busy == 0) pthread_cond_signal(&tp.done);
+    }
+    pthread_mutex_unlock(&tp.lock);
+    return NULL;
+}
+
+// stop the workers, submit must be held
+static void tp_stop()
+{
+    if(tp.workers == 0) return;
+    pthread_mutex_lock(&tp.lock);
+    tp.shutdown = 1;
+    pthread_cond_broadcast(&tp.wake);
+    pthread_mutex_unlock(&tp.lock);
+
+    for(size_t t = 1; t <= tp.workers; t++) pthread_join(tp.thread[t], NULL);
+    tp.workers = 0;
+    tp.shutdown = 0;
+}
+
+// make sure threads - 1 workers are running, submit must be held. returns the number of usable threads
+static size_t tp_start(size_t threads)
+{
+    if(!tp.ready)
+    {
+        for(size_t t = 0; t < TP_MAX_THREADS; t++) pthread_mutex_init(&tp.queue[t].lock, NULL);
+        atexit(threadPoolShutdown);
+        tp.ready = 1;
+    }
+    if(tp.workers + 1 == threads) return threads;
+
+    tp_stop();
+    tp.started = tp.generation;
+    for(size_t t = 1; t < threads; t++)
+    {
+        if(pthread_create(&tp.thread[t], NULL, tp_worker, (void*)t) != 0)
+        {
+            printf("[Thread Pool] Warning: could only start %zu of %zu threads!\n", t, threads);
+            break;
+        }
+        tp.workers = t;
+    }
+    return tp.workers + 1;
+}
+
+// run every block of job, on the pool when it is free and there is more than one block
+static void tp_run(TpJob* job)
+{
+    size_t threads = (size_t)threadPoolThreads();
+    if(tp_in_pool || threads <= 1 || job->blocks <= 1 || pthread_mutex_trylock(&tp.submit) != 0)
+    {
+        for(size_t b = 0; b < job->blocks; b++) job->fn(b, tp_block_begin(job, b), tp_block_end(job, b), 0, job->arg);
+        return;
+    }
+
+    threads = tp_start(threads);
+    job->participants = threads < job->blocks ? threads : job->blocks;
+
+    // deal contiguous runs of blocks, the first runs take the remainder
+    size_t run = job->blocks / job->participants, rem = job->blocks % job->participants, next = 0;
+    for(size_t t = 0; t < job->participants; t++)
+    {
+        tp.queue[t].next = next;
+        next += run + (t < rem);
+        tp.queue[t].end = next;
+    }
+
+    pthread_mutex_lock(&tp.lock);
+    tp.job = job;
+    tp.busy = tp.workers;
+    tp.generation++;
+    pthread_cond_broadcast(&tp.wake);
+    pthread_mutex_unlock(&tp.lock);
+
+    tp_in_pool = 1;
+    tp_participate(job, 0);
+    tp_in_pool = 0;
+
+    pthread_mutex_lock(&tp.lock);
+    while(tp.busy > 0) pthread_cond_wait(&tp.done, &tp.lock);
+    tp.job = NULL;
+    pthread_mutex_unlock(&tp.lock);
+
+    pthread_mutex_unlock(&tp.submit);
+}
+
+// get the number of threads(the caller included) used by parallel loops
+int threadPoolThreads()
+{
+    if(tp_threads == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        tp_threads = cpus < 1 ? 1 : (cpus > TP_MAX_THREADS ? TP_MAX_THREADS : (int)cpus);
+    }
+    return tp_threads;
+}
+
+// set the number of threads used by parallel loops(0 = number of cpus), returns the count actually selected
+int threadPoolSetThreads(int threads)
+{
+    if(threads < 0) threads = 1;
+    if(threads > TP_MAX_THREADS) threads = TP_MAX_THREADS;
+    tp_threads = threads;
+    // the pool is resized on the next loop
+    return threadPoolThreads();
+}
+
+// stop and join the pool threads
+void threadPoolShutdown()
+{
+    pthread_mutex_lock(&tp.submit);
+    tp_stop();
+    pthread_mutex_unlock(&tp.submit);
+}
+
+typedef struct TpForArgs
+{
+    ParallelRangeFn fn;
+    void* ctx;
+} TpForArgs;
+
+static void tp_for_block(size_t b, size_t begin, size_t end, size_t worker, void* arg)
+{
+    (void)b;
+    (void)worker;
+    const TpForArgs* args = arg;
+    args->fn(begin, end, args->ctx);
+}
+
+// split [0, n) into blocks of at least grain iterations and run fn over them on the pool
+void parallelFor(size_t n, size_t grain, ParallelRangeFn fn, void* ctx)
+{
+    if(n == 0) return;
+    if(grain == 0) grain = 1;
+
+    size_t target = (size_t)threadPoolThreads() * TP_BLOCKS_PER_THREAD;
+    size_t block = (n + target - 1) / target;
+    if(block < grain) block = grain;
+    size_t blocks = n / block;
+    if(blocks <= 1)
+    {
+        fn(0, n, ctx);
+        return;
+    }
+
+    TpForArgs args = {fn, ctx};
+    TpJob job = {tp_for_block, &args, n, block, blocks, 1};
+    tp_run(&job);
+}
+
+typedef struct TpReduceArgs
+{
+    ParallelReduceFn fn;
+    void* ctx;
+    unsigned char* partial;     // one slot of stride bytes per block(deterministic) or per thread(fast)
+    size_t stride;
+    int per_block;
+} TpReduceArgs;
+
+static void tp_reduce_block(size_t b, size_t begin, size_t end, size_t worker, void* arg)
+{
+    const TpReduceArgs* args = arg;
+    args->fn(begin, end, args->partial + (args->per_block ? b : worker) * args->stride, args->ctx);
+}
+
+// reduce [0, n) with fn over blocks of at least grain iterations, then combine the partials into result
+void parallelReduce(size_t n, size_t grain, ParallelReduceFn fn, ParallelCombineFn combine,
+                    const void* identity, size_t size, void* result, int mode, void* ctx)
+{
+    memmove(result, identity, size);
+    if(n == 0) return;
+    if(grain == 0) grain = 1;
+
+    int per_block = mode == PARALLEL_REDUCE_DETERMINISTIC;
+    size_t threads = (size_t)threadPoolThreads();
+    size_t target = per_block ? TP_REDUCE_BLOCKS : threads * TP_BLOCKS_PER_THREAD;
+    size_t block = (n + target - 1) / target;
+    if(block < grain) block = grain;
+    size_t blocks = n / block;
+    if(blocks == 0) blocks = 1;
+    if(!per_block && (blocks == 1 || threads == 1))
+    {
+        fn(0, n, result, ctx);
+        return;
+    }
+
+    size_t slots = per_block ? blocks : threads;
+    size_t stride = TP_ALIGN_UP(size, TP_LINE);
+    unsigned char* partial = aligned_alloc(TP_LINE, stride * slots);
+    if(!partial)
+    {
+        printf("[Thread Pool] Fatal Error: could not allocate the partial results, reducing serially!\n");
+        fn(0, n, result, ctx);
+        return;
+    }
+    for(size_t s = 0; s < slots; s++) memcpy(partial + s * stride, identity, size);
+
+    TpReduceArgs args = {fn, ctx, partial, stride, per_block};
+    TpJob job = {tp_reduce_block, &args, n, block, blocks, 1};
+    tp_run(&job);
+
+    for(size_t s = 0; s < slots; s++) combine(result, partial + s * stride, ctx);
+    free(partial);
+}
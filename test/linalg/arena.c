@@ -0,0 +1,82 @@
+#include <assert.h>
+#include <stdint.h>
+#include "linalg.h"
+
+void test_linalgArenaAlloc() {
+    LinalgArena arena = linalgArenaInitA(1024);
+    assert(arena.block != NULL);
+
+    void* a = linalgArenaAlloc(&arena, 3);
+    void* b = linalgArenaAlloc(&arena, 100);
+    assert(((uintptr_t)a) % 64 == 0);
+    assert(((uintptr_t)b) % 64 == 0);
+    assert((char*)b - (char*)a == 64);
+
+    // pop gives the same memory back
+    LinalgArenaMark mark = linalgArenaPush(&arena);
+    void* c = linalgArenaAlloc(&arena, 16);
+    linalgArenaPop(&arena, mark);
+    assert(linalgArenaAlloc(&arena, 16) == c);
+
+    freeLinalgArena(&arena);
+    assert(arena.block == NULL && arena.spare == NULL);
+}
+
+void test_linalgArenaGrow() {
+    LinalgArena arena = linalgArenaInitA(4096);
+    LinalgArenaMark outer = linalgArenaPush(&arena);
+    Vec keep = vecInitArena(&arena, 3.0L, 8);
+
+    for (int iter = 0; iter < 3; iter++) {
+        LinalgArenaMark mark = linalgArenaPush(&arena);
+        // overflows the first block, chains new ones
+        for (int i = 0; i < 10; i++) {
+            Vec tmp = vecInitZerosArena(&arena, 1000);
+            assert(tmp.x != NULL && tmp.len == 1000 && tmp.offset == 1);
+            assert(((uintptr_t)tmp.x) % 64 == 0);
+            tmp.x[999] = 1.0L;
+        }
+        linalgArenaPop(&arena, mark);
+        assert(arena.block == outer.block);
+        // the biggest chained block is kept for the next overflow
+        assert(arena.spare != NULL);
+    }
+    for (size_t i = 0; i < keep.len; i++) assert(keep.x[i] == 3.0L);
+
+    linalgArenaPop(&arena, outer);
+    freeLinalgArena(&arena);
+}
+
+void test_linalgArenaInit() {
+    LinalgArena arena = linalgArenaInitA(0);
+    Vec src = vecInitZerosA(6);
+    for (size_t i = 0; i < src.len; i++) src.x[i] = (long double)i;
+
+    Mat2d m = mat2DInitArena(&arena, 2.0L, 3, 2);
+    assert(m.rows == 3 && m.cols == 2);
+    assert(m.ld % LINALG_MAT_PAD == 0);
+    for (size_t i = 0; i < 6; i++) assert(mat2DGet(m, i / 2, i % 2) == 2.0L);
+    Mat2d z = mat2DInitZerosArena(&arena, 2, 2);
+    for (size_t i = 0; i < 4; i++) assert(mat2DGet(z, i / 2, i % 2) == 0.0L);
+
+    // strided source, contiguous copy
+    Mat2d s = mat2DConstruct(src.x, 3, 2);
+    Vec col = vecCopyArena(&arena, mat2DCol(s, 1));
+    assert(col.len == 3 && col.offset == 1);
+    assert(col.x[0] == 1.0L && col.x[1] == 3.0L && col.x[2] == 5.0L);
+
+    Vec bad = vecInitArena(&arena, 0, 0);
+    assert(bad.x == NULL);
+
+    freeVec(&src);
+    freeLinalgArena(&arena);
+}
+
+int linalg_arena_test() {
+    test_linalgArenaAlloc();
+    test_linalgArenaGrow();
+    test_linalgArenaInit();
+
+    printf("linalgArena* functions passed all tests\n");
+    return 0;
+}
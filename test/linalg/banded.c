@@ -0,0 +1,85 @@
+#include <assert.h>
+#include <math.h>
+#include "linalg.h"
+
+void test_matBandLU() {
+    // pentadiagonal(4th order stencil like) and diagonally dominant
+    size_t n = 9;
+    MatBand A = matBandInitA(n, 2, 2);
+    Mat2d D = mat2DInitZerosA(n, n);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = (i > 2 ? i - 2 : 0); j < n && j <= i + 2; j++) {
+            long double v = i == j ? 6 + 0.1L * i : -1.0L / (1 + i + 2 * j);
+            *matBandRef(A, i, j) = v;
+            *mat2DRef(D, i, j) = v;
+        }
+    }
+    assert(matBandGet(A, 0, 5) == 0);
+    assert(matBandGet(A, 4, 2) == mat2DGet(D, 4, 2));
+
+    Vec x = vecInitZerosA(n), y = vecInitZerosA(n), y_ref = vecInitZerosA(n);
+    for (size_t i = 0; i < n; i++) x.x[i] = sinl(i + 1);
+    assert(matBandTransform(A, x, &y) == LINALG_OK);
+    assert(mat2DTransform(D, x, &y_ref) == LINALG_OK);
+    for (size_t i = 0; i < n; i++) assert(fabsl(y.x[i] - y_ref.x[i]) < 1e-15L);
+    assert(matBandTransform(A, y, &y) == LINALG_ERROR);
+
+    // solve in place
+    assert(matBandLUFactor(&A) == LINALG_OK);
+    assert(matBandLUSolve(A, y, &y) == LINALG_OK);
+    for (size_t i = 0; i < n; i++) assert(fabsl(y.x[i] - x.x[i]) < 1e-15L);
+
+    // zero pivot is reported, banded LU does not pivot
+    MatBand Z = matBandInitA(2, 1, 1);
+    *matBandRef(Z, 0, 1) = 1, *matBandRef(Z, 1, 0) = 1;
+    assert(matBandLUFactor(&Z) == LINALG_ERROR);
+
+    freeMatBand(&A), freeMatBand(&Z);
+    assert(A.band == NULL && A.n == 0);
+    freeMat2D(&D);
+    freeVec(&x), freeVec(&y), freeVec(&y_ref);
+}
+
+void test_matBlockTDSolve() {
+    size_t blocks = 5, bs = 3, n = blocks * bs;
+    MatBlockTD A = matBlockTDInitA(blocks, bs);
+    Mat2d D = mat2DInitZerosA(n, n);
+    for (size_t k = 0; k < blocks; k++) {
+        for (size_t which = 0; which < 3; which++) {
+            if ((which == 0 && k == 0) || (which == 2 && k + 1 == blocks)) continue;
+            Mat2d B = which == 0 ? matBlockTDSub(A, k) : which == 1 ? matBlockTDMain(A, k) : matBlockTDSup(A, k);
+            for (size_t r = 0; r < bs; r++) {
+                for (size_t c = 0; c < bs; c++) {
+                    // the main blocks need pivoting(zero diagonal) but the system is well conditioned
+                    long double v = which == 1 ? (r == (c + 1) % bs ? 5 : 0.3L * (r + c)) : cosl(k + r * bs + c) * 0.5L;
+                    *mat2DRef(B, r, c) = v;
+                    *mat2DRef(D, k * bs + r, (k + which - 1) * bs + c) = v;
+                }
+            }
+        }
+    }
+    assert(matBlockTDSub(A, 0).mat == NULL);
+    assert(matBlockTDSup(A, blocks - 1).mat == NULL);
+
+    Vec x = vecInitZerosA(n), b = vecInitZerosA(n), b_ref = vecInitZerosA(n);
+    for (size_t i = 0; i < n; i++) x.x[i] = 1 + 0.25L * i;
+    assert(matBlockTDTransform(A, x, &b) == LINALG_OK);
+    assert(mat2DTransform(D, x, &b_ref) == LINALG_OK);
+    for (size_t i = 0; i < n; i++) assert(fabsl(b.x[i] - b_ref.x[i]) < 1e-15L);
+
+    assert(matBlockTDSolve(A, b, &b) == LINALG_OK);
+    for (size_t i = 0; i < n; i++) assert(fabsl(b.x[i] - x.x[i]) < 1e-14L);
+
+    freeMatBlockTD(&A);
+    assert(A.data == NULL);
+    freeMat2D(&D);
+    freeVec(&x), freeVec(&b), freeVec(&b_ref);
+}
+
+int linalg_banded_test() {
+    test_matBandLU();
+    test_matBlockTDSolve();
+
+    printf("matBand*/matBlockTD* functions passed all tests\n");
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include <assert.h>
+#include <math.h>
+#include "linalg.h"
+
+// system s of the test batches, the zero diagonal forces pivoting
+static void batch_test_system(Mat2d M, size_t s) {
+    size_t n = M.rows;
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            *mat2DRef(M, i, j) = i == j ? (i == 0 ? 0 : 2 + 0.1L * s) : sinl(1 + i * 7 + j * 3 + s) / n;
+    *mat2DRef(M, 0, n - 1) = 1;
+    *mat2DRef(M, n - 1, 0) = 1;
+}
+
+// every system against the long double LU, at every simd level and around the register widths
+void test_matBatchLUD() {
+    size_t ns[] = {2, 5, 17};
+    size_t batches[] = {1, 3, 8, 13};
+    for (int level = LINALG_SIMD_SCALAR; level <= LINALG_SIMD_AVX512; level++) {
+        linalgSimdSetLevel(level);
+        for (size_t a = 0; a < 3; a++) {
+            for (size_t c = 0; c < 4; c++) {
+                size_t n = ns[a], batch = batches[c];
+                MatBatchD A = matBatchDInitA(n, batch);
+                VecBatchD b = vecBatchDInitA(n, batch), x = vecBatchDInitA(n, batch), y = vecBatchDInitA(n, batch);
+                Mat2d M = mat2DInitZerosA(n, n), back = mat2DInitZerosA(n, n);
+                for (size_t s = 0; s < batch; s++) {
+                    batch_test_system(M, s);
+                    assert(matBatchDSetSystem(&A, s, M) == LINALG_OK);
+                    assert(matBatchDGetSystem(A, s, &back) == LINALG_OK);
+                    for (size_t i = 0; i < n * n; i++) assert(mat2DGet(back, i / n, i % n) == (double)mat2DGet(M, i / n, i % n));
+                    for (size_t i = 0; i < n; i++) *vecBatchDRef(b, s, i) = cos(i + 0.5 * s);
+                }
+
+                MatBatchLUD lu = matBatchLUDInitA(n, batch);
+                assert(matBatchLUDFactor(A, &lu) == LINALG_OK);
+                assert(matBatchLUDSolve(lu, b, &x) == LINALG_OK);
+                // residual of every system through the batched product
+                assert(matBatchDTransform(A, x, &y) == LINALG_OK);
+                for (size_t s = 0; s < batch; s++)
+                    for (size_t i = 0; i < n; i++) assert(fabs(*vecBatchDRef(y, s, i) - *vecBatchDRef(b, s, i)) < 1e-13);
+
+                // against MatLU
+                for (size_t s = 0; s < batch; s++) {
+                    assert(matBatchDGetSystem(A, s, &M) == LINALG_OK);
+                    MatLU ref = matLUFactorA(M);
+                    Vec rb = vecInitZerosA(n), rx = vecInitZerosA(n);
+                    for (size_t i = 0; i < n; i++) rb.x[i] = *vecBatchDRef(b, s, i);
+                    assert(matLUSolve(ref, rb, &rx) == LINALG_OK);
+                    for (size_t i = 0; i < n; i++) assert(fabsl(rx.x[i] - *vecBatchDRef(x, s, i)) < 1e-13L);
+                    freeMatLU(&ref), freeVec(&rb), freeVec(&rx);
+                }
+
+                // in place factor and solve, same arithmetic so the same bits
+                for (size_t i = 0; i < n * n * A.stride; i++) lu.lu.mat[i] = A.mat[i];
+                assert(matBatchLUDFactor(lu.lu, &lu) == LINALG_OK);
+                assert(matBatchLUDSolve(lu, b, &b) == LINALG_OK);
+                for (size_t s = 0; s < batch; s++)
+                    for (size_t i = 0; i < n; i++) assert(*vecBatchDRef(b, s, i) == *vecBatchDRef(x, s, i));
+
+                freeMatBatchD(&A), freeVecBatchD(&b), freeVecBatchD(&x), freeVecBatchD(&y);
+                freeMatBatchLUD(&lu), freeMat2D(&M), freeMat2D(&back);
+            }
+        }
+    }
+    linalgSimdSetLevel(LINALG_SIMD_AVX512);
+}
+
+void test_matBatchLUDSingular() {
+    size_t n = 3, batch = 6;
+    MatBatchD A = matBatchDInitA(n, batch);
+    VecBatchD b = vecBatchDInitA(n, batch), x = vecBatchDInitA(n, batch);
+    for (size_t s = 0; s < batch; s++)
+        for (size_t i = 0; i < n; i++) {
+            *matBatchDRef(A, s, i, i) = s + 1;
+            *vecBatchDRef(b, s, i) = 1;
+        }
+    // system 4 has a zero row, only its lane is lost
+    *matBatchDRef(A, 4, 1, 1) = 0;
+
+    MatBatchLUD lu = matBatchLUDInitA(n, batch);
+    assert(lu.singular[0] == 1);
+    assert(matBatchLUDFactor(A, &lu) == LINALG_ERROR);
+    assert(matBatchLUDSolve(lu, b, &x) == LINALG_OK);
+    for (size_t s = 0; s < batch; s++) {
+        assert(lu.singular[s] == (s == 4));
+        for (size_t i = 0; i < n; i++) assert(s == 4 ? isnan(*vecBatchDRef(x, s, i)) : *vecBatchDRef(x, s, i) == 1.0 / (s + 1));
+    }
+
+    assert(matBatchDTransform(A, x, &x) == LINALG_ERROR);
+    VecBatchD wrong = vecBatchDInitA(n, batch + 1);
+    assert(matBatchLUDSolve(lu, wrong, &x) == LINALG_ERROR);
+
+    freeMatBatchD(&A), freeVecBatchD(&b), freeVecBatchD(&x), freeVecBatchD(&wrong), freeMatBatchLUD(&lu);
+}
+
+int linalg_batch_test() {
+    test_matBatchLUD();
+    test_matBatchLUDSingular();
+
+    printf("matBatchD*/matBatchLUD* functions passed all tests\n");
+    return 0;
+}
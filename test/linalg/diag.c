@@ -0,0 +1,120 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "linalg.h"
+#include <include/threadpool.h>
+
+// read back everything written to a diagnostics stream
+static char* diag_read(FILE* f) {
+    long len = ftell(f);
+    char* text = calloc((size_t)len + 1, 1);
+    rewind(f);
+    assert(fread(text, 1, (size_t)len, f) == (size_t)len);
+    rewind(f);
+    return text;
+}
+
+static size_t diag_occurrences(const char* text, const char* needle) {
+    size_t n = 0;
+    for (const char* p = strstr(text, needle); p; p = strstr(p + 1, needle)) n++;
+    return n;
+}
+
+static void diag_warn_loop(size_t reports) {
+    for (size_t i = 0; i < reports; i++) {
+        LINALG_REPORT_WARN("diag test warning %zu", i);
+    }
+}
+
+void test_linalgDiagDedup() {
+    FILE* f = tmpfile();
+    assert(f);
+    linalgDiagSetStream(f);
+    size_t warns = linalgDiagCount(LINALG_DIAG_WARN);
+
+    diag_warn_loop(10);
+    // nothing is printed before the checkpoint
+    assert(ftell(f) == 0);
+    assert(linalgDiagCount(LINALG_DIAG_WARN) == warns + 10);
+
+    linalgDiagFlush();
+    char* text = diag_read(f);
+    assert(diag_occurrences(text, "diag test warning") == LINALG_DIAG_SITE_MESSAGES);
+    assert(strstr(text, "Warning: in function diag_warn_loop"));
+    // messages in report order, then the repeat count of the site
+    assert(strstr(text, "diag test warning 0") < strstr(text, "diag test warning 3"));
+    assert(strstr(text, "repeated 6 more times(") > strstr(text, "diag test warning 3"));
+    free(text);
+
+    // the budget starts over after a flush
+    f = freopen(NULL, "w+", f);
+    linalgDiagSetStream(f);
+    diag_warn_loop(2);
+    linalgDiagFlush();
+    text = diag_read(f);
+    assert(diag_occurrences(text, "diag test warning") == 2);
+    assert(!strstr(text, "repeated"));
+    free(text);
+
+    linalgDiagSetStream(NULL);
+    fclose(f);
+}
+
+static void diag_report_range(size_t begin, size_t end, void* ctx) {
+    (void)ctx;
+    for (size_t i = begin; i < end; i++) {
+        LINALG_REPORT_ERROR("diag test error %zu", i);
+    }
+}
+
+void test_linalgDiagThreads() {
+    FILE* f = tmpfile();
+    assert(f);
+    linalgDiagSetStream(f);
+    int threads = threadPoolThreads();
+    threadPoolSetThreads(4);
+    size_t errors = linalgDiagCount(LINALG_DIAG_ERROR);
+
+    // every thread reports into its own ring, all of them are counted
+    parallelFor(1000, 1, diag_report_range, NULL);
+    assert(linalgDiagCount(LINALG_DIAG_ERROR) == errors + 1000);
+
+    linalgDiagFlush();
+    char* text = diag_read(f);
+    assert(diag_occurrences(text, "diag test error") == LINALG_DIAG_SITE_MESSAGES);
+    assert(strstr(text, "repeated 996 more times("));
+    free(text);
+
+    threadPoolSetThreads(threads);
+    linalgDiagSetStream(NULL);
+    fclose(f);
+}
+
+void test_linalgDiagImmediate() {
+    FILE* f = tmpfile();
+    assert(f);
+    linalgDiagSetStream(f);
+    assert(linalgDiagSetMode(LINALG_DIAG_IMMEDIATE) == LINALG_DIAG_IMMEDIATE);
+
+    // errors from the library go through the same sink
+    Vec bad = vecInitA(1.0L, 0);
+    assert(bad.x == NULL);
+    assert(ftell(f) > 0);
+    char* text = diag_read(f);
+    assert(strstr(text, "Error: in function vecInitA"));
+    assert(strstr(text, "invalid zero length vector requested!"));
+    free(text);
+
+    assert(linalgDiagSetMode(7) == LINALG_DIAG_BUFFERED);
+    linalgDiagSetStream(NULL);
+    fclose(f);
+}
+
+int linalg_diag_test() {
+    test_linalgDiagDedup();
+    test_linalgDiagThreads();
+    test_linalgDiagImmediate();
+
+    printf("linalgDiag* functions passed all tests\n");
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include <assert.h>
+#include <math.h>
+#include "linalg.h"
+
+void test_mat2DSqPowU() {
+    Mat2d A = mat2DConstruct((long double[]){
+        1, -1, 0,
+        2,  0, 1,
+        0,  1, 1,
+    }, 3, 3);
+    Mat2d ref = mat2DInitZerosA(3, 3), tmp = mat2DInitZerosA(3, 3), P = mat2DInitA(NAN, 3, 3);
+    for (size_t i = 0; i < 3; i++) *mat2DRef(ref, i, i) = 1;
+
+    // integer entries, so every power is exact
+    for (unsigned int k = 0; k <= 9; k++) {
+        assert(mat2DSqPowU(A, k, &P) == LINALG_OK);
+        for (size_t i = 0; i < 3; i++)
+            for (size_t j = 0; j < 3; j++) assert(mat2DGet(P, i, j) == mat2DGet(ref, i, j));
+        assert(mat2DMul(ref, A, &tmp) == LINALG_OK);
+        Mat2d swap = ref; ref = tmp; tmp = swap;
+    }
+
+    // in place
+    Mat2d B = mat2DCopyA(A);
+    assert(mat2DSqPowU(B, 3, &B) == LINALG_OK);
+    assert(mat2DSqPowU(A, 3, &P) == LINALG_OK);
+    for (size_t i = 0; i < 9; i++) assert(mat2DGet(B, i / 3, i % 3) == mat2DGet(P, i / 3, i % 3));
+
+    Mat2d rect = mat2DInitOnesA(2, 3);
+    assert(mat2DSqPowU(rect, 2, &rect) == LINALG_ERROR);
+
+    freeMat2D(&ref), freeMat2D(&tmp), freeMat2D(&P), freeMat2D(&B), freeMat2D(&rect);
+}
+
+void test_mat2DExpm() {
+    // rotations: e^[[0, -w], [w, 0]] = [[cos w, -sin w], [sin w, cos w]], the norms cover every Pade degree and scaling
+    long double ws[] = {0.01L, 0.2L, 0.9L, 2, 20, -300};
+    for (size_t k = 0; k < sizeof(ws) / sizeof(ws[0]); k++) {
+        long double w = ws[k];
+        Mat2d A = mat2DConstruct((long double[]){0, -w, w, 0}, 2, 2);
+        Mat2d E = mat2DExpmA(A);
+        long double tol = 1e-18L * (1 + fabsl(w));
+        assert(fabsl(mat2DGet(E, 0, 0) - cosl(w)) < tol && fabsl(mat2DGet(E, 1, 1) - cosl(w)) < tol);
+        assert(fabsl(mat2DGet(E, 1, 0) - sinl(w)) < tol && fabsl(mat2DGet(E, 0, 1) + sinl(w)) < tol);
+        freeMat2D(&E);
+    }
+
+    // nilpotent and diagonal, in place
+    Mat2d N = mat2DConstruct((long double[]){0, 1, 0, 0, 0, 1, 0, 0, 0}, 3, 3);
+    Mat2d E = mat2DExpmA(N);
+    long double expect[] = {1, 1, 0.5L, 0, 1, 1, 0, 0, 1};
+    for (size_t i = 0; i < 9; i++) assert(fabsl(mat2DGet(E, i / 3, i % 3) - expect[i]) < 1e-18L);
+    Mat2d D = mat2DInitZerosA(3, 3);
+    *mat2DRef(D, 0, 0) = -40, *mat2DRef(D, 1, 1) = 0.5L, *mat2DRef(D, 2, 2) = 3;
+    assert(mat2DExpm(D, &D) == LINALG_OK);
+    assert(fabsl(mat2DGet(D, 0, 0) / expl(-40) - 1) < 1e-17L);
+    assert(fabsl(mat2DGet(D, 2, 2) / expl(3) - 1) < 1e-17L);
+    assert(mat2DGet(D, 0, 1) == 0);
+
+    freeMat2D(&E), freeMat2D(&D);
+}
+
+// master equation like generator(columns sum to 0), rates over several decades
+static long double expm_rate(size_t i, size_t j) {
+    return powl(10.0L, (long double)((i * 7 + j * 3) % 6) - 2);
+}
+
+void test_mat2DExpmv() {
+    size_t n = 12;
+    Mat2d A = mat2DInitZerosA(n, n);
+    for (size_t j = 0; j < n; j++) {
+        for (size_t i = 0; i < n; i++) {
+            if (i == j || (i + 1 != j && j + 1 != i && (i * j) % 3)) continue;
+            long double r = expm_rate(i, j);
+            *mat2DRef(A, i, j) += r;
+            *mat2DRef(A, j, j) -= r;
+        }
+    }
+    Vec v = vecInitZerosA(n);
+    v.x[0] = 1;
+
+    long double ts[] = {1e-3L, 1, 1e3L};
+    for (size_t k = 0; k < 3; k++) {
+        Mat2d tA = mat2DInitZerosA(n, n);
+        assert(mat2DScale(ts[k], A, &tA) == LINALG_OK);
+        Mat2d E = mat2DExpmA(tA);
+        Vec ref = mat2DTransformA(E, v);
+
+        Vec y = vecInitA(NAN, n);
+        assert(mat2DExpmv(A, ts[k], v, 8, 1e-14L, &y) == LINALG_OK);
+        for (size_t i = 0; i < n; i++) assert(fabsl(y.x[i] - ref.x[i]) < 1e-11L);
+        // probability is conserved
+        assert(fabsl(vecSum(y) - 1) < 1e-11L);
+
+        // sparse operator, in place
+        MatCSR S = matCSRFromMat2DA(A, 0);
+        Vec z = vecCopyA(v);
+        assert(matCSRExpmv(S, ts[k], z, 8, 1e-14L, &z) == LINALG_OK);
+        for (size_t i = 0; i < n; i++) assert(fabsl(z.x[i] - y.x[i]) < 1e-11L);
+
+        freeMatCSR(&S);
+        freeMat2D(&tA), freeMat2D(&E);
+        freeVec(&ref), freeVec(&y), freeVec(&z);
+    }
+
+    // t = 0 and an invariant subspace(happy breakdown on the first vector)
+    Vec y = vecInitZerosA(n);
+    assert(mat2DExpmv(A, 0, v, 8, 1e-12L, &y) == LINALG_OK);
+    assert(y.x[0] == 1 && y.x[1] == 0);
+    Mat2d I = mat2DInitZerosA(n, n);
+    for (size_t i = 0; i < n; i++) *mat2DRef(I, i, i) = 2;
+    assert(mat2DExpmv(I, 1, v, 8, 1e-12L, &y) == LINALG_OK);
+    assert(fabsl(y.x[0] - expl(2)) < 1e-15L && y.x[1] == 0);
+    assert(mat2DExpmv(A, 1, v, 0, 1e-12L, &y) == LINALG_ERROR);
+
+    freeMat2D(&A), freeMat2D(&I);
+    freeVec(&v), freeVec(&y);
+}
+
+int linalg_expm_test() {
+    test_mat2DSqPowU();
+    test_mat2DExpm();
+    test_mat2DExpmv();
+
+    printf("mat2DSqPowU/expm functions passed all tests\n");
+    return 0;
+}
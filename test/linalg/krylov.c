@@ -0,0 +1,151 @@
+#include <assert.h>
+#include <math.h>
+#include "linalg.h"
+
+// nonsymmetric convection-diffusion like stencil with a few long range couplings, diagonally dominant
+static Mat2d krylov_test_matrix(size_t n) {
+    Mat2d A = mat2DInitZerosA(n, n);
+    for (size_t i = 0; i < n; i++) {
+        *mat2DRef(A, i, i) = 4 + 0.01L * i;
+        if (i > 0) *mat2DRef(A, i, i - 1) = -1.5L;
+        if (i + 1 < n) *mat2DRef(A, i, i + 1) = -0.5L;
+        if (i + 7 < n) *mat2DRef(A, i, i + 7) = 0.3L;
+        if (i >= 11) *mat2DRef(A, i, i - 11) = -0.2L;
+    }
+    return A;
+}
+
+static long double krylov_test_diff(Vec a, Vec b) {
+    long double d = 0;
+    for (size_t i = 0; i < a.len; i++) d = fmaxl(d, fabsl(vecGet(a, i) - vecGet(b, i)));
+    return d;
+}
+
+void test_matCSRILU0() {
+    size_t n = 30;
+    Mat2d A = krylov_test_matrix(n);
+    MatCSR csr = matCSRFromMat2DA(A, 0);
+
+    // a tridiagonal matrix has no fill, so ILU(0) is the exact LU
+    Mat2d T = mat2DInitZerosA(n, n);
+    for (size_t i = 0; i < n; i++) {
+        *mat2DRef(T, i, i) = 3;
+        if (i > 0) *mat2DRef(T, i, i - 1) = -1;
+        if (i + 1 < n) *mat2DRef(T, i, i + 1) = -0.5L;
+    }
+    MatCSR tcsr = matCSRFromMat2DA(T, 0);
+    MatCSR tlu = matCSRILU0A(tcsr);
+    assert(tlu.rowptr && tlu.nnz == tcsr.nnz);
+    Vec b = vecInitZerosA(n), x = vecInitZerosA(n), y = vecInitZerosA(n);
+    for (size_t i = 0; i < n; i++) b.x[i] = sinl(i + 1);
+    assert(matCSRILU0Solve(tlu, b, &x) == LINALG_OK);
+    assert(matCSRTransform(tcsr, x, &y) == LINALG_OK);
+    assert(krylov_test_diff(y, b) < 1e-15L);
+    // in place
+    assert(matCSRILU0Solve(tlu, y, &y) == LINALG_OK);
+    assert(krylov_test_diff(y, x) < 1e-15L);
+
+    // jacobi on both representations
+    Vec d1 = matCSRJacobiA(csr), d2 = mat2DJacobiA(A);
+    for (size_t i = 0; i < n; i++) assert(d1.x[i] == 1 / mat2DGet(A, i, i) && d1.x[i] == d2.x[i]);
+
+    // missing diagonal entry
+    *mat2DRef(T, 3, 3) = 0;
+    MatCSR bad = matCSRFromMat2DA(T, 0);
+    MatCSR badlu = matCSRILU0A(bad);
+    assert(!badlu.rowptr);
+    Vec badd = matCSRJacobiA(bad);
+    assert(!badd.x);
+
+    freeMat2D(&A), freeMat2D(&T);
+    freeMatCSR(&csr), freeMatCSR(&tcsr), freeMatCSR(&tlu), freeMatCSR(&bad);
+    freeVec(&b), freeVec(&x), freeVec(&y), freeVec(&d1), freeVec(&d2);
+}
+
+void test_linalgKrylov() {
+    size_t n = 60;
+    Mat2d A = krylov_test_matrix(n);
+    MatCSR csr = matCSRFromMat2DA(A, 0);
+    MatCSR ilu = matCSRILU0A(csr);
+    Vec jac = matCSRJacobiA(csr);
+    Vec b = vecInitZerosA(n), ref = vecInitZerosA(n), x = vecInitZerosA(n);
+    for (size_t i = 0; i < n; i++) b.x[i] = cosl(0.3L * i) + 0.1L;
+
+    MatLU lu = matLUFactorA(A);
+    assert(matLUSolve(lu, b, &ref) == LINALG_OK);
+
+    LinalgOperator ops[] = {linalgOperatorMat2D(&A), linalgOperatorCSR(&csr)};
+    LinalgOperator pcs[] = {{NULL, NULL}, linalgOperatorJacobi(&jac), linalgOperatorILU0(&ilu)};
+    LinalgKrylovConfig config = {1e-14L, 500, 20};
+    for (size_t o = 0; o < 2; o++) {
+        size_t its_gmres[3], its_bicg[3];
+        for (size_t p = 0; p < 3; p++) {
+            LinalgKrylovInfo info;
+            for (size_t i = 0; i < n; i++) x.x[i] = 0;
+            assert(linalgGMRES(ops[o], pcs[p], b, &x, config, &info) == LINALG_OK);
+            assert(info.residual <= 1e-14L && krylov_test_diff(x, ref) < 1e-12L);
+            its_gmres[p] = info.iterations;
+
+            for (size_t i = 0; i < n; i++) x.x[i] = 0;
+            assert(linalgBiCGSTAB(ops[o], pcs[p], b, &x, config, &info) == LINALG_OK);
+            assert(info.residual <= 1e-14L && krylov_test_diff(x, ref) < 1e-12L);
+            its_bicg[p] = info.iterations;
+        }
+        // ILU(0) is close to the exact inverse here
+        assert(its_gmres[2] < its_gmres[0] && its_bicg[2] < its_bicg[0]);
+    }
+
+    // starting at the solution needs no iterations, b = 0 gives x = 0
+    LinalgKrylovInfo info;
+    assert(linalgGMRES(ops[1], pcs[0], b, &ref, config, &info) == LINALG_OK);
+    assert(info.iterations <= 1);
+    Vec zero = vecInitZerosA(n);
+    assert(linalgBiCGSTAB(ops[1], pcs[0], zero, &x, config, NULL) == LINALG_OK);
+    assert(vecMaxAbs(x) == 0);
+
+    // not converged in the iteration limit
+    for (size_t i = 0; i < n; i++) x.x[i] = 0;
+    assert(linalgGMRES(ops[1], pcs[0], b, &x, (LinalgKrylovConfig){1e-14L, 3, 20}, &info) == LINALG_ERROR);
+    assert(info.iterations == 3 && info.residual > 1e-14L);
+    assert(linalgGMRES(ops[1], pcs[0], b, &x, (LinalgKrylovConfig){1e-14L, 10, 0}, NULL) == LINALG_ERROR);
+
+    freeMat2D(&A), freeMatCSR(&csr), freeMatCSR(&ilu), freeMatLU(&lu);
+    freeVec(&jac), freeVec(&b), freeVec(&ref), freeVec(&x), freeVec(&zero);
+}
+
+void test_linalgKrylovMasterEquation() {
+    // steady state of a birth-death chain with the normalization in the first row, like the rate equations in main
+    size_t n = 40;
+    Mat2d A = mat2DInitZerosA(n, n);
+    for (size_t i = 0; i + 1 < n; i++) {
+        long double up = 1 + 0.05L * i, down = 1.3L;
+        *mat2DRef(A, i + 1, i) += up, *mat2DRef(A, i, i) -= up;
+        *mat2DRef(A, i, i + 1) += down, *mat2DRef(A, i + 1, i + 1) -= down;
+    }
+    for (size_t j = 0; j < n; j++) *mat2DRef(A, 0, j) = 1;
+    Vec b = vecInitZerosA(n), ref = vecInitZerosA(n), x = vecInitZerosA(n);
+    b.x[0] = 1;
+
+    MatLU lu = matLUFactorA(A);
+    assert(matLUSolve(lu, b, &ref) == LINALG_OK);
+    MatCSR csr = matCSRFromMat2DA(A, 0);
+    MatCSR ilu = matCSRILU0A(csr);
+    assert(ilu.rowptr);
+
+    LinalgKrylovInfo info;
+    assert(linalgGMRES(linalgOperatorCSR(&csr), linalgOperatorILU0(&ilu), b, &x, (LinalgKrylovConfig){1e-13L, 200, 40}, &info) == LINALG_OK);
+    assert(krylov_test_diff(x, ref) < 1e-12L);
+    assert(fabsl(vecSum(x) - 1) < 1e-12L);
+
+    freeMat2D(&A), freeMatCSR(&csr), freeMatCSR(&ilu), freeMatLU(&lu);
+    freeVec(&b), freeVec(&ref), freeVec(&x);
+}
+
+int linalg_krylov_test() {
+    test_matCSRILU0();
+    test_linalgKrylov();
+    test_linalgKrylovMasterEquation();
+
+    printf("matCSRILU0/GMRES/BiCGSTAB functions passed all tests\n");
+    return 0;
+}
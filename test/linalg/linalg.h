@@ -3,3 +3,14 @@
 
 int linalg_vec_test();
 int linalg_matrix_test();
+int linalg_precision_test();
+int linalg_simd_test();
+int linalg_validation_test();
+int linalg_arena_test();
+int linalg_lu_test();
+int linalg_sparse_test();
+int linalg_banded_test();
+int linalg_expm_test();
+int linalg_krylov_test();
+int linalg_batch_test();
+int linalg_diag_test();
@@ -0,0 +1,212 @@
+#include <assert.h>
+#include <math.h>
+#include "linalg.h"
+
+#define LU_TOL 1e-15L
+
+// needs pivoting: the leading entry is 0
+static long double lu_test_mat[] = {
+    0, 2, 1,
+    1, 1, 1,
+    4, 3, 9,
+};
+
+void test_matLUSolve() {
+    Mat2d A = mat2DConstruct(lu_test_mat, 3, 3);
+    MatLU lu = matLUFactorA(A);
+    assert(lu.singular == 0);
+    assert(A.mat[0] == 0); // input untouched
+
+    // b = A*[1, -2, 3]
+    Vec b = vecConstruct((long double[]){-1, 2, 25}, 3);
+    Vec x = vecInitZerosA(3);
+    assert(matLUSolve(lu, b, &x) == LINALG_OK);
+    assert(fabsl(x.x[0] - 1) < LU_TOL && fabsl(x.x[1] + 2) < LU_TOL && fabsl(x.x[2] - 3) < LU_TOL);
+
+    // in place, x == b
+    Vec bb = vecCopyA(b);
+    assert(matLUSolve(lu, bb, &bb) == LINALG_OK);
+    for (size_t i = 0; i < 3; i++) assert(bb.x[i] == x.x[i]);
+
+    Vec bad = vecInitZerosA(2);
+    assert(matLUSolve(lu, bad, &x) == LINALG_ERROR);
+
+    freeVec(&x);
+    freeVec(&bb);
+    freeVec(&bad);
+    freeMatLU(&lu);
+    assert(lu.perm == NULL && lu.lu.mat == NULL);
+}
+
+void test_matLUSolveMulti() {
+    Mat2d A = mat2DConstruct(lu_test_mat, 3, 3);
+    MatLU lu = matLUInitA(3);
+    assert(lu.singular == 1);
+    // assemble into the LU storage and factor in place
+    for (size_t i = 0; i < 9; i++) *mat2DRef(lu.lu, i / 3, i % 3) = lu_test_mat[i];
+    assert(matLUFactor(lu.lu, &lu) == LINALG_OK);
+
+    // A * A^-1 = I
+    Mat2d inv = mat2DInitZerosA(3, 3);
+    for (size_t i = 0; i < 3; i++) *mat2DRef(inv, i, i) = 1;
+    assert(matLUSolveMulti(lu, inv, &inv) == LINALG_OK);
+    Mat2d I = mat2DMulA(A, inv);
+    for (size_t i = 0; i < 3; i++)
+        for (size_t j = 0; j < 3; j++) assert(fabsl(mat2DGet(I, i, j) - (i == j)) < LU_TOL);
+
+    // the exact 1-norm condition number, the estimate never overshoots and is exact for small matrices
+    long double inv_norm = 0, a_norm = 0;
+    for (size_t j = 0; j < 3; j++) {
+        long double s = 0, t = 0;
+        for (size_t i = 0; i < 3; i++) s += fabsl(mat2DGet(inv, i, j)), t += fabsl(mat2DGet(A, i, j));
+        inv_norm = s > inv_norm ? s : inv_norm;
+        a_norm = t > a_norm ? t : a_norm;
+    }
+    long double est = matLUCond1Est(lu);
+    assert(est <= a_norm * inv_norm * (1 + LU_TOL));
+    assert(est >= 0.3L * a_norm * inv_norm);
+
+    freeMat2D(&inv);
+    freeMat2D(&I);
+    freeMatLU(&lu);
+}
+
+void test_matLUCond1Est() {
+    // diagonal: cond = max/min
+    Mat2d D = mat2DInitZerosA(4, 4);
+    long double diag[] = {2, -8, 0.5, 4};
+    for (size_t i = 0; i < 4; i++) *mat2DRef(D, i, i) = diag[i];
+    MatLU lu = matLUFactorA(D);
+    assert(fabsl(matLUCond1Est(lu) - 16) < 1e-12L);
+    freeMatLU(&lu);
+
+    // singular
+    *mat2DRef(D, 1, 1) = 0;
+    lu = matLUFactorA(D);
+    assert(lu.singular == 1);
+    assert(isinf(matLUCond1Est(lu)));
+    Vec b = vecInitOnesA(4);
+    assert(matLUSolve(lu, b, &b) == LINALG_ERROR);
+    freeVec(&b);
+    freeMatLU(&lu);
+    freeMat2D(&D);
+}
+
+// factor and solve through views of a bigger matrix
+void test_matLUView() {
+    Mat2d big = mat2DInitA(NAN, 5, 6);
+    Mat2d A = mat2DView(big, 1, 2, 3, 3);
+    for (size_t i = 0; i < 9; i++) *mat2DRef(A, i / 3, i % 3) = lu_test_mat[i];
+    MatLU lu = matLUFactorA(A);
+    assert(lu.singular == 0);
+
+    // rhs and solution are the first two columns of big
+    Mat2d B = mat2DView(big, 1, 0, 3, 2);
+    for (size_t i = 0; i < 3; i++) *mat2DRef(B, i, 0) = lu_test_mat[i * 3], *mat2DRef(B, i, 1) = lu_test_mat[i * 3 + 1];
+    assert(matLUSolveMulti(lu, B, &B) == LINALG_OK);
+    for (size_t i = 0; i < 3; i++) {
+        assert(fabsl(mat2DGet(B, i, 0) - (i == 0)) < LU_TOL);
+        assert(fabsl(mat2DGet(B, i, 1) - (i == 1)) < LU_TOL);
+    }
+    assert(isnan(mat2DGet(big, 0, 0)) && isnan(mat2DGet(big, 4, 1)));
+
+    freeMatLU(&lu);
+    freeMat2D(&big);
+}
+
+// large enough for the blocked, threaded factorization(several panels and a partial last one)
+void test_matLUBlocked() {
+    int threads = linalgParallelThreads();
+    size_t n = 300;
+    Mat2d A = mat2DInitZerosA(n, n);
+    unsigned long seed = 12345;
+    for (size_t i = 0; i < n * n; i++) {
+        seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+        *mat2DRef(A, i / n, i % n) = (long double)(seed >> 33) / (1UL << 31) - 0.5L;
+    }
+    Vec b = vecInitZerosA(n);
+    for (size_t i = 0; i < n; i++) b.x[i] = (long double)(i % 7) - 3;
+
+    for (int t = 1; t <= 3; t += 2) {
+        linalgParallelSetThreads(t);
+        MatLU lu = matLUFactorA(A);
+        assert(lu.singular == 0);
+        Vec x = vecInitZerosA(n);
+        assert(matLUSolve(lu, b, &x) == LINALG_OK);
+        Vec r = mat2DTransformA(A, x);
+        assert(vecSub(r, b, &r) == LINALG_OK);
+        assert(vecMaxAbs(r) < 1e-12L);
+        freeVec(&x);
+        freeVec(&r);
+        freeMatLU(&lu);
+    }
+    linalgParallelSetThreads(threads);
+    freeVec(&b);
+    freeMat2D(&A);
+}
+
+void test_matLUDSolveRefined() {
+    // the rate matrix of test_gaussianElimination: entries from 1e6 to 6e9, right side near 1e-15
+    Mat2d A = mat2DConstruct((long double[]){
+        -3355751630.7723111, 3354626279.0251185, 1125351.7471925912,
+        3354626279.0251185, -6709252558.0502371, 3354626279.0251185,
+        1125351.7471925912, 3354626279.0251185, -3355751630.7723111,
+    }, 3, 3);
+    Vec b = vecConstruct((long double[]){3.5527165483724359e-15, 2.8695719349316226e-21, 3.5527165483724359e-15}, 3);
+    Vec ref = vecInitZerosA(3), x = vecInitZerosA(3);
+    MatLU lu = matLUFactorA(A);
+    assert(matLUSolve(lu, b, &ref) == LINALG_OK);
+    MatLUD lud = matLUDInitA(3);
+    assert(matLUDFactor(A, &lud) == LINALG_OK);
+    assert(matLUDSolveRefined(lud, A, b, &x) == LINALG_OK);
+    for (size_t i = 0; i < 3; i++) assert(fabsl(x.x[i] - ref.x[i]) <= 1e-15L * fabsl(ref.x[i]));
+    freeMatLU(&lu), freeMatLUD(&lud), freeVec(&ref), freeVec(&x);
+
+    // integer system with an exact integer solution, beyond double accuracy after refinement
+    size_t n = 40;
+    Mat2d B = mat2DInitZerosA(n, n);
+    Vec exact = vecInitZerosA(n), c = vecInitZerosA(n);
+    for (size_t i = 0; i < n; i++) {
+        exact.x[i] = (long double)(i % 7) - 3;
+        for (size_t j = 0; j < n; j++) *mat2DRef(B, i, j) = (long double)((i * 31 + j * 17) % 23) - 11 + (i == j ? 40 : 0);
+    }
+    assert(mat2DTransform(B, exact, &c) == LINALG_OK);
+    lud = matLUDInitA(n);
+    assert(matLUDFactor(B, &lud) == LINALG_OK);
+    // in place
+    assert(matLUDSolveRefined(lud, B, c, &c) == LINALG_OK);
+    for (size_t i = 0; i < n; i++) assert(fabsl(c.x[i] - exact.x[i]) <= 1e-17L);
+    freeMatLUD(&lud);
+
+    // Hilbert 14(cond ~ 1e19) is out of reach of a double factorization
+    n = 14;
+    Mat2d H = mat2DInitZerosA(n, n);
+    Vec h = vecInitOnesA(n), y = vecInitZerosA(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) *mat2DRef(H, i, j) = 1.0L / (i + j + 1);
+    lud = matLUDInitA(n);
+    matLUDFactor(H, &lud);
+    assert(lud.singular || matLUDSolveRefined(lud, H, h, &y) == LINALG_ERROR);
+
+    // singular and mismatched
+    Mat2d S = mat2DInitOnesA(3, 3);
+    MatLUD sing = matLUDInitA(3);
+    assert(matLUDFactor(S, &sing) == LINALG_ERROR && sing.singular);
+    assert(matLUDSolveRefined(sing, S, b, &b) == LINALG_ERROR);
+    assert(matLUDFactor(B, &sing) == LINALG_ERROR);
+
+    freeMat2D(&B), freeMat2D(&H), freeMat2D(&S), freeMatLUD(&lud), freeMatLUD(&sing);
+    freeVec(&exact), freeVec(&c), freeVec(&h), freeVec(&y);
+}
+
+int linalg_lu_test() {
+    test_matLUSolve();
+    test_matLUSolveMulti();
+    test_matLUCond1Est();
+    test_matLUView();
+    test_matLUBlocked();
+    test_matLUDSolveRefined();
+
+    printf("matLU*/matLUD* functions passed all tests\n");
+    return 0;
+}
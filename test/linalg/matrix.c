@@ -1,13 +1,14 @@
 #include <assert.h>
 #include <math.h>
+#include <stdint.h>
 #include "linalg.h"
 
 void test_mat2DInitA() {
     Mat2d mat = mat2DInitA(5.0, 3, 4);
     assert(mat.rows == 3);
     assert(mat.cols == 4);
-    for (size_t i = 0; i < mat.rows * mat.cols; i++) {
-        assert(mat.mat[i] == 5.0);
+    for (size_t i = 0; i < mat.rows; i++) {
+        for (size_t j = 0; j < mat.cols; j++) assert(mat2DGet(mat, i, j) == 5.0);
     }
     freeMat2D(&mat);
 
@@ -22,8 +23,8 @@ void test_mat2DInitZerosA() {
     Mat2d mat = mat2DInitZerosA(2, 3);
     assert(mat.rows == 2);
     assert(mat.cols == 3);
-    for (size_t i = 0; i < mat.rows * mat.cols; i++) {
-        assert(mat.mat[i] == 0.0);
+    for (size_t i = 0; i < mat.rows; i++) {
+        for (size_t j = 0; j < mat.cols; j++) assert(mat2DGet(mat, i, j) == 0.0);
     }
     freeMat2D(&mat);
 }
@@ -32,8 +33,8 @@ void test_mat2DInitOnesA() {
     Mat2d mat = mat2DInitOnesA(3, 2);
     assert(mat.rows == 3);
     assert(mat.cols == 2);
-    for (size_t i = 0; i < mat.rows * mat.cols; i++) {
-        assert(mat.mat[i] == 1.0);
+    for (size_t i = 0; i < mat.rows; i++) {
+        for (size_t j = 0; j < mat.cols; j++) assert(mat2DGet(mat, i, j) == 1.0);
     }
     freeMat2D(&mat);
 }
@@ -43,14 +44,14 @@ void test_mat2DCopyA() {
     Mat2d copy = mat2DCopyA(original);
     assert(copy.rows == original.rows);
     assert(copy.cols == original.cols);
-    for (size_t i = 0; i < original.rows * original.cols; i++) {
-        assert(copy.mat[i] == original.mat[i]);
+    for (size_t i = 0; i < original.rows; i++) {
+        for (size_t j = 0; j < original.cols; j++) assert(mat2DGet(copy, i, j) == mat2DGet(original, i, j));
     }
     freeMat2D(&original);
     freeMat2D(&copy);
 
     // Test copying invalid matrix
-    Mat2d invalid_mat = {NULL, 0, 0};
+    Mat2d invalid_mat = {NULL, 0, 0, 0};
     Mat2d invalid_copy = mat2DCopyA(invalid_mat);
     assert(invalid_copy.mat == NULL);
     assert(invalid_copy.rows == 0);
@@ -63,6 +64,71 @@ void test_mat2DConstruct() {
     assert(mat.rows == 2);
     assert(mat.cols == 2);
     assert(mat.mat == data);
+    assert(mat.ld == 2);
+}
+
+// allocated rows start on LINALG_ALIGN boundaries, kernels mix padded and contiguous(ld == cols) matrices
+void test_mat2DPadding() {
+    Mat2d a = mat2DInitUninitA(3, 5);
+    assert(a.rows == 3 && a.cols == 5);
+    assert(a.ld >= a.cols && a.ld % LINALG_MAT_PAD == 0);
+    for (size_t i = 0; i < a.rows; i++) assert((uintptr_t)mat2DRef(a, i, 0) % LINALG_ALIGN == 0);
+    for (size_t i = 0; i < 15; i++) *mat2DRef(a, i / 5, i % 5) = (long double)i;
+
+    long double data[15];
+    Mat2d b = mat2DConstruct(data, 3, 5);
+    for (size_t i = 0; i < 15; i++) data[i] = 1;
+    Mat2d sum = mat2DInitUninitA(3, 5);
+    assert(mat2DAdd(a, b, &sum) == LINALG_OK);
+    Mat2d copy = mat2DCopyA(sum);
+    for (size_t i = 0; i < 15; i++) assert(mat2DGet(copy, i / 5, i % 5) == i + 1);
+    assert(mat2DMax(copy) == 15 && mat2DMin(copy) == 1);
+
+    // a column view steps over the padding
+    Vec col = mat2DCol(copy, 4);
+    assert(col.offset == copy.ld && vecGet(col, 2) == 15);
+
+    Vec v = vecInitUninitA(7);
+    assert(v.len == 7 && (uintptr_t)v.x % LINALG_ALIGN == 0);
+    assert(vecInitUninitA(0).x == NULL);
+
+    freeMat2D(&a);
+    freeMat2D(&sum);
+    freeMat2D(&copy);
+    freeVec(&v);
+}
+
+// views share storage with their parent and every kernel honours their ld
+void test_mat2DView() {
+    Mat2d A = mat2DInitZerosA(6, 7);
+    for (size_t i = 0; i < 42; i++) *mat2DRef(A, i / 7, i % 7) = (long double)((i * 5) % 9) - 4;
+
+    Mat2d V = mat2DView(A, 1, 2, 3, 4);
+    assert(V.rows == 3 && V.cols == 4 && V.ld == A.ld);
+    assert(mat2DRef(V, 0, 0) == mat2DRef(A, 1, 2));
+    assert(mat2DView(A, 4, 0, 3, 1).mat == NULL);
+    assert(mat2DView(A, 0, 5, 1, 3).mat == NULL);
+    assert(mat2DConstructStrided(A.mat, 2, 8, 7).mat == NULL);
+
+    // products on views against the copied blocks
+    Mat2d W = mat2DView(A, 2, 0, 4, 3);
+    Mat2d Vc = mat2DCopyA(V), Wc = mat2DCopyA(W);
+    Mat2d P = mat2DMulA(V, W), Pc = mat2DMulA(Vc, Wc);
+    Vec x = vecInitOnesA(4);
+    Vec y = mat2DTransformA(V, x), yc = mat2DTransformA(Vc, x);
+    for (size_t i = 0; i < 3; i++) {
+        assert(y.x[i] == yc.x[i]);
+        for (size_t j = 0; j < 3; j++) assert(mat2DGet(P, i, j) == mat2DGet(Pc, i, j));
+    }
+
+    // writing into a view only touches the block
+    Mat2d S = mat2DView(A, 0, 0, 3, 4);
+    assert(mat2DScale(0, S, &S) == LINALG_OK);
+    assert(mat2DGet(A, 2, 3) == 0 && mat2DGet(A, 0, 4) == (long double)((4 * 5) % 9) - 4);
+    assert(mat2DMaxAbs(S) == 0);
+
+    freeMat2D(&A), freeMat2D(&Vc), freeMat2D(&Wc), freeMat2D(&P), freeMat2D(&Pc);
+    freeVec(&x), freeVec(&y), freeVec(&yc);
 }
 
 void test_mat2DGet() {
@@ -86,8 +152,8 @@ void test_mat2DAdd() {
     Mat2d b = mat2DInitA(2.0, 2, 2);
     Mat2d result = mat2DInitZerosA(2, 2);
     assert(mat2DAdd(a, b, &result) == LINALG_OK);
-    for (size_t i = 0; i < a.rows * a.cols; i++) {
-        assert(result.mat[i] == 3.0);
+    for (size_t i = 0; i < a.rows; i++) {
+        for (size_t j = 0; j < a.cols; j++) assert(mat2DGet(result, i, j) == 3.0);
     }
     freeMat2D(&a);
     freeMat2D(&b);
@@ -104,8 +170,8 @@ void test_mat2DSub() {
     Mat2d b = mat2DInitA(1.0, 2, 2);
     Mat2d result = mat2DInitZerosA(2, 2);
     assert(mat2DSub(a, b, &result) == LINALG_OK);
-    for (size_t i = 0; i < a.rows * a.cols; i++) {
-        assert(result.mat[i] == 2.0);
+    for (size_t i = 0; i < a.rows; i++) {
+        for (size_t j = 0; j < a.cols; j++) assert(mat2DGet(result, i, j) == 2.0);
     }
     freeMat2D(&a);
     freeMat2D(&b);
@@ -116,8 +182,8 @@ void test_mat2DScale() {
     Mat2d a = mat2DInitA(2.0, 2, 2);
     Mat2d result = mat2DInitZerosA(2, 2);
     assert(mat2DScale(3.0, a, &result) == LINALG_OK);
-    for (size_t i = 0; i < a.rows * a.cols; i++) {
-        assert(result.mat[i] == 6.0);
+    for (size_t i = 0; i < a.rows; i++) {
+        for (size_t j = 0; j < a.cols; j++) assert(mat2DGet(result, i, j) == 6.0);
     }
     freeMat2D(&a);
     freeMat2D(&result);
@@ -131,7 +197,7 @@ void test_mat2DMax() {
     freeMat2D(&mat);
 
     // Test with empty matrix
-    Mat2d empty_mat = {NULL, 0, 0};
+    Mat2d empty_mat = {NULL, 0, 0, 0};
     assert(isnan(mat2DMax(empty_mat)));
 }
 
@@ -143,16 +209,133 @@ void test_mat2DMin() {
     freeMat2D(&mat);
 
     // Test with empty matrix
-    Mat2d empty_mat = {NULL, 0, 0};
+    Mat2d empty_mat = {NULL, 0, 0, 0};
     assert(isnan(mat2DMin(empty_mat)));
 }
 
+// compare against the plain triple loop, small integer entries keep the sums exact
+void test_mat2DMulSize(size_t m, size_t k, size_t n) {
+    Mat2d A = mat2DInitZerosA(m, k);
+    Mat2d B = mat2DInitZerosA(k, n);
+    for (size_t i = 0; i < m * k; i++) *mat2DRef(A, i / k, i % k) = (long double)((i * 7) % 11) - 5;
+    for (size_t i = 0; i < k * n; i++) *mat2DRef(B, i / n, i % n) = (long double)((i * 5) % 13) - 6;
+
+    Mat2d C = mat2DInitA(NAN, m, n);
+    assert(mat2DMul(A, B, &C) == LINALG_OK);
+    Mat2d D = mat2DMulA(A, B);
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < n; j++) {
+            long double ref = 0;
+            for (size_t p = 0; p < k; p++) ref += mat2DGet(A, i, p) * mat2DGet(B, p, j);
+            assert(mat2DGet(C, i, j) == ref);
+            assert(mat2DGet(D, i, j) == ref);
+        }
+    }
+    freeMat2D(&A);
+    freeMat2D(&B);
+    freeMat2D(&C);
+    freeMat2D(&D);
+}
+
+void test_mat2DMul() {
+    int threads = linalgParallelThreads();
+    test_mat2DMulSize(3, 2, 4);
+    // edges that are not multiples of the register/cache blocks, k spans 2 panels
+    test_mat2DMulSize(53, 131, 37);
+    // large enough for the threaded path
+    linalgParallelSetThreads(1);
+    test_mat2DMulSize(150, 130, 70);
+    linalgParallelSetThreads(4);
+    test_mat2DMulSize(150, 130, 70);
+    linalgParallelSetThreads(threads);
+
+    Mat2d a = mat2DInitOnesA(2, 3);
+    Mat2d bad = mat2DInitOnesA(2, 3);
+    assert(mat2DMul(a, a, &bad) == LINALG_ERROR);
+    Mat2d sq = mat2DInitOnesA(3, 3);
+    assert(mat2DMul(sq, sq, &sq) == LINALG_ERROR);
+    freeMat2D(&a);
+    freeMat2D(&bad);
+    freeMat2D(&sq);
+}
+
+// A^T x against mat2DTransform on the materialized transpose
+void test_mat2DTransformTSize(size_t rows, size_t cols) {
+    Mat2d A = mat2DInitZerosA(rows, cols);
+    for (size_t i = 0; i < rows * cols; i++) *mat2DRef(A, i / cols, i % cols) = (long double)((i * 7) % 11) - 5;
+    Mat2d At = mat2DInitZerosA(cols, rows);
+    assert(mat2DTranspose(A, &At) == LINALG_OK);
+    Vec x = vecInitZerosA(rows);
+    for (size_t i = 0; i < rows; i++) x.x[i] = (long double)(i % 5) - 2;
+
+    Vec ref = mat2DTransformA(At, x);
+    Vec result = vecInitA(NAN, cols);
+    assert(mat2DTransformT(A, x, &result) == LINALG_OK);
+    Vec result_a = mat2DTransformTA(A, x);
+    for (size_t j = 0; j < cols; j++) {
+        assert(result.x[j] == ref.x[j]);
+        assert(result_a.x[j] == ref.x[j]);
+    }
+    freeMat2D(&A);
+    freeMat2D(&At);
+    freeVec(&x);
+    freeVec(&ref);
+    freeVec(&result);
+    freeVec(&result_a);
+}
+
+void test_mat2DTransformT() {
+    int threads = linalgParallelThreads();
+    test_mat2DTransformTSize(3, 2);
+    // large enough for the per-thread partial sums
+    linalgParallelSetThreads(1);
+    test_mat2DTransformTSize(600, 500);
+    linalgParallelSetThreads(3);
+    test_mat2DTransformTSize(600, 500);
+    linalgParallelSetThreads(threads);
+
+    // strided result(column view)
+    Mat2d A = mat2DInitOnesA(2, 3);
+    Mat2d out = mat2DInitZerosA(3, 2);
+    Vec x = vecInitOnesA(2);
+    Vec col = mat2DCol(out, 1);
+    assert(mat2DTransformT(A, x, &col) == LINALG_OK);
+    for (size_t i = 0; i < 3; i++) assert(mat2DGet(out, i, 0) == 0.0L && mat2DGet(out, i, 1) == 2.0L);
+
+    Vec bad = vecInitOnesA(2);
+    assert(mat2DTransformT(A, x, &bad) == LINALG_ERROR);
+    freeMat2D(&A);
+    freeMat2D(&out);
+    freeVec(&x);
+    freeVec(&bad);
+}
+
+void test_mat2DDiffNorms() {
+    // padded rows: only the cols values count
+    Mat2d a = mat2DInitA(2, 3, 5), b = mat2DInitA(2, 3, 5);
+    *mat2DRef(b, 2, 4) = -4;
+    *mat2DRef(a, 0, 0) = 2.5L;
+    LinalgDiffNorms d = mat2DDiffNorms(a, b);
+    assert(d.max_diff == 6 && d.rel_max == 6.0L / 4 && !d.nonfinite);
+    assert(fabsl(d.rms_diff - sqrtl((36 + 0.25L) / 15)) < 1e-18L);
+
+    Mat2d v = mat2DView(a, 1, 1, 2, 2), w = mat2DView(b, 1, 1, 2, 2);
+    assert(mat2DDiffNorms(v, w).max_diff == 0);
+    *mat2DRef(a, 1, 2) = NAN;
+    assert(mat2DDiffNorms(v, w).nonfinite);
+    assert(mat2DDiffNorms(v, b).nonfinite);
+
+    freeMat2D(&a), freeMat2D(&b);
+}
+
 int linalg_matrix_test() {
     test_mat2DInitA();
     test_mat2DInitZerosA();
     test_mat2DInitOnesA();
     test_mat2DCopyA();
     test_mat2DConstruct();
+    test_mat2DPadding();
+    test_mat2DView();
     test_mat2DGet();
     test_mat2DRef();
     test_mat2DAdd();
@@ -160,6 +343,9 @@ int linalg_matrix_test() {
     test_mat2DScale();
     test_mat2DMax();
     test_mat2DMin();
+    test_mat2DMul();
+    test_mat2DTransformT();
+    test_mat2DDiffNorms();
 
     printf("mat2D* functions passed all tests\n");
     return 0;
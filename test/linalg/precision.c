@@ -0,0 +1,160 @@
+#include <assert.h>
+#include <math.h>
+#include "linalg.h"
+
+void test_vecDFamily() {
+    VecD a = vecDInitA(2.0, 5);
+    VecD b = vecDInitA(3.0, 5);
+    VecD result = vecDInitZerosA(5);
+    assert(vecDAdd(a, b, &result) == LINALG_OK);
+    for (size_t i = 0; i < result.len; i++) {
+        assert(vecDGet(result, i) == 5.0);
+    }
+    assert(vecDSub(a, b, &result) == LINALG_OK);
+    assert(vecDMaxAbs(result) == 1.0);
+    assert(vecDScale(4.0, a, &result) == LINALG_OK);
+    assert(vecDSum(result) == 40.0);
+    assert(vecDDot(a, b) == 30.0);
+    *vecDRef(a, 3) = -7.0;
+    assert(vecDMin(a) == -7.0);
+    assert(vecDMax(a) == 2.0);
+    assert(vecDGet(a, 5) != vecDGet(a, 5)); // out of bounds access gives nan
+    freeVecD(&a);
+    freeVecD(&b);
+    freeVecD(&result);
+    assert(a.x == NULL);
+
+    // incompatible lengths
+    a = vecDInitA(1.0, 2);
+    b = vecDInitA(1.0, 3);
+    result = vecDInitZerosA(3);
+    assert(vecDAdd(a, b, &result) == LINALG_ERROR);
+    freeVecD(&a);
+    freeVecD(&b);
+    freeVecD(&result);
+}
+
+void test_vecFFamily() {
+    VecF a = vecFInitA(1.5f, 4);
+    VecF copy = vecFCopyA(a);
+    assert(copy.len == 4);
+    assert(vecFSum(copy) == 6.0f);
+    assert(vecFContainsNan(copy) == 0);
+    *vecFRef(copy, 1) = NAN;
+    assert(vecFContainsNan(copy) == 1);
+    freeVecF(&a);
+    freeVecF(&copy);
+}
+
+void test_vecPrecisionConversion() {
+    Vec ld = vecInitZerosA(4);
+    for (size_t i = 0; i < ld.len; i++) VEC_INDEX(ld, i) = 0.25L * i;
+
+    VecD d = vecDFromVecA(ld);
+    assert(d.len == ld.len);
+    for (size_t i = 0; i < d.len; i++) {
+        assert(vecDGet(d, i) == 0.25 * i);
+    }
+    vecDScale(2.0, d, &d);
+
+    assert(vecDToVec(d, &ld) == LINALG_OK);
+    for (size_t i = 0; i < ld.len; i++) {
+        assert(vecGet(ld, i) == 0.5L * i);
+    }
+
+    // strided source(matrix column)
+    Mat2d m = mat2DInitZerosA(3, 2);
+    *mat2DRef(m, 2, 1) = 9.0L;
+    VecF col = vecFFromVecA(mat2DCol(m, 1));
+    assert(col.len == 3);
+    assert(vecFGet(col, 2) == 9.0f);
+
+    Vec small = vecInitZerosA(3);
+    assert(vecDToVec(d, &small) == LINALG_ERROR);
+
+    freeVec(&ld);
+    freeVec(&small);
+    freeVecD(&d);
+    freeVecF(&col);
+    freeMat2D(&m);
+}
+
+void test_mat2DDFamily() {
+    Mat2dD A = mat2DDInitZerosA(2, 3);
+    Mat2dD B = mat2DDInitZerosA(3, 2);
+    for (size_t i = 0; i < 2; i++) {
+        for (size_t j = 0; j < 3; j++) {
+            *mat2DDRef(A, i, j) = i + j;
+            *mat2DDRef(B, j, i) = i * j + 1;
+        }
+    }
+    Mat2dD C = mat2DDInitZerosA(2, 2);
+    assert(mat2DDMul(A, B, &C) == LINALG_OK);
+    // C = [[0 1 2],[1 2 3]] * [[1 1],[1 2],[1 3]]
+    assert(mat2DDGet(C, 0, 0) == 3.0);
+    assert(mat2DDGet(C, 0, 1) == 8.0);
+    assert(mat2DDGet(C, 1, 0) == 6.0);
+    assert(mat2DDGet(C, 1, 1) == 14.0);
+
+    Mat2dD At = mat2DDInitZerosA(3, 2);
+    assert(mat2DDTranspose(A, &At) == LINALG_OK);
+    assert(mat2DDGet(At, 2, 1) == 3.0);
+
+    VecD x = vecDInitA(1.0, 3);
+    VecD y = vecDInitZerosA(2);
+    assert(mat2DDTransform(A, x, &y) == LINALG_OK);
+    assert(vecDGet(y, 0) == 3.0);
+    assert(vecDGet(y, 1) == 6.0);
+
+    // column view is strided
+    VecD col = mat2DDCol(A, 2);
+    assert(col.offset == 3);
+    assert(vecDGet(col, 1) == 3.0);
+
+    assert(mat2DDMul(A, A, &C) == LINALG_ERROR);
+    // square products in place are rejected, not computed over their own input
+    Mat2dD S = mat2DDInitA(1.0, 2, 2);
+    assert(mat2DDMul(S, C, &S) == LINALG_ERROR);
+    assert(mat2DDMul(C, S, &S) == LINALG_ERROR);
+    assert(mat2DDGet(S, 0, 0) == 1.0);
+    freeMat2DD(&S);
+
+    freeMat2DD(&A);
+    freeMat2DD(&B);
+    freeMat2DD(&C);
+    freeMat2DD(&At);
+    freeVecD(&x);
+    freeVecD(&y);
+}
+
+void test_matPrecisionConversion() {
+    Mat2d ld = mat2DInitZerosA(2, 2);
+    *mat2DRef(ld, 0, 1) = 3.0e-15L;
+    *mat2DRef(ld, 1, 0) = 6.0e9L;
+
+    Mat2dD d = mat2DDFromMat2DA(ld);
+    assert(mat2DDGet(d, 0, 1) == 3.0e-15);
+    assert(mat2DDMaxAbs(d) == 6.0e9);
+    mat2DDScale(2.0, d, &d);
+    assert(mat2DDToMat2D(d, &ld) == LINALG_OK);
+    assert(mat2DGet(ld, 1, 0) == 1.2e10L);
+
+    Mat2dF f = mat2DFFromMat2DA(ld);
+    assert(mat2DFGet(f, 1, 1) == 0.0f);
+    assert(mat2DFContainsNan(f) == 0);
+
+    freeMat2D(&ld);
+    freeMat2DD(&d);
+    freeMat2DF(&f);
+}
+
+int linalg_precision_test() {
+    test_vecDFamily();
+    test_vecFFamily();
+    test_vecPrecisionConversion();
+    test_mat2DDFamily();
+    test_matPrecisionConversion();
+
+    printf("precision family functions passed all tests\n");
+    return 0;
+}
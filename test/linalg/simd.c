@@ -0,0 +1,107 @@
+#include <assert.h>
+#include <math.h>
+#include "linalg.h"
+
+// compare the simd kernels of every level against plain loops, for lengths around the register widths
+void test_simdKernelsD() {
+    for (int level = LINALG_SIMD_SCALAR; level <= LINALG_SIMD_AVX512; level++) {
+        linalgSimdSetLevel(level);
+        for (size_t n = 1; n < 40; n++) {
+            VecD a = vecDInitZerosA(n);
+            VecD b = vecDInitZerosA(n);
+            VecD result = vecDInitZerosA(n);
+            double dot = 0, sum = 0, max_abs = 0;
+            for (size_t i = 0; i < n; i++) {
+                a.x[i] = (i % 3 == 0 ? -1.0 : 1.0) * (0.5 + i);
+                b.x[i] = 0.25 * i;
+                dot += a.x[i] * b.x[i];
+                sum += a.x[i];
+                max_abs = fabs(a.x[i]) > max_abs ? fabs(a.x[i]) : max_abs;
+            }
+
+            assert(vecDAdd(a, b, &result) == LINALG_OK);
+            for (size_t i = 0; i < n; i++) assert(result.x[i] == a.x[i] + b.x[i]);
+            assert(vecDSub(a, b, &result) == LINALG_OK);
+            for (size_t i = 0; i < n; i++) assert(result.x[i] == a.x[i] - b.x[i]);
+            assert(vecDScale(3.0, a, &result) == LINALG_OK);
+            for (size_t i = 0; i < n; i++) assert(result.x[i] == 3.0 * a.x[i]);
+
+            // summation order differs between levels
+            assert(fabs(vecDDot(a, b) - dot) <= 1e-12 * fabs(dot) + 1e-12);
+            assert(fabs(vecDSum(a) - sum) <= 1e-12 * fabs(sum) + 1e-12);
+            assert(vecDMaxAbs(a) == max_abs);
+
+            freeVecD(&a);
+            freeVecD(&b);
+            freeVecD(&result);
+        }
+    }
+    linalgSimdSetLevel(LINALG_SIMD_AVX512);
+}
+
+void test_simdKernelsF() {
+    for (int level = LINALG_SIMD_SCALAR; level <= LINALG_SIMD_AVX512; level++) {
+        linalgSimdSetLevel(level);
+        for (size_t n = 1; n < 40; n++) {
+            VecF a = vecFInitA(2.0f, n);
+            VecF result = vecFInitZerosA(n);
+            *vecFRef(a, n - 1) = -5.0f;
+
+            assert(vecFAdd(a, a, &result) == LINALG_OK);
+            assert(vecFGet(result, n - 1) == -10.0f);
+            assert(vecFMaxAbs(a) == 5.0f);
+            assert(vecFSum(a) == 2.0f * (n - 1) - 5.0f);
+            assert(vecFDot(a, a) == 4.0f * (n - 1) + 25.0f);
+
+            freeVecF(&a);
+            freeVecF(&result);
+        }
+    }
+    linalgSimdSetLevel(LINALG_SIMD_AVX512);
+}
+
+// strided vectors(matrix columns) take the scalar path, and must give the same answers
+void test_simdStrided() {
+    Mat2dD m = mat2DDInitZerosA(5, 3);
+    for (size_t i = 0; i < 5; i++) {
+        *mat2DDRef(m, i, 0) = i;
+        *mat2DDRef(m, i, 1) = -2.0 * i;
+    }
+    VecD c0 = mat2DDCol(m, 0);
+    VecD c1 = mat2DDCol(m, 1);
+    VecD c2 = mat2DDCol(m, 2);
+    assert(vecDAdd(c0, c1, &c2) == LINALG_OK);
+    for (size_t i = 0; i < 5; i++) assert(mat2DDGet(m, i, 2) == -1.0 * i);
+    assert(vecDDot(c0, c1) == -60.0);
+    assert(vecDMaxAbs(c1) == 8.0);
+    assert(vecDSum(c2) == -10.0);
+    freeMat2DD(&m);
+
+    // long double column views
+    Mat2d ml = mat2DInitOnesA(4, 2);
+    Vec col = mat2DCol(ml, 1);
+    Vec row = mat2DRow(ml, 0);
+    assert(vecScale(2.0L, col, &col) == LINALG_OK);
+    assert(vecSum(col) == 8.0L);
+    assert(vecMaxAbs(col) == 2.0L);
+    assert(vecDot(row, row) == 5.0L); // row 0 is [1, 2]
+    freeMat2D(&ml);
+}
+
+void test_simdLevel() {
+    int best = linalgSimdSetLevel(LINALG_SIMD_AVX512);
+    assert(best >= LINALG_SIMD_SCALAR && best <= LINALG_SIMD_AVX512);
+    assert(linalgSimdLevel() == best);
+    assert(linalgSimdSetLevel(-4) == LINALG_SIMD_SCALAR);
+    linalgSimdSetLevel(best);
+}
+
+int linalg_simd_test() {
+    test_simdLevel();
+    test_simdKernelsD();
+    test_simdKernelsF();
+    test_simdStrided();
+
+    printf("simd kernels passed all tests(level %d)\n", linalgSimdLevel());
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <assert.h>
+#include <math.h>
+#include "linalg.h"
+
+void test_matCSRFromMat2DA() {
+    Mat2d A = mat2DConstruct((long double[]){
+        1, 0, 0,    1e-20,
+        0, 0, -2,   0,
+        0, 3, 1e-3, 4,
+    }, 3, 4);
+    MatCSR S = matCSRFromMat2DA(A, 1e-12L);
+    assert(S.rows == 3 && S.cols == 4 && S.nnz == 5);
+    assert(S.rowptr[0] == 0 && S.rowptr[1] == 1 && S.rowptr[2] == 2 && S.rowptr[3] == 5);
+    assert(S.col[2] == 1 && S.col[3] == 2 && S.col[4] == 3);
+
+    Mat2d D = mat2DInitA(NAN, 3, 4);
+    assert(matCSRToMat2D(S, &D) == LINALG_OK);
+    for (size_t i = 0; i < 12; i++) assert(mat2DGet(D, i / 4, i % 4) == (i == 3 ? 0 : A.mat[i]));
+
+    // products against the dense kernels
+    Vec x = vecConstruct((long double[]){1, -2, 3, 0.5}, 4);
+    Vec y = vecInitZerosA(3), y_ref = vecInitZerosA(3);
+    assert(matCSRTransform(S, x, &y) == LINALG_OK);
+    assert(mat2DTransform(D, x, &y_ref) == LINALG_OK);
+    for (size_t i = 0; i < 3; i++) assert(y.x[i] == y_ref.x[i]);
+
+    Vec z = vecInitZerosA(4), z_ref = vecInitZerosA(4);
+    assert(matCSRTransformT(S, y, &z) == LINALG_OK);
+    assert(mat2DTransformT(D, y, &z_ref) == LINALG_OK);
+    for (size_t i = 0; i < 4; i++) assert(z.x[i] == z_ref.x[i]);
+
+    assert(matCSRTransform(S, y, &y) == LINALG_ERROR);
+    // a square product in place is rejected as well
+    MatCSR S_sq = matCSRFromMat2DA(mat2DView(D, 0, 0, 3, 3), 0);
+    assert(matCSRTransform(S_sq, y, &y) == LINALG_ERROR);
+    freeMatCSR(&S_sq);
+    assert(matCSRTransformT(S, y, &y) == LINALG_ERROR);
+
+    freeMatCSR(&S);
+    assert(S.val == NULL && S.nnz == 0);
+    freeMat2D(&D);
+    freeVec(&y), freeVec(&y_ref), freeVec(&z), freeVec(&z_ref);
+}
+
+static long double csr_test_entry(size_t i, size_t j, void* ctx) {
+    (void)ctx;
+    return (long double)(10 * i + j);
+}
+
+void test_matCSRFromDistanceA() {
+    // unsorted positions, 2 of them equal
+    Vec pos = vecConstruct((long double[]){5.0, 1.0, 2.5, 9.0, 2.0, 5.0}, 6);
+    long double cutoff = 1.5L;
+    MatCSR S = matCSRFromDistanceA(pos, cutoff, csr_test_entry, NULL);
+    assert(S.rows == 6 && S.cols == 6);
+
+    Mat2d D = mat2DInitZerosA(6, 6);
+    assert(matCSRToMat2D(S, &D) == LINALG_OK);
+    size_t nnz = 0;
+    for (size_t i = 0; i < 6; i++) {
+        for (size_t k = S.rowptr[i] + 1; k < S.rowptr[i + 1]; k++) assert(S.col[k - 1] < S.col[k]);
+        for (size_t j = 0; j < 6; j++) {
+            int near = fabsl(pos.x[i] - pos.x[j]) <= cutoff;
+            nnz += near;
+            assert(mat2DGet(D, i, j) == (near ? csr_test_entry(i, j, NULL) : 0));
+        }
+    }
+    assert(S.nnz == nnz);
+
+    freeMatCSR(&S);
+    freeMat2D(&D);
+}
+
+int linalg_sparse_test() {
+    test_matCSRFromMat2DA();
+    test_matCSRFromDistanceA();
+
+    printf("matCSR* functions passed all tests\n");
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <assert.h>
+#include <math.h>
+#include "linalg.h"
+
+void test_validationLevel() {
+    int level = linalgValidationLevel();
+    assert(level == LINALG_VALIDATION);
+    assert(linalgValidationSetLevel(-1) == LINALG_VALIDATE_OFF);
+    assert(linalgValidationSetLevel(7) == LINALG_VALIDATE_FULL);
+    assert(linalgValidationLevel() == LINALG_VALIDATE_FULL);
+    linalgValidationSetLevel(level);
+}
+
+void test_validationChecks() {
+    int level = linalgValidationLevel();
+    Mat2d b = mat2DInitOnesA(2, 2);
+    Mat2d result = mat2DInitZerosA(3, 3);
+
+    // argument checks stay on at boundary level
+    linalgValidationSetLevel(LINALG_VALIDATE_BOUNDARY);
+    assert(mat2DScale(2.0L, b, &result) == LINALG_ERROR);
+
+    // no checks at all, the kernel only touches the top left b.rows x b.cols corner
+    linalgValidationSetLevel(LINALG_VALIDATE_OFF);
+    assert(mat2DScale(2.0L, b, &result) == LINALG_OK);
+    for (size_t i = 0; i < 4; i++) assert(mat2DGet(result, i / 2, i % 2) == 2.0L);
+    assert(mat2DGet(result, 0, 2) == 0.0L && mat2DGet(result, 2, 0) == 0.0L);
+
+    // INF/NAN inputs are not an error at any level
+    b.mat[0] = NAN;
+    linalgValidationSetLevel(LINALG_VALIDATE_BOUNDARY);
+    Mat2d out = mat2DInitZerosA(2, 2);
+    assert(mat2DAdd(b, b, &out) == LINALG_OK);
+    assert(isnan(out.mat[0]) && mat2DGet(out, 1, 1) == 2.0L);
+
+    linalgValidationSetLevel(level);
+    freeMat2D(&b);
+    freeMat2D(&result);
+    freeMat2D(&out);
+}
+
+// checked accessors are compiled in at full validation(debug and test builds)
+void test_validationAccessors() {
+    Vec a = vecInitOnesA(3);
+    Mat2d m = mat2DInitOnesA(2, 3);
+#if LINALG_VALIDATION >= LINALG_VALIDATE_FULL
+    assert(vecRef(a, 3) == NULL);
+    assert(mat2DRef(m, 0, 3) == NULL);
+#endif
+    assert(vecRef(a, 2) == a.x + 2);
+    assert(mat2DRef(m, 1, 2) == m.mat + m.ld + 2);
+    assert(vecGet(a, 1) == 1.0L && mat2DGet(m, 1, 0) == 1.0L);
+    freeVec(&a);
+    freeMat2D(&m);
+}
+
+int linalg_validation_test() {
+    test_validationLevel();
+    test_validationChecks();
+    test_validationAccessors();
+
+    printf("validation levels passed all tests(level %d)\n", linalgValidationLevel());
+    return 0;
+}
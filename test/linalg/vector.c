@@ -58,6 +58,29 @@ void test_vecInitOnesA() {
     freeVec(&v);
 }
 
+void test_vecSlice() {
+    Vec v = vecInitZerosA(10);
+    for (size_t i = 0; i < v.len; i++) v.x[i] = (long double)i;
+
+    Vec s = vecSlice(v, 2, 5);
+    assert(s.len == 5 && s.x == v.x + 2);
+    assert(vecSum(s) == 2 + 3 + 4 + 5 + 6);
+    assert(vecSlice(v, 10, 0).len == 0);
+    assert(vecSlice(v, 6, 5).x == NULL);
+
+    // slicing a strided view keeps the stride
+    long double data[12] = {0};
+    for (size_t i = 0; i < 12; i++) data[i] = (long double)i;
+    Vec col = mat2DCol(mat2DConstruct(data, 4, 3), 1);
+    Vec t = vecSlice(col, 1, 2);
+    assert(t.offset == 3 && vecGet(t, 0) == 4 && vecGet(t, 1) == 7);
+
+    // kernels write through the slice
+    assert(vecScale(2, s, &s) == LINALG_OK);
+    assert(v.x[1] == 1 && v.x[2] == 4 && v.x[6] == 12 && v.x[7] == 7);
+    freeVec(&v);
+}
+
 void test_vecCopyA() {
     Vec v = vecInitA(2.0, 3);
     Vec v_copy = vecCopyA(v);
@@ -237,17 +260,116 @@ void test_vecMagnitude() {
     freeVec(&a);
 }
 
+void test_vecLinComb() {
+    Vec y = vecInitA(1.0, 4);
+    Vec k0 = vecInitA(2.0, 4);
+    Vec k1 = vecInitA(-4.0, 4);
+    Vec result = vecInitZerosA(4);
+    int status = vecLinComb(y, 2, (long double[]){0.5, 0.25}, (Vec[]){k0, k1}, &result);
+    assert(status == LINALG_OK);
+    for (size_t i = 0; i < 4; i++) {
+        assert(VEC_INDEX(result, i) == 1.0); // 1 + 1 - 1
+    }
+
+    // in place on one of the inputs
+    status = vecLinComb(y, 1, (long double[]){3.0}, (Vec[]){k0}, &k0);
+    assert(status == LINALG_OK);
+    assert(VEC_INDEX(k0, 3) == 7.0);
+
+    // no terms copies y
+    status = vecLinComb(k1, 0, NULL, NULL, &result);
+    assert(status == LINALG_OK);
+    assert(VEC_INDEX(result, 2) == -4.0);
+
+    // strided column of a matrix
+    Mat2d m = mat2DInitOnesA(4, 2);
+    Vec col = mat2DCol(m, 1);
+    status = vecLinComb(col, 1, (long double[]){2.0}, (Vec[]){y}, &col);
+    assert(status == LINALG_OK);
+    assert(mat2DGet(m, 2, 1) == 3.0);
+    assert(mat2DGet(m, 2, 0) == 1.0);
+    freeMat2D(&m);
+
+    // mismatched lengths
+    Vec short_vec = vecInitA(1.0, 3);
+    status = vecLinComb(y, 2, (long double[]){1.0, 1.0}, (Vec[]){k0, short_vec}, &result);
+    assert(status == LINALG_ERROR);
+
+    freeVec(&y);
+    freeVec(&k0);
+    freeVec(&k1);
+    freeVec(&result);
+    freeVec(&short_vec);
+}
+
+void test_vecAxpby() {
+    Vec x = vecInitA(2.0, 3);
+    Vec y = vecInitA(10.0, 3);
+    assert(vecAxpy(0.5, x, &y) == LINALG_OK);
+    for (size_t i = 0; i < 3; i++) {
+        assert(VEC_INDEX(y, i) == 11.0);
+    }
+    assert(vecAxpby(0.25, x, 0.5, &y) == LINALG_OK);
+    for (size_t i = 0; i < 3; i++) {
+        assert(VEC_INDEX(y, i) == 6.0);
+    }
+
+    Vec z = vecInitA(1.0, 2);
+    assert(vecAxpy(1.0, z, &y) == LINALG_ERROR);
+
+    freeVec(&x);
+    freeVec(&y);
+    freeVec(&z);
+}
+
+void test_vecDiffNorms() {
+    Vec a = vecConstruct((long double[]){1, 2, 3, 4}, 4);
+    Vec b = vecConstruct((long double[]){1, 2.5L, 2, -8}, 4);
+    LinalgDiffNorms d = vecDiffNorms(a, b);
+    assert(!d.nonfinite);
+    assert(d.max_diff == 12 && d.rel_max == 12.0L / 8);
+    assert(fabsl(d.rms_diff - sqrtl((0.25L + 1 + 144) / 4)) < 1e-18L);
+    assert(fabsl(d.rel_rms - sqrtl(145.25L / (1 + 6.25L + 4 + 64))) < 1e-18L);
+
+    // strided(every other element) and identical
+    Vec s = vecConstruct((long double[]){5, 0, 5, 0}, 4);
+    s.offset = 2, s.len = 2;
+    Vec five = vecInitA(5, 2);
+    d = vecDiffNorms(s, five);
+    assert(d.max_diff == 0 && d.rel_max == 0 && d.rms_diff == 0 && !d.nonfinite);
+
+    // INF/NAN in either side, no scan needed
+    *vecRef(five, 1) = NAN;
+    assert(vecDiffNorms(s, five).nonfinite && isnan(vecDiffNorms(s, five).rel_max));
+    *vecRef(five, 1) = INFINITY;
+    assert(vecDiffNorms(five, five).nonfinite);
+
+    // zero reference
+    Vec zero = vecInitZerosA(2);
+    assert(vecDiffNorms(zero, zero).rel_max == 0);
+    *vecRef(zero, 0) = 1;
+    Vec z2 = vecInitZerosA(2);
+    assert(isinf(vecDiffNorms(zero, z2).rel_max));
+    assert(vecDiffNorms(a, zero).nonfinite);
+
+    freeVec(&five), freeVec(&zero), freeVec(&z2);
+}
+
 int linalg_vec_test() {
     test_vecInitA();
     test_vecInitZerosA();
     test_vecInitOnesA();
     test_vecCopyA();
+    test_vecSlice();
     test_vecAdd();
     test_vecSub();
     test_vecDot();
     test_vecScale();
     test_vecNormalize();
     test_vecMagnitude();
+    test_vecLinComb();
+    test_vecAxpby();
+    test_vecDiffNorms();
     printf("vec* functions passed all tests\n");
     return 0;
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <test/poisson/test_poisson.h>
 #include <time.h>
 #include <pyvisual.h>
+#include <include/threadpool.h>
 
 #define LA_VIDX(vector, index) *(vector.x + vector.offset * index)
 #define EPSILON 1e-6
@@ -418,13 +419,23 @@ void testMeshGen()
     vecPrint(d);
     printNL();
     
-    Vec mesh = generateMesh(d, params);
+    Mesh mesh = generateMesh(d, params);
     
     // printNL();
-    // vecPrint(mesh);
+    // vecPrint(mesh.x);
     // printNL();
 
-    PyViBase param = pyviCreateParameter(&vis, "x", mesh);
+    // every trap and boundary is found by index, no mesh scan
+    assert(mesh.traps == d.len && mesh.trap == mesh.bound + 1);
+    assert(mesh.bound[0] == 0 && mesh.x.x[0] == 0);
+    assert(mesh.bound[d.len + 1] == mesh.x.len - 1 && mesh.x.x[mesh.x.len - 1] == params.L);
+    for (size_t i = 0; i < d.len; i++)
+    {
+        assert(mesh.trap[i] == params.chunk_size * (i + 1));
+        assert(mesh.x.x[mesh.trap[i]] == d.x[i]);
+    }
+
+    PyViBase param = pyviCreateParameter(&vis, "x", mesh.x);
     PyViSec sec = pyviCreateSection(&vis, "Voltage", param);
     // PyViSection * analytical = pyviCreateSection(&vis, "Analytical Solution", param);
 
@@ -434,6 +445,8 @@ void testMeshGen()
     // vecPrint(data.locs);
     // printNL();
 
+    // the charges of the traps in d
+    data.probs = f_n;
     Vec sol = poissonWrapper(data, mesh);
     // pyviSectionPush(analytical, solA);
 
@@ -474,3 +487,176 @@ void testSolver()
     Vec sol = numSolveV(mat, b);
     vecPrint(sol);
 }
+
+// the cached solver against the one shot poissonWrapper/getGridNumE
+// 7 traps in a 100nm oxide with 50 mesh points per interval, shared by the PoissonSolver tests
+static InputData poissonTestData()
+{
+    InputData data;
+    data.params.L = 1e-7;
+    data.params.eps_r = 3.9;
+    data.params.V_0 = 1;
+    data.params.V_L = 0;
+    data.params.electron_affinity = 2.85;
+    data.params.chunk_size = 50;
+    data.params.num_traps = 7;
+    data.locs = vecInitZerosA(7);
+    data.probs = vecInitZerosA(7);
+    data.energies = vecInitZerosA(7);
+    for (size_t i = 0; i < 7; i++)
+    {
+        data.locs.x[i] = data.params.L * (i + 1) / 9;
+        data.probs.x[i] = 0.1L * (i % 4);
+        data.energies.x[i] = 0.15L * Q;
+    }
+    return data;
+}
+
+void testPoissonSolver()
+{
+    InputData data = poissonTestData();
+
+    Mesh mesh = generateMesh(data.locs, data.params);
+    assert(mesh.x.len == data.params.chunk_size * (data.locs.len + 1) + 1);
+    PoissonSolver poisson = poissonSolverInitA(data, mesh);
+    assert(poisson.scale.x != NULL);
+
+    Vec V = vecInitA(NAN, mesh.x.len);
+    Vec E = vecInitA(NAN, data.locs.len);
+    for (int round = 0; round < 2; round++)
+    {
+        // same operations in the same order, so the results match exactly
+        Vec V_ref = poissonWrapper(data, mesh);
+        Vec E_ref = getGridNumE(data, mesh);
+        assert(poissonSolverSolve(&poisson, data, &V) == 1);
+        for (size_t i = 0; i < mesh.x.len; i++) assert(V.x[i] == V_ref.x[i]);
+        assert(poissonSolverGridE(&poisson, data, &V, &E) == 1);
+        for (size_t i = 0; i < data.locs.len; i++) assert(E.x[i] == E_ref.x[i]);
+        freeVec(&V_ref);
+        freeVec(&E_ref);
+
+        // new charges and bias, same solver
+        data.params.V_0 = -0.5;
+        data.params.V_L = 0.25;
+        for (size_t i = 0; i < 7; i++) data.probs.x[i] = 1 - data.probs.x[i];
+    }
+
+    // wrong sizes are rejected
+    Vec short_V = vecInitZerosA(mesh.x.len - 1);
+    assert(poissonSolverSolve(&poisson, data, &short_V) == 0);
+    Vec short_E = vecInitZerosA(data.locs.len - 1);
+    assert(poissonSolverGridE(&poisson, data, &V, &short_E) == 0);
+
+    freePoissonSolver(&poisson);
+    assert(poisson.scale.x == NULL && poisson.den.x == NULL);
+    freeVec(&short_V), freeVec(&short_E), freeVec(&V), freeVec(&E), freeMesh(&mesh);
+    freeVec(&data.locs), freeVec(&data.probs), freeVec(&data.energies);
+    printf("poissonSolver* functions passed all tests\n");
+}
+
+void testPoissonInfluence()
+{
+    InputData data = poissonTestData();
+
+    Mesh mesh = generateMesh(data.locs, data.params);
+    PoissonSolver poisson = poissonSolverInitA(data, mesh);
+    Vec V = vecInitA(NAN, data.locs.len);
+    Vec E = vecInitA(NAN, data.locs.len);
+
+    // no influence matrix yet
+    assert(poissonSolverTrapV(&poisson, data, &V) == 0);
+    assert(poissonSolverInfluence(&poisson) == 1);
+    assert(poisson.influence.rows == 7 && poisson.influence.cols == 7);
+
+    for (int round = 0; round < 2; round++)
+    {
+        // linear in the charges, so the mat-vec matches the full solve to rounding
+        Vec V_ref = getGridNumV(data, mesh);
+        Vec E_ref = getGridNumE(data, mesh);
+        assert(poissonSolverTrapV(&poisson, data, &V) == 1);
+        assert(poissonSolverTrapE(&poisson, data, &E) == 1);
+        for (size_t i = 0; i < data.locs.len; i++)
+        {
+            assert(fabsl(V.x[i] - V_ref.x[i]) <= 1e-12L * (1 + fabsl(V_ref.x[i])));
+            assert(fabsl(E.x[i] - E_ref.x[i]) <= 1e-12L * fabsl(E_ref.x[i]));
+        }
+        freeVec(&V_ref);
+        freeVec(&E_ref);
+
+        data.params.V_0 = -0.5;
+        data.params.V_L = 0.25;
+        for (size_t i = 0; i < 7; i++) data.probs.x[i] = 1 - data.probs.x[i];
+    }
+
+    // the columns are independent, so the matrix does not depend on the thread count
+    int threads = threadPoolThreads();
+    threadPoolSetThreads(1);
+    PoissonSolver serial = poissonSolverInitA(data, mesh);
+    assert(poissonSolverInfluence(&serial) == 1);
+    threadPoolSetThreads(threads);
+    for (size_t i = 0; i < 7; i++)
+    {
+        for (size_t j = 0; j < 7; j++) assert(mat2DGet(serial.influence, i, j) == mat2DGet(poisson.influence, i, j));
+        assert(serial.bias_0.x[i] == poisson.bias_0.x[i] && serial.bias_L.x[i] == poisson.bias_L.x[i]);
+    }
+
+    // wrong sizes are rejected
+    Vec short_E = vecInitZerosA(data.locs.len - 1);
+    assert(poissonSolverTrapE(&poisson, data, &short_E) == 0);
+
+    freePoissonSolver(&serial);
+    freePoissonSolver(&poisson);
+    assert(poisson.influence.mat == NULL && poisson.bias_0.x == NULL);
+    freeVec(&short_E), freeVec(&V), freeVec(&E), freeMesh(&mesh);
+    freeVec(&data.locs), freeVec(&data.probs), freeVec(&data.energies);
+    printf("poissonSolverInfluence/Trap* functions passed all tests\n");
+}
+
+void testPoissonBatch()
+{
+    InputData data = poissonTestData();
+    // the charges and the bias come from each right hand side
+    Vec probs_fixture = data.probs;
+
+    // more right hand sides than one block, each with its own charges and bias
+    size_t rhs = 37;
+    Mat2d probs = mat2DInitZerosA(7, rhs);
+    Vec V_0 = vecInitZerosA(rhs);
+    Vec V_L = vecInitZerosA(rhs);
+    for (size_t r = 0; r < rhs; r++)
+    {
+        for (size_t i = 0; i < 7; i++) *mat2DRef(probs, i, r) = 0.03L * ((i + r) % 11);
+        V_0.x[r] = 0.1L * r - 1;
+        V_L.x[r] = 0.5L - 0.02L * r;
+    }
+
+    Mesh mesh = generateMesh(data.locs, data.params);
+    PoissonSolver poisson = poissonSolverInitA(data, mesh);
+    Mat2d V = mat2DInitA(NAN, rhs, mesh.x.len);
+    assert(poissonSolverSolveBatch(&poisson, probs, V_0, V_L, &V) == 1);
+    Mat2d V_wrap = poissonWrapperBatchA(data, mesh, probs, V_0, V_L);
+    assert(V_wrap.rows == rhs && V_wrap.cols == mesh.x.len);
+
+    // every row matches the single solve exactly
+    Vec V_ref = vecInitZerosA(mesh.x.len);
+    for (size_t r = 0; r < rhs; r++)
+    {
+        data.probs = mat2DCol(probs, r);
+        data.params.V_0 = V_0.x[r];
+        data.params.V_L = V_L.x[r];
+        assert(poissonSolverSolve(&poisson, data, &V_ref) == 1);
+        for (size_t i = 0; i < mesh.x.len; i++) assert(mat2DGet(V, r, i) == V_ref.x[i] && mat2DGet(V_wrap, r, i) == V_ref.x[i]);
+    }
+
+    // wrong sizes are rejected
+    Vec short_V_0 = vecInitZerosA(rhs - 1);
+    assert(poissonSolverSolveBatch(&poisson, probs, short_V_0, V_L, &V) == 0);
+    Mat2d short_V = mat2DInitZerosA(rhs, mesh.x.len - 1);
+    assert(poissonSolverSolveBatch(&poisson, probs, V_0, V_L, &short_V) == 0);
+
+    freePoissonSolver(&poisson);
+    freeMat2D(&probs), freeMat2D(&V), freeMat2D(&V_wrap), freeMat2D(&short_V);
+    freeVec(&V_0), freeVec(&V_L), freeVec(&short_V_0), freeVec(&V_ref), freeMesh(&mesh);
+    freeVec(&data.locs), freeVec(&probs_fixture), freeVec(&data.energies);
+    printf("poissonSolverSolveBatch/poissonWrapperBatchA functions passed all tests\n");
+}
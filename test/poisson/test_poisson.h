@@ -19,4 +19,10 @@ void test_getGridV();
 
 void testMeshGen();
 
-void testSolver();
\ No newline at end of file
+void testSolver();
+
+void testPoissonSolver();
+
+void testPoissonInfluence();
+
+void testPoissonBatch();
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include <assert.h>
+#include <stdlib.h>
+#include "test_stack.h"
+
+void test_dynStackReserve() {
+    DynStack s = dynStackInit(sizeof(int));
+    dynStackReserve(&s, 100);
+    assert(s.reserved_size == 100 && s.len == 0);
+    uint8_t* data = s.data;
+
+    // pushes within the reserve do not move the buffer
+    for (int i = 0; i < 100; i++) dynStackPush(&s, &i);
+    assert(s.data == data && s.reserved_size == 100);
+    for (int i = 0; i < 100; i++) assert(*(int*)dynStackGet(s, i) == i);
+
+    // never shrinks
+    dynStackReserve(&s, 10);
+    assert(s.reserved_size == 100);
+
+    int next = 100;
+    dynStackPush(&s, &next);
+    assert(s.len == 101 && s.reserved_size > 101);
+    dynStackShrink(&s);
+    assert(s.reserved_size == 101);
+    assert(*(int*)dynStackGet(s, 100) == 100);
+
+    freeDynStack(&s);
+}
+
+void test_dynStackPushN() {
+    DynStack s = dynStackInit(sizeof(double));
+    double block[37];
+    for (int i = 0; i < 37; i++) block[i] = i * 0.5;
+
+    dynStackPushN(&s, block, 37);
+    dynStackPushN(&s, block, 0);
+    dynStackPushN(&s, block, 5);
+    assert(s.len == 42);
+    for (size_t i = 0; i < 37; i++) assert(*(double*)dynStackGet(s, i) == i * 0.5);
+    for (size_t i = 37; i < 42; i++) assert(*(double*)dynStackGet(s, i) == (i - 37) * 0.5);
+
+    freeDynStack(&s);
+}
+
+void test_dynStackDetach() {
+    DynStack s = dynStackInit(sizeof(long double));
+    dynStackReserve(&s, 16);
+    for (int i = 0; i < 10; i++) {
+        long double v = i;
+        dynStackPush(&s, &v);
+    }
+
+    size_t len = 0;
+    long double* x = dynStackDetach(&s, &len);
+    assert(len == 10);
+    for (size_t i = 0; i < len; i++) assert(x[i] == i);
+    // the stack is empty but still usable
+    assert(s.data == NULL && s.len == 0 && s.reserved_size == 0 && s.element_size == sizeof(long double));
+    free(x);
+
+    assert(dynStackDetach(&s, &len) == NULL && len == 0);
+}
+
+int stack_test() {
+    test_dynStackReserve();
+    test_dynStackPushN();
+    test_dynStackDetach();
+
+    printf("dynStack* functions passed all tests\n");
+    return 0;
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+#include <include/stack.h>
+
+int stack_test();
@@ -4,10 +4,10 @@
 
 int testSteadystate(){
     Mat2d coeffmatrix = mat2DInitA(0, 2, 2);
-    coeffmatrix.mat[0] = 0.1;
-    coeffmatrix.mat[1] = 0.2;
-    coeffmatrix.mat[2] = 0.3;
-    coeffmatrix.mat[3] = 0.1;
+    *mat2DRef(coeffmatrix, 0, 0) = 0.1;
+    *mat2DRef(coeffmatrix, 0, 1) = 0.2;
+    *mat2DRef(coeffmatrix, 1, 0) = 0.3;
+    *mat2DRef(coeffmatrix, 1, 1) = 0.1;
     long double value1 = 0.6;
     long double value2 = 0.5;
 
@@ -9,12 +9,27 @@
 #include <test/input_testing/test_toml_input.h>
 #include <test/interpolation/testInterpolate.h>
 #include <test/steady_state/steadystatetest.h>
+#include <test/utils/test_threadpool.h>
+#include <test/stack/test_stack.h>
 
 int run_all_tests()
 {
     printf("Running tests:\n");
-    // linalg_vec_test();
-    // linalg_matrix_test();
+    linalg_vec_test();
+    linalg_matrix_test();
+    linalg_precision_test();
+    linalg_simd_test();
+    linalg_validation_test();
+    linalg_arena_test();
+    linalg_lu_test();
+    linalg_sparse_test();
+    linalg_banded_test();
+    linalg_expm_test();
+    linalg_krylov_test();
+    linalg_batch_test();
+    threadpool_test();
+    linalg_diag_test();
+    stack_test();
     // test_poisson();
     // test_getGridV();
     // testFile();
@@ -22,6 +37,9 @@ int run_all_tests()
     // testmaster();
     // test_interpolation();
     testMeshGen();
+    testPoissonSolver();
+    testPoissonInfluence();
+    testPoissonBatch();
     // testSteadystate();
     // testSolver();
 
@@ -0,0 +1,157 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "test_threadpool.h"
+
+typedef struct CountCtx {
+    int* hits;
+    size_t min_range;
+} CountCtx;
+
+static pthread_mutex_t count_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void count_range(size_t begin, size_t end, void* ctx) {
+    CountCtx* c = ctx;
+    pthread_mutex_lock(&count_lock);
+    if (end - begin < c->min_range) c->min_range = end - begin;
+    pthread_mutex_unlock(&count_lock);
+    for (size_t i = begin; i < end; i++) c->hits[i]++;
+}
+
+void test_parallelFor() {
+    size_t sizes[] = {0, 1, 7, 64, 1000, 100003};
+    int threads[] = {1, 2, 3, 8};
+    int saved = threadPoolThreads();
+
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+        threadPoolSetThreads(threads[t]);
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            size_t n = sizes[s];
+            CountCtx ctx = {calloc(n + 1, sizeof(int)), (size_t)-1};
+            parallelFor(n, 16, count_range, &ctx);
+            // every iteration exactly once, every range at least grain long unless n is smaller
+            for (size_t i = 0; i < n; i++) assert(ctx.hits[i] == 1);
+            if (n >= 16) assert(ctx.min_range >= 16);
+            free(ctx.hits);
+        }
+    }
+    threadPoolSetThreads(saved);
+}
+
+static void nested_range(size_t begin, size_t end, void* ctx) {
+    int* hits = ctx;
+    for (size_t i = begin; i < end; i++) {
+        CountCtx inner = {hits + i * 32, (size_t)-1};
+        parallelFor(32, 1, count_range, &inner);
+    }
+}
+
+void test_parallelForNested() {
+    int saved = threadPoolThreads();
+    threadPoolSetThreads(4);
+
+    // loops started from inside the pool run inline instead of deadlocking
+    int* hits = calloc(64 * 32, sizeof(int));
+    parallelFor(64, 1, nested_range, hits);
+    for (size_t i = 0; i < 64 * 32; i++) assert(hits[i] == 1);
+    free(hits);
+
+    threadPoolSetThreads(saved);
+}
+
+static void sum_range(size_t begin, size_t end, void* partial, void* ctx) {
+    const double* x = ctx;
+    double* acc = partial;
+    for (size_t i = begin; i < end; i++) *acc += x[i];
+}
+
+static void sum_combine(void* acc, const void* partial, void* ctx) {
+    (void)ctx;
+    *(double*)acc += *(const double*)partial;
+}
+
+static void isum_range(size_t begin, size_t end, void* partial, void* ctx) {
+    (void)ctx;
+    unsigned long long* acc = partial;
+    for (size_t i = begin; i < end; i++) *acc += i;
+}
+
+static void isum_combine(void* acc, const void* partial, void* ctx) {
+    (void)ctx;
+    *(unsigned long long*)acc += *(const unsigned long long*)partial;
+}
+
+void test_parallelReduce() {
+    int saved = threadPoolThreads();
+    const unsigned long long zero = 0;
+    const double dzero = 0;
+
+    // exact in either order
+    for (int t = 1; t <= 8; t *= 2) {
+        threadPoolSetThreads(t);
+        for (int mode = PARALLEL_REDUCE_FAST; mode <= PARALLEL_REDUCE_DETERMINISTIC; mode++) {
+            unsigned long long sum = 1;
+            parallelReduce(100000, 8, isum_range, isum_combine, &zero, sizeof(zero), &sum, mode, NULL);
+            assert(sum == 100000ULL * 99999ULL / 2);
+
+            parallelReduce(0, 8, isum_range, isum_combine, &zero, sizeof(zero), &sum, mode, NULL);
+            assert(sum == 0);
+        }
+    }
+
+    // values of very different magnitude so the rounding depends on the order
+    size_t n = 50001;
+    double* x = malloc(n * sizeof(double));
+    unsigned int seed = 12345;
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1103515245u + 12345u;
+        x[i] = ((double)(seed >> 8) / (1u << 24) - 0.5) * (i % 7 == 0 ? 1e12 : 1.0);
+    }
+
+    double ref = 0;
+    threadPoolSetThreads(1);
+    parallelReduce(n, 1, sum_range, sum_combine, &dzero, sizeof(double), &ref, PARALLEL_REDUCE_DETERMINISTIC, x);
+    int threads[] = {2, 3, 5, 8};
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+        threadPoolSetThreads(threads[t]);
+        for (int rep = 0; rep < 4; rep++) {
+            double sum = 0;
+            parallelReduce(n, 1, sum_range, sum_combine, &dzero, sizeof(double), &sum, PARALLEL_REDUCE_DETERMINISTIC, x);
+            assert(memcmp(&sum, &ref, sizeof(double)) == 0);
+        }
+    }
+    free(x);
+
+    threadPoolSetThreads(saved);
+}
+
+void test_threadPoolShutdown() {
+    int saved = threadPoolThreads();
+    threadPoolSetThreads(4);
+
+    // the pool comes back after a shutdown and after a resize
+    CountCtx ctx = {calloc(4096, sizeof(int)), (size_t)-1};
+    parallelFor(4096, 1, count_range, &ctx);
+    threadPoolShutdown();
+    parallelFor(4096, 1, count_range, &ctx);
+    threadPoolSetThreads(2);
+    parallelFor(4096, 1, count_range, &ctx);
+    for (size_t i = 0; i < 4096; i++) assert(ctx.hits[i] == 3);
+    free(ctx.hits);
+
+    assert(threadPoolSetThreads(-1) == 1);
+    assert(threadPoolSetThreads(0) >= 1);
+    threadPoolSetThreads(saved);
+}
+
+int threadpool_test() {
+    test_parallelFor();
+    test_parallelForNested();
+    test_parallelReduce();
+    test_threadPoolShutdown();
+
+    printf("threadPool*/parallel* functions passed all tests\n");
+    return 0;
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+#include <include/threadpool.h>
+
+int threadpool_test();